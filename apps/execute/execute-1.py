@@ -85,6 +85,33 @@ class execute( Gaffer.Application ) :
 					},
 				),
 				
+				IECore.IntParameter(
+					name = "cacheMemoryLimit",
+					description = "The maximum amount of memory in megabytes used to cache "
+						"computed values. If negative, the default is used.",
+					defaultValue = -1,
+				),
+				
+				IECore.IntParameter(
+					name = "imageCacheMemoryLimit",
+					description = "The maximum amount of memory in megabytes used by the "
+						"ImageReader to cache file data. If negative, the default is used.",
+					defaultValue = -1,
+				),
+				
+				IECore.IntParameter(
+					name = "imageCacheMaxOpenFiles",
+					description = "The maximum number of files the ImageReader may hold "
+						"open at once. If negative, the default is used.",
+					defaultValue = -1,
+				),
+				
+				IECore.BoolParameter(
+					name = "imageCacheStatistics",
+					description = "Outputs statistics for the ImageReader cache after execution.",
+					defaultValue = False,
+				),
+				
 			]
 			
 		)
@@ -96,6 +123,17 @@ class execute( Gaffer.Application ) :
 		)
 		
 	def _run( self, args ) :
+		
+		if args["cacheMemoryLimit"].value >= 0 :
+			Gaffer.ValuePlug.setCacheMemoryLimit( args["cacheMemoryLimit"].value * 1024 * 1024 )
+		
+		if args["imageCacheMemoryLimit"].value >= 0 :
+			import GafferImage
+			GafferImage.ImageReader.setCacheMemoryLimit( args["imageCacheMemoryLimit"].value * 1024 * 1024 )
+		
+		if args["imageCacheMaxOpenFiles"].value >= 0 :
+			import GafferImage
+			GafferImage.ImageReader.setCacheMaxOpenFiles( args["imageCacheMaxOpenFiles"].value )
 			
 		scriptNode = Gaffer.ScriptNode( os.path.splitext( os.path.basename( args["script"].value ) )[0] )
 		scriptNode["fileName"].setValue( os.path.abspath( args["script"].value ) )
@@ -135,6 +173,12 @@ class execute( Gaffer.Application ) :
 			for node in nodes :
 				node.execute( [ context ] )
 		
+		if args["imageCacheStatistics"].value :
+			import GafferImage
+			statistics = GafferImage.ImageReader.cacheStatistics()
+			for name in sorted( statistics.keys() ) :
+				IECore.msg( IECore.Msg.Level.Info, "gaffer execute", "ImageReader cache %s : %d" % ( name, statistics[name].value ) )
+		
 		return 0
 
 IECore.registerRunTimeTyped( execute )
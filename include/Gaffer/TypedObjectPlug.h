@@ -109,8 +109,10 @@ typedef TypedObjectPlug<IECore::IntVectorData> IntVectorDataPlug;
 typedef TypedObjectPlug<IECore::FloatVectorData> FloatVectorDataPlug;
 typedef TypedObjectPlug<IECore::StringVectorData> StringVectorDataPlug;
 typedef TypedObjectPlug<IECore::InternedStringVectorData> InternedStringVectorDataPlug;
+typedef TypedObjectPlug<IECore::V2fVectorData> V2fVectorDataPlug;
 typedef TypedObjectPlug<IECore::V3fVectorData> V3fVectorDataPlug;
 typedef TypedObjectPlug<IECore::Color3fVectorData> Color3fVectorDataPlug;
+typedef TypedObjectPlug<IECore::Color4fVectorData> Color4fVectorDataPlug;
 typedef TypedObjectPlug<IECore::ObjectVector> ObjectVectorPlug;
 typedef TypedObjectPlug<IECore::CompoundObject> CompoundObjectPlug;
 
@@ -120,8 +122,10 @@ IE_CORE_DECLAREPTR( IntVectorDataPlug );
 IE_CORE_DECLAREPTR( FloatVectorDataPlug );
 IE_CORE_DECLAREPTR( StringVectorDataPlug );
 IE_CORE_DECLAREPTR( InternedStringVectorDataPlug );
+IE_CORE_DECLAREPTR( V2fVectorDataPlug );
 IE_CORE_DECLAREPTR( V3fVectorDataPlug );
 IE_CORE_DECLAREPTR( Color3fVectorDataPlug );
+IE_CORE_DECLAREPTR( Color4fVectorDataPlug );
 IE_CORE_DECLAREPTR( ObjectVectorPlug );
 IE_CORE_DECLAREPTR( CompoundObjectPlug );
 
@@ -149,6 +153,10 @@ typedef FilteredChildIterator<PlugPredicate<Plug::Invalid, InternedStringVectorD
 typedef FilteredChildIterator<PlugPredicate<Plug::In, InternedStringVectorDataPlug> > InputInternedStringVectorDataPlugIterator;
 typedef FilteredChildIterator<PlugPredicate<Plug::Out, InternedStringVectorDataPlug> > OutputInternedStringVectorDataPlugIterator;
 
+typedef FilteredChildIterator<PlugPredicate<Plug::Invalid, V2fVectorDataPlug> > V2fVectorDataPlugIterator;
+typedef FilteredChildIterator<PlugPredicate<Plug::In, V2fVectorDataPlug> > InputV2fVectorDataPlugIterator;
+typedef FilteredChildIterator<PlugPredicate<Plug::Out, V2fVectorDataPlug> > OutputV2fVectorDataPlugIterator;
+
 typedef FilteredChildIterator<PlugPredicate<Plug::Invalid, V3fVectorDataPlug> > V3fVectorDataPlugIterator;
 typedef FilteredChildIterator<PlugPredicate<Plug::In, V3fVectorDataPlug> > InputV3fVectorDataPlugIterator;
 typedef FilteredChildIterator<PlugPredicate<Plug::Out, V3fVectorDataPlug> > OutputV3fVectorDataPlugIterator;
@@ -157,6 +165,10 @@ typedef FilteredChildIterator<PlugPredicate<Plug::Invalid, Color3fVectorDataPlug
 typedef FilteredChildIterator<PlugPredicate<Plug::In, Color3fVectorDataPlug> > InputColor3fVectorDataPlugIterator;
 typedef FilteredChildIterator<PlugPredicate<Plug::Out, Color3fVectorDataPlug> > OutputColor3fVectorDataPlugIterator;
 
+typedef FilteredChildIterator<PlugPredicate<Plug::Invalid, Color4fVectorDataPlug> > Color4fVectorDataPlugIterator;
+typedef FilteredChildIterator<PlugPredicate<Plug::In, Color4fVectorDataPlug> > InputColor4fVectorDataPlugIterator;
+typedef FilteredChildIterator<PlugPredicate<Plug::Out, Color4fVectorDataPlug> > OutputColor4fVectorDataPlugIterator;
+
 typedef FilteredChildIterator<PlugPredicate<Plug::Invalid, ObjectVectorPlug> > ObjectVectorPlugIterator;
 typedef FilteredChildIterator<PlugPredicate<Plug::In, ObjectVectorPlug> > InputObjectVectorPlugIterator;
 typedef FilteredChildIterator<PlugPredicate<Plug::Out, ObjectVectorPlug> > OutputObjectVectorPlugIterator;
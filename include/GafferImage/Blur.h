@@ -0,0 +1,135 @@
+//////////////////////////////////////////////////////////////////////////
+//  
+//  Copyright (c) 2014, John Haddon. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//  
+//      * Redistributions of source code must retain the above
+//        copyright notice, this list of conditions and the following
+//        disclaimer.
+//  
+//      * Redistributions in binary form must reproduce the above
+//        copyright notice, this list of conditions and the following
+//        disclaimer in the documentation and/or other materials provided with
+//        the distribution.
+//  
+//      * Neither the name of John Haddon nor the names of
+//        any other contributors to this software may be used to endorse or
+//        promote products derived from this software without specific prior
+//        written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef GAFFERIMAGE_BLUR_H
+#define GAFFERIMAGE_BLUR_H
+
+#include "Gaffer/NumericPlug.h"
+#include "Gaffer/CompoundNumericPlug.h"
+#include "Gaffer/TypedObjectPlug.h"
+
+#include "GafferImage/ImageProcessor.h"
+
+namespace GafferImage
+{
+
+/// Blurs an image with either a box filter or an approximation to a
+/// gaussian. Box blurs are computed separably from running sums, so the
+/// cost per pixel doesn't depend on the radius. The horizontal pass is
+/// computed a tile at a time on an internal plug, so that the vertical
+/// pass for each output tile can share it with its neighbours. Each pass
+/// therefore reads only a strip of tileSize by tileSize + 2 * radius pixels
+/// per tile, and the cost grows only linearly with the radius. Gaussian
+/// blurs are approximated by three successive box blurs.
+class Blur : public ImageProcessor
+{
+
+	public :
+
+		enum Type
+		{
+			Box = 0,
+			Gaussian = 1
+		};
+
+		Blur( const std::string &name=defaultName<Blur>() );
+		virtual ~Blur();
+
+		IE_CORE_DECLARERUNTIMETYPEDEXTENSION( GafferImage::Blur, BlurTypeId, ImageProcessor );
+
+		//! @name Plug Accessors
+		/// Returns a pointer to the node's plugs.
+		//////////////////////////////////////////////////////////////
+		//@{
+		/// The radius of the blur in pixels, specified separately for
+		/// each axis. Box blurs round this to the nearest whole pixel.
+		/// For gaussian blurs it is three standard deviations, beyond which
+		/// the contribution of a pixel is negligible. Gaussian radii too small
+		/// to be approximated by three boxes use a single box of radius one.
+		Gaffer::V2fPlug *radiusPlug();
+		const Gaffer::V2fPlug *radiusPlug() const;
+		Gaffer::IntPlug *typePlug();
+		const Gaffer::IntPlug *typePlug() const;
+		//@}
+
+		virtual void affects( const Gaffer::Plug *input, AffectedPlugsContainer &outputs ) const;
+
+	protected :
+
+		/// Reimplemented to disable the node when the radius rounds to zero.
+		virtual bool enabled() const;
+
+		/// Reimplemented to hash and compute the horizontal pass.
+		virtual void hash( const Gaffer::ValuePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const;
+		virtual void compute( Gaffer::ValuePlug *output, const Gaffer::Context *context ) const;
+
+		virtual void hashFormat( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const;
+		virtual void hashDataWindow( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const;
+		virtual void hashChannelNames( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const;
+		virtual void hashChannelData( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const;
+
+		virtual GafferImage::Format computeFormat( const Gaffer::Context *context, const ImagePlug *parent ) const;
+		virtual Imath::Box2i computeDataWindow( const Gaffer::Context *context, const ImagePlug *parent ) const;
+		virtual IECore::ConstStringVectorDataPtr computeChannelNames( const Gaffer::Context *context, const ImagePlug *parent ) const;
+		virtual IECore::ConstFloatVectorDataPtr computeChannelData( const std::string &channelName, const Imath::V2i &tileOrigin, const Gaffer::Context *context, const ImagePlug *parent ) const;
+
+	private :
+
+		// The input blurred horizontally, for the tile and channel
+		// specified by the context.
+		Gaffer::FloatVectorDataPlug *horizontalPassPlug();
+		const Gaffer::FloatVectorDataPlug *horizontalPassPlug() const;
+
+		void hashHorizontalPass( const Gaffer::Context *context, IECore::MurmurHash &h ) const;
+		IECore::ConstFloatVectorDataPtr computeHorizontalPass( const Gaffer::Context *context ) const;
+
+		// Fills radii with the radius of each successive box blur to be
+		// applied along the specified axis, taking into account the
+		// level of detail specified by the current context.
+		void boxRadii( int axis, std::vector<int> &radii ) const;
+		// Returns the number of pixels by which the blur extends the
+		// input along the specified axis.
+		int totalRadius( int axis ) const;
+
+		static size_t g_firstPlugIndex;
+
+};
+
+IE_CORE_DECLAREPTR( Blur );
+
+} // namespace GafferImage
+
+#endif // GAFFERIMAGE_BLUR_H
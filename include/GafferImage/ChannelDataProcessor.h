@@ -68,6 +68,11 @@ class ChannelDataProcessor : public ImageProcessor
 		
 	protected :
 	
+		/// Reimplemented to output blackTileHash() for tiles outside the input data window,
+		/// before hashChannelData() is called. Derived classes therefore need not consider
+		/// such tiles in their implementations of hashChannelData().
+		virtual void hash( const Gaffer::ValuePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const;
+
 		/// This implementation queries whether or not the requested channel is masked by the channelMaskPlug().
 		virtual bool channelEnabled( const std::string &channel ) const;
 	
@@ -81,7 +86,9 @@ class ChannelDataProcessor : public ImageProcessor
 		virtual Imath::Box2i computeDataWindow( const Gaffer::Context *context, const ImagePlug *parent ) const;
 		virtual IECore::ConstStringVectorDataPtr computeChannelNames( const Gaffer::Context *context, const ImagePlug *parent ) const;
 
-		/// Implemented to initialize the output tile and then call processChannelData() 
+		/// Implemented to initialize the output tile and then call processChannelData(). Tiles
+		/// outside the input data window are output as ImagePlug::blackTile() without being
+		/// processed.
 		virtual IECore::ConstFloatVectorDataPtr computeChannelData( const std::string &channelName, const Imath::V2i &tileOrigin, const Gaffer::Context *context, const ImagePlug *parent ) const;
 
 		/// Should be implemented by derived classes to processes each channel's data.
@@ -90,6 +97,8 @@ class ChannelDataProcessor : public ImageProcessor
 		/// @param channelIndex An index in the range of 0-3 which indicates whether the channel to be processed is R, G, B or A. 
 		///                     It is useful for querying Color4f plugs for the value that coresponds to the channel being processed. 
 		/// @param outData The tile where the result of the operation should be written. It is initialized with the coresponding tile data from inPlug() which should be used as the input data.
+		///                When the input tile is constant, outData holds just a single value, so implementations must process
+		///                each element of outData independently, and must not assume it holds a full tile.
 		virtual void processChannelData( const Gaffer::Context *context, const ImagePlug *parent, const std::string &channel, IECore::FloatVectorDataPtr outData ) const = 0;
 
 	private :
@@ -62,9 +62,6 @@ class ColorProcessor : public ImageProcessor
 	protected :
 	
 		virtual bool channelEnabled( const std::string &channel ) const;
-	
-		virtual void hash( const Gaffer::ValuePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const;
-		virtual void compute( Gaffer::ValuePlug *output, const Gaffer::Context *context ) const;
 
 		/// Implemented to pass through the hashes from the input plug.
 		virtual void hashFormat( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const;
@@ -79,6 +76,13 @@ class ColorProcessor : public ImageProcessor
 		/// Implemented to in terms of processColorData().
 		virtual IECore::ConstFloatVectorDataPtr computeChannelData( const std::string &channelName, const Imath::V2i &tileOrigin, const Gaffer::Context *context, const ImagePlug *parent ) const;
 		
+		/// Implemented to compute R, G and B together, using hashColorData() and processColorData().
+		/// Where the input comes directly from another enabled ColorProcessor, the two are fused,
+		/// with processColorData() being applied for each in turn, so that a chain of colour
+		/// corrections is evaluated in a single pass.
+		virtual void hashMultiChannelData( const Imath::V2i &tileOrigin, const Gaffer::Context *context, IECore::MurmurHash &h ) const;
+		virtual IECore::ConstCompoundObjectPtr computeMultiChannelData( const Imath::V2i &tileOrigin, const Gaffer::Context *context ) const;
+		
 		/// Must be implemented by derived classes to return true if the specified input is used in processColorData().
 		/// Must first call the base class implementation and return true if it does.
 		virtual bool affectsColorData( const Gaffer::Plug *input ) const = 0;
@@ -90,9 +94,10 @@ class ColorProcessor : public ImageProcessor
 
 	private :
 		
-		// Used to store the result of processColorData(), so that it can be reused in computeChannelData().
-		Gaffer::ObjectPlug *colorDataPlug();
-		const Gaffer::ObjectPlug *colorDataPlug() const;
+		// Returns the ColorProcessor directly upstream of this one, if it
+		// can be fused with this one by applying its processColorData()
+		// as part of our own computation.
+		const ColorProcessor *fusableInput() const;
 		
 		static size_t g_firstPlugIndex;
 
@@ -63,8 +63,18 @@ class Display : public ImageNode
 				
 		virtual void affects( const Gaffer::Plug *input, AffectedPlugsContainer &outputs ) const;
 		
-		/// Emitted when a new bucket is received.
+		/// Emitted when new buckets have been received. Buckets received in quick
+		/// succession are coalesced so that this is emitted at most once per
+		/// update interval. Buckets which are held back are reported by a later
+		/// emission - or when the image is closed, or the interval has passed
+		/// without further buckets arriving, whichever comes first. This signal
+		/// may therefore be emitted on any thread.
 		static UnaryPlugSignal &dataReceivedSignal();
+		/// Sets the minimum time in seconds between emissions of dataReceivedSignal()
+		/// for each render. The default is 0.1 seconds, and a value of 0 emits the
+		/// signal for every bucket.
+		static void setUpdateInterval( double seconds );
+		static double getUpdateInterval();
 		/// Emitted when a complete image has been received.
 		static UnaryPlugSignal &imageReceivedSignal();
 		
@@ -52,6 +52,7 @@
 #include "IECore/Lookup.h"
 
 #include "GafferImage/TypeIds.h"
+#include "GafferImage/SIMD.h"
 	
 #define GAFFERIMAGE_FILTER_DECLAREFILTER( CLASS_NAME )\
 static FilterRegistration<CLASS_NAME> m_registration;\
@@ -121,6 +122,66 @@ public :
 	}
 	//@}
 
+	//! @name Kernel Banks
+	/// Precomputed kernels for convolution loops which apply the
+	/// same filter many times, such as when resampling an image.
+	//////////////////////////////////////////////////////////////
+	//@{
+	/// A bank of normalised kernels, precomputed at a number of evenly spaced
+	/// sub-pixel phases. Looking up the kernel for the nearest phase avoids a
+	/// call to weight() for every tap, and each kernel is padded with zeros to
+	/// a multiple of SIMD::Float::width so that it can be convolved directly
+	/// with contiguous pixels.
+	class KernelBank : public IECore::RefCounted
+	{
+
+		public :
+
+			/// The number of pixels covered by each kernel.
+			inline int width() const { return m_width; }
+			/// The distance between the starts of successive kernels.
+			inline int stride() const { return m_stride; }
+			/// The number of sub-pixel phases.
+			inline int phases() const { return m_phases; }
+
+			/// Returns the kernel for the phase nearest to center, setting
+			/// tap to the position of the first pixel it applies to. Unlike
+			/// Filter::tap(), center may be negative.
+			inline const float *kernel( float center, int &tap ) const
+			{
+				const float t = center - m_scaledRadius;
+				tap = fastFloor( t );
+				const int phase = int( ( t - tap ) * m_phases + 0.5f );
+				return &(m_weights[phase * m_stride]);
+			}
+
+		private :
+
+			friend class Filter;
+
+			KernelBank( const Filter *filter, int phases );
+
+			static inline int fastFloor( float f )
+			{
+				const int i = int( f );
+				return i - ( f < i );
+			}
+
+			int m_width;
+			int m_stride;
+			int m_phases;
+			float m_scaledRadius;
+			std::vector<float> m_weights;
+
+	};
+
+	IE_CORE_DECLAREPTR( KernelBank );
+
+	/// Returns a bank of kernels for the filter at its current scale.
+	/// The bank is not updated by subsequent calls to setScale().
+	ConstKernelBankPtr kernelBank( int phases = 64 ) const;
+	//@}
+
 	//! @name Filter Registry
 	/// A set of methods to query the available Filters and create them.
 	//////////////////////////////////////////////////////////////
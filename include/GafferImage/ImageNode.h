@@ -38,6 +38,8 @@
 #ifndef GAFFERSCENE_IMAGENODE_H
 #define GAFFERSCENE_IMAGENODE_H
 
+#include "IECore/CompoundObject.h"
+
 #include "Gaffer/ComputeNode.h"
 
 #include "GafferImage/ImagePlug.h"
@@ -111,6 +113,34 @@ class ImageNode : public Gaffer::ComputeNode
 		virtual IECore::ConstStringVectorDataPtr computeChannelNames( const Gaffer::Context *context, const ImagePlug *parent ) const = 0;
 		virtual IECore::ConstFloatVectorDataPtr computeChannelData( const std::string &channelName, const Imath::V2i &tileOrigin, const Gaffer::Context *context, const ImagePlug *parent ) const = 0;
 		
+		/// @name Multi-channel computation
+		/// Some nodes can compute several channels of a tile more efficiently together
+		/// than one at a time, for instance by sharing input queries, filter weights or
+		/// intermediate results between channels. Such nodes may implement
+		/// hashMultiChannelData() and computeMultiChannelData(), and then implement
+		/// hashChannelData() and computeChannelData() in terms of multiChannelDataPlug()
+		/// and multiChannelData(). The multi-channel result is computed and cached once
+		/// per tile, so the per-channel interface seen by downstream nodes is unchanged.
+		/// Derived classes must declare the inputs which affect multiChannelDataPlug()
+		/// in affects() - the effect of multiChannelDataPlug() on the channel data is
+		/// declared by ImageNode.
+		////////////////////////////////////////////////////////////////////
+		//@{
+		Gaffer::ObjectPlug *multiChannelDataPlug();
+		const Gaffer::ObjectPlug *multiChannelDataPlug() const;
+		/// Should be implemented to append everything computeMultiChannelData() uses to the hash,
+		/// after first calling the base class implementation. The channel name is deliberately
+		/// omitted from the hash, so that the result is shared by all channels of the tile.
+		virtual void hashMultiChannelData( const Imath::V2i &tileOrigin, const Gaffer::Context *context, IECore::MurmurHash &h ) const;
+		/// Should be implemented to return a CompoundObject mapping from channel names to
+		/// FloatVectorData tiles. Only the channels which are computed together need be included.
+		/// The default implementation returns an empty CompoundObject.
+		virtual IECore::ConstCompoundObjectPtr computeMultiChannelData( const Imath::V2i &tileOrigin, const Gaffer::Context *context ) const;
+		/// Returns the specified channel from the value of multiChannelDataPlug() in the current
+		/// context. Throws if the channel wasn't computed by computeMultiChannelData().
+		IECore::ConstFloatVectorDataPtr multiChannelData( const std::string &channelName ) const;
+		//@}
+
 		/// Implemented to initialize the default format settings if they don't exist already.
 		void parentChanging( Gaffer::GraphComponent *newParent );
 		
@@ -47,6 +47,13 @@
 #include "GafferImage/TypeIds.h"
 #include "GafferImage/FormatPlug.h"
 
+namespace Gaffer
+{
+
+IE_CORE_FORWARDDECLARE( Context )
+
+} // namespace Gaffer
+
 namespace GafferImage
 {
 
@@ -102,6 +109,30 @@ class ImagePlug : public Gaffer::CompoundPlug
 		/// InternedStrings on every lookup.
 		static const IECore::InternedString channelNameContextName;
 		static const IECore::InternedString tileOriginContextName;
+		/// The name of an optional context variable specifying the level of
+		/// detail at which images should be computed. At level n, images are
+		/// computed at 1/2^n of their full resolution, with formats and data
+		/// windows scaled to match using lodFormat() and lodWindow(). This allows
+		/// a whole graph to be evaluated cheaply at proxy resolution. Nodes which
+		/// process pixels independently of their position need do nothing to
+		/// support it, but nodes which read images or have parameters measured
+		/// in pixels must take it into account. FormatPlug values always refer
+		/// to the full resolution.
+		static const IECore::InternedString lodContextName;
+
+		/// @name Level of detail utilities
+		////////////////////////////////////////////////////////////////////
+		//@{
+		/// Returns the level of detail specified by the context, which
+		/// is 0 (full resolution) if it is not specified.
+		static int lod( const Gaffer::Context *context );
+		/// Returns the window of pixels at the specified level of detail which
+		/// covers a window of full resolution pixels. Pixel p at level n covers
+		/// the full resolution pixels from p * 2^n to ( p + 1 ) * 2^n - 1.
+		static Imath::Box2i lodWindow( const Imath::Box2i &window, int lod );
+		/// Returns the format with its display window scaled by lodWindow().
+		static Format lodFormat( const Format &format, int lod );
+		//@}
 		
 		/// @name Convenience accessors
 		/// These functions create temporary Contexts specifying image:channelName
@@ -119,14 +150,33 @@ class ImagePlug : public Gaffer::CompoundPlug
 		/// Y axis pointing downwards rather than Gaffer's internal representation where
 		/// the origin is in the bottom left of the display window with the Y axis
 		/// ascending towards the top of the display window.
+		/// The tiles are computed in parallel and copied into the image as
+		/// they arrive.
 		IECore::ImagePrimitivePtr image() const;
+		/// Returns a hash representing the whole image. The hashes of the
+		/// tiles are computed in parallel.
 		IECore::MurmurHash imageHash() const;
+		/// Fills tiles with the data for all the tiles covering the data window,
+		/// for each of the specified channels. The tiles of each channel are stored
+		/// contiguously, in rows starting from the bottom left of the data window,
+		/// so they are in Gaffer's native orientation. The tiles are computed in
+		/// parallel and are shared with the cache, so this provides a view of the
+		/// whole image for callers which don't need the copy and flip performed
+		/// by image().
+		void tiles( const std::vector<std::string> &channelNames, std::vector<IECore::ConstFloatVectorDataPtr> &tiles ) const;
 		//@}
 		
 		static int tileSize() { return 64; };
 		static Imath::Box2i tileBound( const Imath::V2i &tileOrigin ) { return Imath::Box2i( tileOrigin * tileSize(), ( tileOrigin + Imath::V2i( 1 ) ) * tileSize() - Imath::V2i( 1 ) ); }
 		static const IECore::FloatVectorData *blackTile();
 		static const IECore::FloatVectorData *whiteTile();
+		/// Returns a tile where every pixel has the specified value. Tiles are
+		/// shared between callers, so that flat regions of an image don't each
+		/// require their own copy of the same data.
+		static IECore::ConstFloatVectorDataPtr constantTile( float value );
+		/// Returns true if every pixel of the tile has the same value, storing
+		/// that value in the value argument.
+		static bool isConstantTile( const IECore::FloatVectorData *tile, float &value );
 		
 		/// Returns the origin of the tile that contains the point.
 		inline static Imath::V2i tileOrigin( const Imath::V2i &point )
@@ -68,6 +68,25 @@ class ImageProcessor : public ImageNode
 		virtual void hash( const Gaffer::ValuePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const;	
 		/// Reimplemented from ImageNode to pass through the inPlug() computations when the node is disabled.
 		virtual void compute( Gaffer::ValuePlug *output, const Gaffer::Context *context ) const;
+
+		/// Describes how much of a tile is covered by a data window.
+		enum TileCoverage
+		{
+			EmptyTile = 0,
+			PartialTile = 1,
+			FullTile = 2
+		};
+
+		/// Classifies the tile at tileOrigin against a data window. Pixels outside the data
+		/// window are black, so for an EmptyTile processors may return ImagePlug::blackTile()
+		/// with blackTileHash() rather than computing their inputs at all, and for a FullTile
+		/// they may often pass through the input tile and its hash.
+		static TileCoverage tileCoverage( const Imath::V2i &tileOrigin, const Imath::Box2i &dataWindow );
+		/// Returns the coverage of the tile specified by the context by the data window of
+		/// the specified input, which defaults to inPlug().
+		TileCoverage inputTileCoverage( const Gaffer::Context *context, const ImagePlug *input = NULL ) const;
+		/// The hash to be used for channelData outputs which are ImagePlug::blackTile().
+		static const IECore::MurmurHash &blackTileHash();
 		
 	private :
 	
@@ -38,6 +38,8 @@
 #ifndef GAFFERSCENE_IMAGEREADER_H
 #define GAFFERSCENE_IMAGEREADER_H
 
+#include "IECore/CompoundData.h"
+
 #include "GafferImage/ImageNode.h"
 
 namespace GafferImage
@@ -65,6 +67,30 @@ class ImageReader : public ImageNode
 		virtual bool enabled() const;
 		
 		static size_t supportedExtensions( std::vector<std::string> &extensions );
+
+		/// @name Cache management
+		/// The ImageReader uses an OpenImageIO ImageCache to load and
+		/// store file data, independently of the cache used by ValuePlug.
+		/// Half data is stored as half in this cache, but the tiles output
+		/// by the reader are always converted to float. These functions
+		/// allow for management of that cache.
+		////////////////////////////////////////////////////////////////////
+		//@{
+		/// Returns the maximum amount of memory in bytes to use for the cache.
+		static size_t getCacheMemoryLimit();
+		/// Sets the maximum amount of memory the cache may use in bytes.
+		static void setCacheMemoryLimit( size_t bytes );
+		/// Returns the maximum number of files the cache may hold open at once.
+		static size_t getCacheMaxOpenFiles();
+		/// Sets the maximum number of files the cache may hold open at once.
+		static void setCacheMaxOpenFiles( size_t maxOpenFiles );
+		/// Returns the current memory usage of the cache in bytes.
+		static size_t cacheMemoryUsage();
+		/// Returns statistics describing the usage of the cache. This contains
+		/// "memoryUsage", "bytesRead", "hits", "misses", "filesOpened",
+		/// "filesCurrentlyOpen" and "filesPeakOpen" entries.
+		static IECore::CompoundDataPtr cacheStatistics();
+		//@}
 		
 	protected :
 		
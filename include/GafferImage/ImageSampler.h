@@ -39,6 +39,7 @@
 
 #include "Gaffer/ComputeNode.h"
 #include "Gaffer/CompoundNumericPlug.h"
+#include "Gaffer/TypedObjectPlug.h"
 
 #include "GafferImage/TypeIds.h"
 
@@ -48,7 +49,11 @@ namespace GafferImage
 IE_CORE_FORWARDDECLARE( ImagePlug )
 IE_CORE_FORWARDDECLARE( FilterPlug )
 
-/// Samples colours at image locations.
+/// Samples colours at image locations. A single location may be sampled using
+/// the pixel and color plugs, or many locations may be sampled at once using the
+/// pixels and colors plugs. The latter is far more efficient than sampling each
+/// location individually, as the locations are grouped by tile and sampled in
+/// parallel, with each tile being fetched only once per group.
 /// \todo Support for choosing which channels to sample - ideally
 /// we need ChannelMaskPlug to properly support layers to do that.
 class ImageSampler : public Gaffer::ComputeNode
@@ -72,6 +77,13 @@ class ImageSampler : public Gaffer::ComputeNode
 		
 		Gaffer::Color4fPlug *colorPlug();
 		const Gaffer::Color4fPlug *colorPlug() const;
+
+		Gaffer::V2fVectorDataPlug *pixelsPlug();
+		const Gaffer::V2fVectorDataPlug *pixelsPlug() const;
+
+		/// Outputs a colour for each of the locations in pixelsPlug().
+		Gaffer::Color4fVectorDataPlug *colorsPlug();
+		const Gaffer::Color4fVectorDataPlug *colorsPlug() const;
 		
 		virtual void affects( const Gaffer::Plug *input, AffectedPlugsContainer &outputs ) const;
 				
@@ -85,6 +97,9 @@ class ImageSampler : public Gaffer::ComputeNode
 		// Returns the channel to be read for the specified child of colorPlug(),
 		// returning the empty string if the channel doesn't exist.
 		std::string channelName( const Gaffer::ValuePlug *output ) const;
+
+		void hashColors( const Gaffer::Context *context, IECore::MurmurHash &h ) const;
+		IECore::ConstColor4fVectorDataPtr computeColors( const Gaffer::Context *context ) const;
 		
 		static size_t g_firstPlugIndex;
 		
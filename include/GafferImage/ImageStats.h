@@ -40,6 +40,8 @@
 #include "Gaffer/ComputeNode.h"
 #include "Gaffer/CompoundNumericPlug.h"
 #include "Gaffer/BoxPlug.h"
+#include "Gaffer/NumericPlug.h"
+#include "Gaffer/TypedObjectPlug.h"
 
 #include "GafferImage/ImagePlug.h"
 #include "GafferImage/ChannelMaskPlug.h"
@@ -48,7 +50,10 @@ namespace GafferImage
 {
 
 /// Provides statistics on an image's colour profile. 
-/// The ImageStats node outputs the minimum, maximum and average values of the pixel values within a region of interest in the image.
+/// The ImageStats node outputs the minimum, maximum and average values of the pixel values within a region of interest in the image,
+/// along with a histogram of each channel and an estimate of a chosen percentile. All of the statistics are gathered for every
+/// channel at once in a single parallel pass over the tiles of the region, the result of which is cached on an internal plug
+/// and shared by all of the outputs.
 class ImageStats : public Gaffer::ComputeNode
 {
 
@@ -73,19 +78,47 @@ class ImageStats : public Gaffer::ComputeNode
 		const Gaffer::Color4fPlug *minPlug() const;
 		Gaffer::Color4fPlug *maxPlug();
 		const Gaffer::Color4fPlug *maxPlug() const;
+		/// The number of bins in the histogram of each channel.
+		Gaffer::IntPlug *histogramBinsPlug();
+		const Gaffer::IntPlug *histogramBinsPlug() const;
+		/// The range of values covered by the histogram. Values outside
+		/// the range are counted in the first or last bin.
+		Gaffer::V2fPlug *histogramRangePlug();
+		const Gaffer::V2fPlug *histogramRangePlug() const;
+		/// The percentile (in the range 0-100) output by the percentileValue plug.
+		Gaffer::FloatPlug *percentilePlug();
+		const Gaffer::FloatPlug *percentilePlug() const;
+		/// The value below which the requested percentage of pixels fall. This is
+		/// interpolated from the histogram, so is only accurate to within the
+		/// width of a single bin.
+		Gaffer::Color4fPlug *percentileValuePlug();
+		const Gaffer::Color4fPlug *percentileValuePlug() const;
+		/// Outputs an IntVectorData of bin counts for each of the masked channels,
+		/// keyed by channel name.
+		Gaffer::CompoundObjectPlug *histogramPlug();
+		const Gaffer::CompoundObjectPlug *histogramPlug() const;
 
 	protected :
 	
-		/// Implemented to hash the area we are sampling along with the channel context and regionOfInterest.
+		/// Implemented to hash the tiles within the regionOfInterest for the statistics plug, and the
+		/// statistics plug along with the channel for all the other outputs.
 		virtual void hash( const Gaffer::ValuePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const;
 
-		/// Computes the min, max and average plugs by analyzing the input ImagePlug.
+		/// Computes the statistics plug by analyzing the input ImagePlug, and the remaining outputs from that.
 		virtual void compute( Gaffer::ValuePlug *output, const Gaffer::Context *context ) const;
 
 	private :
 		
 		void inputChanged( Gaffer::Plug *plug );
 
+		/// Holds a CompoundObject per channel, containing the "min", "max", "average" and
+		/// "histogram" of that channel. All other outputs are computed from this.
+		Gaffer::CompoundObjectPlug *statisticsPlug();
+		const Gaffer::CompoundObjectPlug *statisticsPlug() const;
+
+		void hashStatistics( const Gaffer::Context *context, IECore::MurmurHash &h ) const;
+		IECore::ConstCompoundObjectPtr computeStatistics( const Gaffer::Context *context ) const;
+
 		/// Sets channelName to the channel which corresponds to the output plug. The channel name is
 		/// computed from the intersection of the "in" plug's channels and the "channels" plug's channels.
 		/// If multiple channels are found to have the same channel index, the first is used.
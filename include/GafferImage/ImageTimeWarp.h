@@ -37,13 +37,60 @@
 #ifndef GAFFERIMAGE_IMAGETIMEWARP_H
 #define GAFFERIMAGE_IMAGETIMEWARP_H
 
+#include "Gaffer/Context.h"
 #include "Gaffer/TimeWarp.h"
+#include "Gaffer/TypedPlug.h"
+
 #include "GafferImage/ImageMixinBase.h"
 
 namespace GafferImage
 {
 
-typedef Gaffer::TimeWarp<ImageMixinBase> ImageTimeWarp;
+typedef Gaffer::TimeWarp<ImageMixinBase> ImageTimeWarpBase;
+IE_CORE_DECLAREPTR( ImageTimeWarpBase )
+
+/// Retimes an image by modifying the frame at which the input is evaluated.
+/// When frame blending is turned on and the retimed frame falls between two
+/// whole frames, the output is instead a linear blend of the input at those
+/// two frames. Their tiles are computed in parallel, and are fetched from the
+/// input plug so that they are shared via the usual value cache with any other
+/// blended frame that needs them.
+class ImageTimeWarp : public ImageTimeWarpBase
+{
+
+	public :
+
+		ImageTimeWarp( const std::string &name=defaultName<ImageTimeWarp>() );
+		virtual ~ImageTimeWarp();
+
+		IE_CORE_DECLARERUNTIMETYPEDEXTENSION( GafferImage::ImageTimeWarp, ImageTimeWarpTypeId, ImageTimeWarpBase );
+
+		Gaffer::BoolPlug *frameBlendingPlug();
+		const Gaffer::BoolPlug *frameBlendingPlug() const;
+
+		virtual void affects( const Gaffer::Plug *input, AffectedPlugsContainer &outputs ) const;
+
+	protected :
+
+		/// Reimplemented to blend between frames when required, deferring
+		/// to ContextProcessor otherwise.
+		virtual void hash( const Gaffer::ValuePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const;
+		virtual void compute( Gaffer::ValuePlug *output, const Gaffer::Context *context ) const;
+
+	private :
+
+		// Returns true if the output should be blended from two frames, filling
+		// frameContexts with contexts for evaluating the input at each of them, and
+		// setting mix to the weight of the second.
+		bool frameBlending( const Gaffer::Context *context, Gaffer::ContextPtr frameContexts[2], float &mix ) const;
+
+		void hashBlendedChannelData( const Gaffer::Context *context, const Gaffer::ContextPtr frameContexts[2], float mix, IECore::MurmurHash &h ) const;
+		IECore::ConstFloatVectorDataPtr computeBlendedChannelData( const Gaffer::Context *context, const Gaffer::ContextPtr frameContexts[2], float mix ) const;
+
+		static size_t g_firstPlugIndex;
+
+};
+
 IE_CORE_DECLAREPTR( ImageTimeWarp )
 
 } // namespace GafferImage
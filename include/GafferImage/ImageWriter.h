@@ -39,6 +39,7 @@
 
 #include "Gaffer/ExecutableNode.h"
 #include "Gaffer/NumericPlug.h"
+#include "Gaffer/TypedPlug.h"
 
 #include "GafferImage/TypeIds.h"
 
@@ -59,6 +60,12 @@ class ImageWriter : public Gaffer::ExecutableNode
 			Tile = 1
 		};
 
+		enum DataType
+		{
+			Float = 0,
+			Half = 1
+		};
+
 		ImageWriter( const std::string &name=defaultName<ImageWriter>() );
 		virtual ~ImageWriter();
 
@@ -76,6 +83,30 @@ class ImageWriter : public Gaffer::ExecutableNode
 		Gaffer::IntPlug *writeModePlug();
 		const Gaffer::IntPlug *writeModePlug() const;
 		
+		/// The data type used to store channels in the file.
+		Gaffer::IntPlug *dataTypePlug();
+		const Gaffer::IntPlug *dataTypePlug() const;
+		
+		/// Channels which are always stored as Float, regardless
+		/// of the value of dataTypePlug(). This allows depth and
+		/// id channels to retain their precision when the colour
+		/// channels are written as Half.
+		GafferImage::ChannelMaskPlug *floatChannelsPlug();
+		const GafferImage::ChannelMaskPlug *floatChannelsPlug() const;
+		
+		/// The compression method used by the file. An empty string
+		/// uses the default for the file format.
+		Gaffer::StringPlug *compressionPlug();
+		const Gaffer::StringPlug *compressionPlug() const;
+		
+		/// When on, and the file format supports it, each layer of
+		/// channels is written to a separate part (subimage) of the
+		/// file. The layer of a channel is the prefix preceding the
+		/// last "." in its name, and unprefixed channels are written
+		/// to a part named "rgba".
+		Gaffer::BoolPlug *multiPartPlug();
+		const Gaffer::BoolPlug *multiPartPlug() const;
+		
 		virtual IECore::MurmurHash executionHash( const Gaffer::Context *context ) const;
 
 		virtual void execute( const Contexts &contexts ) const;
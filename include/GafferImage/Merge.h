@@ -38,6 +38,7 @@
 #define GAFFERIMAGE_MERGE_H
 
 #include "GafferImage/FilterProcessor.h"
+#include "GafferImage/SIMD.h"
 
 namespace GafferImage
 {
@@ -104,9 +105,21 @@ class Merge : public FilterProcessor
 	
 	private :
 		
-		/// Performs the merge operation using the functor 'F'.
+		/// Performs the merge operation using the functor 'F', merging each input
+		/// in turn under the result of merging the inputs which follow it.
 		template< typename F >
-		IECore::ConstFloatVectorDataPtr doMergeOperation( F f, std::vector< IECore::ConstFloatVectorDataPtr > &inData, std::vector< IECore::ConstFloatVectorDataPtr > &inAlpha, const Imath::V2i &tileOrigin ) const;
+		IECore::ConstFloatVectorDataPtr doMergeOperation( F f, const std::vector<const ImagePlug *> &inputs, const std::string &channelName, const Imath::V2i &tileOrigin ) const;
+
+		/// Fills inputs with the input plugs which are connected.
+		void connectedInputs( std::vector<const ImagePlug *> &inputs ) const;
+
+		/// Returns true if merging a black, transparent input under the
+		/// result of the following inputs leaves it unchanged.
+		static bool blackInputIsIdentity( int operation );
+
+		/// Returns the channel data for a tile of an input, without computing it
+		/// if the tile lies outside the input's data window.
+		IECore::ConstFloatVectorDataPtr inputChannelData( const ImagePlug *input, const std::string &channelName, const Imath::V2i &tileOrigin ) const;
 
 		/// A useful method which returns true if the StringVector contains the channel "A".
 		inline bool hasAlpha( IECore::ConstStringVectorDataPtr channelNamesData ) const;
@@ -34,43 +34,92 @@
 //  
 //////////////////////////////////////////////////////////////////////////
 
+namespace Detail
+{
+
+/// Merges the tile B with alpha b under the tile A with alpha a, modifying
+/// A and a in place. The data and alpha are processed together, SIMD::Float::width
+/// pixels at a time.
+template< typename F >
+void mergeTiles( F f, float *A, float *a, const float *B, const float *b )
+{
+	const int n = ImagePlug::tileSize() * ImagePlug::tileSize();
+	int i = 0;
+	for( ; i + SIMD::Float::width <= n; i += SIMD::Float::width )
+	{
+		const SIMD::Float vA = SIMD::Float::load( A + i );
+		const SIMD::Float va = SIMD::Float::load( a + i );
+		const SIMD::Float vB = SIMD::Float::load( B + i );
+		const SIMD::Float vb = SIMD::Float::load( b + i );
+		f( vA, vB, va, vb ).store( A + i );
+		f( va, vb, va, vb ).store( a + i );
+	}
+	for( ; i < n; ++i )
+	{
+		const float ai = a[i];
+		A[i] = f( A[i], B[i], ai, b[i] );
+		a[i] = f( ai, b[i], ai, b[i] );
+	}
+}
+
+} // namespace Detail
+
 template< typename F >
-IECore::ConstFloatVectorDataPtr Merge::doMergeOperation( F f, std::vector< IECore::ConstFloatVectorDataPtr > &inData, std::vector< IECore::ConstFloatVectorDataPtr > &inAlpha, const Imath::V2i &tileOrigin ) const
+IECore::ConstFloatVectorDataPtr Merge::doMergeOperation( F f, const std::vector<const ImagePlug *> &inputs, const std::string &channelName, const Imath::V2i &tileOrigin ) const
 {
-	// Allocate the new tile
-	Imath::Box2i tile( tileOrigin, Imath::V2i( tileOrigin.x + ImagePlug::tileSize() - 1, tileOrigin.y + ImagePlug::tileSize() - 1 ) );
-	IECore::FloatVectorDataPtr outDataPtr = inData.back()->copy();
-	std::vector<float> &outData = outDataPtr->writable();
+	// Start with the last input, and merge each of the preceding inputs under it in turn.
+	IECore::ConstFloatVectorDataPtr A = inputChannelData( inputs.back(), channelName, tileOrigin );
+	IECore::ConstFloatVectorDataPtr a = inputChannelData( inputs.back(), "A", tileOrigin );
 
-	// Allocate a temporary tile that will hold the intermediate values of the alpha channel.
-	IECore::FloatVectorDataPtr aOut = inAlpha.back()->copy();
-	std::vector<float> &outAlpha = aOut->writable();
-	
-	// Perform the operation.
-	unsigned int nIterations( inData.size() -1 );
-	for( unsigned int i = nIterations; i > 0; --i )
+	// Writable copies of A and a, made only when we first need to modify them.
+	IECore::FloatVectorDataPtr outData, outAlpha;
+
+	for( size_t i = inputs.size() - 1; i > 0; --i )
 	{
-		for( int y = tile.min.y; y<=tile.max.y; y++ )
+		float AValue, aValue, BValue, bValue;
+		const bool constantAlpha = ImagePlug::isConstantTile( a.get(), aValue );
+
+		// If A is opaque then nothing beneath it can contribute, and we needn't
+		// even compute the remaining inputs.
+		if( F::opaqueAHidesB && constantAlpha && aValue == 1.0f )
 		{
-			// Compute the data values and afterwards, the intermediate alpha values.
-			const float *dIn1 = &(outData[0]) + ( y - tileOrigin.y ) * ImagePlug::tileSize() + (tile.min.x - tileOrigin.x);
-			const float *dIn2 = &(inData[i-1]->readable()[0]) + (y - tileOrigin.y) * ImagePlug::tileSize() + (tile.min.x - tileOrigin.x);	
-			const float *aIn1 = &(outAlpha[0]) + ( y - tileOrigin.y ) * ImagePlug::tileSize() + (tile.min.x - tileOrigin.x);
-			const float *aIn2 = &(inAlpha[i-1]->readable()[0]) + (y - tileOrigin.y) * ImagePlug::tileSize() + (tile.min.x - tileOrigin.x);
+			break;
+		}
 
-			float *dOut = &(outData[0]) + ( y - tileOrigin.y ) * ImagePlug::tileSize() + (tile.min.x - tileOrigin.x);
-			float *aOut = &(outAlpha[0]) + ( y - tileOrigin.y ) * ImagePlug::tileSize() + (tile.min.x - tileOrigin.x);
+		const bool constantA = constantAlpha && ImagePlug::isConstantTile( A.get(), AValue );
 
-			const float *END = dOut+(tile.max.x-tile.min.x)+1;
-			while( dOut != END )
-			{
-				*dOut++ = f( *dIn1++, *dIn2++, *aIn1, *aIn2 );
-				*aOut++ = f( *aIn1, *aIn2, *aIn1, *aIn2 );
-				++aIn1;
-				++aIn2;
-			}	
+		IECore::ConstFloatVectorDataPtr B = inputChannelData( inputs[i-1], channelName, tileOrigin );
+		IECore::ConstFloatVectorDataPtr b = inputChannelData( inputs[i-1], "A", tileOrigin );
+		const bool constantB = ImagePlug::isConstantTile( b.get(), bValue ) && ImagePlug::isConstantTile( B.get(), BValue );
+
+		// Skip inputs which are black and transparent, where they would have no effect.
+		if( F::blackBIsIdentity && constantB && BValue == 0.0f && bValue == 0.0f )
+		{
+			continue;
 		}
+
+		// If everything is constant, then so is the result, and we need only
+		// compute a single value.
+		if( constantA && constantB )
+		{
+			A = ImagePlug::constantTile( f( AValue, BValue, aValue, bValue ) );
+			a = ImagePlug::constantTile( f( aValue, bValue, aValue, bValue ) );
+			continue;
+		}
+
+		if( A.get() != outData.get() )
+		{
+			outData = A->copy();
+			A = outData;
+		}
+		if( a.get() != outAlpha.get() )
+		{
+			outAlpha = a->copy();
+			a = outAlpha;
+		}
+
+		Detail::mergeTiles( f, &(outData->writable()[0]), &(outAlpha->writable()[0]), &(B->readable()[0]), &(b->readable()[0]) );
 	}
-	return outDataPtr;
-}
 
+	return A;
+}
@@ -38,6 +38,8 @@
 #ifndef GAFFERIMAGE_OPENCOLORIO_H
 #define GAFFERIMAGE_OPENCOLORIO_H
 
+#include "Gaffer/NumericPlug.h"
+
 #include "GafferImage/ColorProcessor.h"
 
 namespace GafferImage
@@ -59,6 +61,19 @@ class OpenColorIO : public ColorProcessor
 		Gaffer::StringPlug *outputSpacePlug();
 		const Gaffer::StringPlug *outputSpacePlug() const;
 
+		/// When on, the transform is baked into a 3D LUT of lutSize^3 entries
+		/// covering inputs in the range 0-16, and applied by interpolating within
+		/// that. This is much quicker than applying the transform directly, but
+		/// is only an approximation, so is best suited to display transforms.
+		/// The LUT is sampled logarithmically, so that the shadows, where display
+		/// transforms tend to be steepest, keep their precision. Inputs outside
+		/// the range of the LUT are still transformed exactly. Off by default.
+		Gaffer::BoolPlug *bakeLUTPlug();
+		const Gaffer::BoolPlug *bakeLUTPlug() const;
+
+		Gaffer::IntPlug *lutSizePlug();
+		const Gaffer::IntPlug *lutSizePlug() const;
+
 	protected :
 
 		/// Overrides the default implementation to disable the node when the input color space is
@@ -70,7 +85,9 @@ class OpenColorIO : public ColorProcessor
 		virtual void processColorData( const Gaffer::Context *context, IECore::FloatVectorData *r, IECore::FloatVectorData *g, IECore::FloatVectorData *b ) const;
 
 	private :
-	
+
+		void processColorDataWithLUT( const std::string &inputSpace, const std::string &outputSpace, int lutSize, IECore::FloatVectorData *r, IECore::FloatVectorData *g, IECore::FloatVectorData *b ) const;
+
 		static size_t g_firstPlugIndex;
 				
 };
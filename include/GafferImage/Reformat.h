@@ -39,6 +39,7 @@
 
 #include "GafferImage/ImageProcessor.h"
 #include "GafferImage/FilterPlug.h"
+#include "GafferImage/Sampler.h"
 
 namespace GafferImage
 {
@@ -65,6 +66,16 @@ class Reformat : public ImageProcessor
 
 		virtual void affects( const Gaffer::Plug *input, AffectedPlugsContainer &outputs ) const;
 		virtual bool enabled() const;
+
+		/// Resamples a tile of an image using a separable filter, mapping the center of each output
+		/// pixel x to ( x + 0.5 ) / scale.x + offset.x in the input, and likewise in y. The filter is
+		/// widened appropriately where scale is less than 1. This is the implementation of the Reformat
+		/// node, and may also be used by other nodes which perform axis-aligned scales and translations.
+		static IECore::FloatVectorDataPtr resample(
+			const ImagePlug *image, const std::string &channelName, const Imath::V2i &tileOrigin,
+			const std::string &filter, const Imath::V2d &scale, const Imath::V2d &offset,
+			Sampler::BoundingMode boundingMode
+		);
 				
 	protected :
 		
@@ -78,10 +89,11 @@ class Reformat : public ImageProcessor
 		virtual IECore::ConstStringVectorDataPtr computeChannelNames( const Gaffer::Context *context, const ImagePlug *parent ) const;
 
 		/// Reformats the input plug with a filter by doing a 2-pass squash/stretch.
-		/// We reformat the image by doing two passes over the input in first the horizontal and then vertical directions.
-		/// On each pass we use the chosen filter to create a (row or column) buffer of pixels their weighted contributeion to each pixel on the row or column.
-		/// Using this column/row buffer we iterate over the input and sum the contributing pixels. The result is normalized by the sum of weights.
-		/// This process is repeated once for the vertical and horizontal passes and the final result is written into the output buffer.
+		/// We reformat the image by doing two passes over the input in first the vertical and then horizontal directions.
+		/// For each pass the chosen filter provides a (row or column) table of the input pixels which contribute to each output
+		/// pixel, and their normalised weights. These tables depend only on the filter, the formats and the position of the tile,
+		/// so they are cached and shared between channels and between tiles in the same row or column. The vertical pass sums
+		/// whole rows of the input at once, allowing it to be vectorised.
 		virtual IECore::ConstFloatVectorDataPtr computeChannelData( const std::string &channelName, const Imath::V2i &tileOrigin, const Gaffer::Context *context, const ImagePlug *parent ) const;
 		
 		// Computes the output scale factor from the input and output formats.
@@ -89,6 +101,10 @@ class Reformat : public ImageProcessor
 
 	private :
 
+		// Returns the value of the format plug, reduced to match
+		// the level of detail being computed.
+		GafferImage::Format outputFormat() const;
+
 		static size_t g_firstPlugIndex;
 		
 };
@@ -0,0 +1,129 @@
+//////////////////////////////////////////////////////////////////////////
+//  
+//  Copyright (c) 2014, Image Engine Design Inc. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//  
+//      * Redistributions of source code must retain the above
+//        copyright notice, this list of conditions and the following
+//        disclaimer.
+//  
+//      * Redistributions in binary form must reproduce the above
+//        copyright notice, this list of conditions and the following
+//        disclaimer in the documentation and/or other materials provided with
+//        the distribution.
+//  
+//      * Neither the name of John Haddon nor the names of
+//        any other contributors to this software may be used to endorse or
+//        promote products derived from this software without specific prior
+//        written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//////////////////////////////////////////////////////////////////////////
+
+#ifndef GAFFERIMAGE_SIMD_H
+#define GAFFERIMAGE_SIMD_H
+
+#if defined( __AVX__ )
+#include <immintrin.h>
+#elif defined( __SSE__ )
+#include <xmmintrin.h>
+#endif
+
+namespace GafferImage
+{
+
+namespace SIMD
+{
+
+/// A minimal wrapper around a vector of floats, using the widest
+/// instruction set available at compile time - AVX, SSE or plain
+/// scalar code. This allows kernels to be written once in terms of
+/// Float and the arithmetic operators, and processed Float::width
+/// elements at a time. Loads and stores are unaligned, as tiles
+/// are stored in std::vectors.
+struct Float
+{
+
+#if defined( __AVX__ )
+
+	typedef __m256 Native;
+	enum { width = 8 };
+
+	Float() {}
+	Float( Native n ) : v( n ) {}
+	explicit Float( float f ) : v( _mm256_set1_ps( f ) ) {}
+
+	static Float load( const float *p ) { return Float( _mm256_loadu_ps( p ) ); }
+	void store( float *p ) const { _mm256_storeu_ps( p, v ); }
+
+#elif defined( __SSE__ )
+
+	typedef __m128 Native;
+	enum { width = 4 };
+
+	Float() {}
+	Float( Native n ) : v( n ) {}
+	explicit Float( float f ) : v( _mm_set1_ps( f ) ) {}
+
+	static Float load( const float *p ) { return Float( _mm_loadu_ps( p ) ); }
+	void store( float *p ) const { _mm_storeu_ps( p, v ); }
+
+#else
+
+	typedef float Native;
+	enum { width = 1 };
+
+	Float() {}
+	explicit Float( float f ) : v( f ) {}
+
+	static Float load( const float *p ) { return Float( *p ); }
+	void store( float *p ) const { *p = v; }
+
+#endif
+
+	Native v;
+
+};
+
+#if defined( __AVX__ )
+
+inline Float operator + ( const Float &a, const Float &b ) { return Float( _mm256_add_ps( a.v, b.v ) ); }
+inline Float operator - ( const Float &a, const Float &b ) { return Float( _mm256_sub_ps( a.v, b.v ) ); }
+inline Float operator * ( const Float &a, const Float &b ) { return Float( _mm256_mul_ps( a.v, b.v ) ); }
+inline Float operator / ( const Float &a, const Float &b ) { return Float( _mm256_div_ps( a.v, b.v ) ); }
+
+#elif defined( __SSE__ )
+
+inline Float operator + ( const Float &a, const Float &b ) { return Float( _mm_add_ps( a.v, b.v ) ); }
+inline Float operator - ( const Float &a, const Float &b ) { return Float( _mm_sub_ps( a.v, b.v ) ); }
+inline Float operator * ( const Float &a, const Float &b ) { return Float( _mm_mul_ps( a.v, b.v ) ); }
+inline Float operator / ( const Float &a, const Float &b ) { return Float( _mm_div_ps( a.v, b.v ) ); }
+
+#else
+
+inline Float operator + ( const Float &a, const Float &b ) { return Float( a.v + b.v ); }
+inline Float operator - ( const Float &a, const Float &b ) { return Float( a.v - b.v ); }
+inline Float operator * ( const Float &a, const Float &b ) { return Float( a.v * b.v ); }
+inline Float operator / ( const Float &a, const Float &b ) { return Float( a.v / b.v ); }
+
+#endif
+
+} // namespace SIMD
+
+} // namespace GafferImage
+
+#endif // GAFFERIMAGE_SIMD_H
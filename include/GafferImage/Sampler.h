@@ -82,6 +82,23 @@ class Sampler
 		/// Sub-samples the image using a filter.
 		inline float sample( float x, float y );
 
+		/// Returns a pointer to the run of contiguous pixels which starts at x, y
+		/// and lies within a single tile and within the sample window, setting
+		/// length to the number of pixels in the run. The point x, y must lie
+		/// within the sample window - this method doesn't apply the bounding mode.
+		/// This allows tight loops over rows to avoid the per-pixel overhead of sample().
+		inline const float *span( int x, int y, int &length );
+
+		/// Fills buffer with the width pixels which start at x, y, gathering
+		/// them from as many tiles as necessary. The bounding mode is applied
+		/// to pixels outside the sample window.
+		void row( int x, int y, int width, float *buffer );
+
+		/// Computes all the tiles needed for the sample window in parallel.
+		/// Without this, tiles are computed serially on demand as they are
+		/// first sampled.
+		void prefetch();
+
 		/// Accumulates the hashes of the tiles that it accesses.
 		void hash( IECore::MurmurHash &h ) const;
 
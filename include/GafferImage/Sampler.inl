@@ -121,6 +121,16 @@ float Sampler::sample( int x, int y )
 	return *(tileData + tileIndex.y * ImagePlug::tileSize() + tileIndex.x);
 }
 
+const float *Sampler::span( int x, int y, int &length )
+{
+	const float *tileData;
+	Imath::V2i tileOrigin;
+	Imath::V2i tileIndex;
+	cachedData( Imath::V2i( x, y ), tileData, tileOrigin, tileIndex );
+	length = std::min( tileOrigin.x + ImagePlug::tileSize(), m_sampleWindow.max.x + 1 ) - x;
+	return tileData + tileIndex.y * ImagePlug::tileSize() + tileIndex.x;
+}
+
 void Sampler::cachedData( Imath::V2i p, const float *& tileData, Imath::V2i &tileOrigin, Imath::V2i &tileIndex )
 {
 	// Get the smart pointer to the tile we want.
@@ -87,6 +87,8 @@ enum TypeId
 	ImageContextVariablesTypeId = 110791,
 	ImageSwitchTypeId = 110792,
 	ImageSamplerTypeId = 110793,
+	BlurTypeId = 110794,
+	ImageTimeWarpBaseTypeId = 110795,
 
 	LastTypeId = 110849
 };
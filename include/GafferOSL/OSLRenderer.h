@@ -54,7 +54,7 @@ IE_CORE_FORWARDDECLARE( OSLRenderer )
 /// so that code for declaring shaders and state to an actual renderer can be reused for
 /// specifying the shaders and state to be executed with here.
 /// \threading None of the methods of this class are threadsafe, but ShadingEngine::shade()
-/// method is.
+/// method is, and shades the points in parallel itself.
 class OSLRenderer : public IECore::Renderer
 {
 
@@ -155,6 +155,7 @@ class OSLRenderer : public IECore::Renderer
 		class RenderState;
 		class RendererServices;
 		class ShadingResults;
+		class ShadingBody;
 		
 		enum ClosureId
 		{
@@ -0,0 +1,267 @@
+##########################################################################
+#  
+#  Copyright (c) 2014, John Haddon. All rights reserved.
+#  
+#  Redistribution and use in source and binary forms, with or without
+#  modification, are permitted provided that the following conditions are
+#  met:
+#  
+#      * Redistributions of source code must retain the above
+#        copyright notice, this list of conditions and the following
+#        disclaimer.
+#  
+#      * Redistributions in binary form must reproduce the above
+#        copyright notice, this list of conditions and the following
+#        disclaimer in the documentation and/or other materials provided with
+#        the distribution.
+#  
+#      * Neither the name of John Haddon nor the names of
+#        any other contributors to this software may be used to endorse or
+#        promote products derived from this software without specific prior
+#        written permission.
+#  
+#  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+#  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+#  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+#  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+#  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+#  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+#  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+#  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+#  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+#  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+#  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+#  
+##########################################################################
+
+import os
+import unittest
+
+import IECore
+
+import Gaffer
+import GafferTest
+import GafferImage
+
+class BlurTest( GafferTest.TestCase ) :
+
+	checkerPath = os.path.expandvars( "$GAFFER_ROOT/python/GafferTest/images/checker.exr" )
+
+	def testZeroRadiusPassThrough( self ) :
+
+		r = GafferImage.ImageReader()
+		r["fileName"].setValue( self.checkerPath )
+
+		b = GafferImage.Blur()
+		b["in"].setInput( r["out"] )
+
+		self.assertEqual( b["out"].imageHash(), r["out"].imageHash() )
+		self.assertEqual( b["out"].image(), r["out"].image() )
+
+		for t in ( GafferImage.Blur.Type.Box, GafferImage.Blur.Type.Gaussian ) :
+			b["type"].setValue( t )
+			b["radius"].setValue( IECore.V2f( 0.25 ) )
+			self.assertEqual( b["out"].imageHash(), r["out"].imageHash() )
+
+	def testDataWindow( self ) :
+
+		c = GafferImage.Constant()
+		c["format"].setValue( GafferImage.Format( 200, 100, 1. ) )
+
+		b = GafferImage.Blur()
+		b["in"].setInput( c["out"] )
+		b["radius"].setValue( IECore.V2f( 5, 10 ) )
+
+		self.assertEqual( b["out"]["format"].getValue(), c["out"]["format"].getValue() )
+		self.assertEqual( b["out"]["channelNames"].getValue(), c["out"]["channelNames"].getValue() )
+		self.assertEqual(
+			b["out"]["dataWindow"].getValue(),
+			IECore.Box2i( IECore.V2i( -5, -10 ), IECore.V2i( 204, 109 ) )
+		)
+
+	def testConstant( self ) :
+
+		c = GafferImage.Constant()
+		c["format"].setValue( GafferImage.Format( 200, 200, 1. ) )
+		c["color"].setValue( IECore.Color4f( 0.25, 0.5, 0.75, 1 ) )
+
+		b = GafferImage.Blur()
+		b["in"].setInput( c["out"] )
+
+		for t in ( GafferImage.Blur.Type.Box, GafferImage.Blur.Type.Gaussian ) :
+
+			b["type"].setValue( t )
+			b["radius"].setValue( IECore.V2f( 20 ) )
+
+			# Away from the edges, blurring a constant has no effect.
+			sampler = GafferImage.Sampler( b["out"], "G", IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 199 ) ) )
+			for p in ( ( 100, 100 ), ( 30, 170 ), ( 64, 64 ), ( 127, 63 ) ) :
+				self.assertAlmostEqual( sampler.sample( p[0], p[1] ), 0.5, 5 )
+
+			# But at the edges, black is blurred in from outside the data window.
+			self.assertLess( sampler.sample( 0, 0 ), 0.5 )
+			self.assertGreater( sampler.sample( 0, 0 ), 0 )
+
+	def testBoxAgainstBruteForce( self ) :
+
+		dataWindow = IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 99 ) )
+		image = IECore.ImagePrimitive( dataWindow, dataWindow )
+		red = IECore.FloatVectorData()
+		image["R"] = IECore.PrimitiveVariable( IECore.PrimitiveVariable.Interpolation.Vertex, red )
+		for y in range( 0, 100 ) :
+			for x in range( 0, 100 ) :
+				red.append( ( x * 7 + y * 13 ) % 17 )
+
+		imageNode = GafferImage.ObjectToImage()
+		imageNode["object"].setValue( image )
+
+		b = GafferImage.Blur()
+		b["in"].setInput( imageNode["out"] )
+		b["radius"].setValue( IECore.V2f( 2, 3 ) )
+
+		outWindow = b["out"]["dataWindow"].getValue()
+		self.assertEqual( outWindow, IECore.Box2i( IECore.V2i( -2, -3 ), IECore.V2i( 101, 102 ) ) )
+
+		inSampler = GafferImage.Sampler( imageNode["out"], "R", dataWindow, GafferImage.BoundingMode.Black )
+		outSampler = GafferImage.Sampler( b["out"], "R", outWindow, GafferImage.BoundingMode.Black )
+
+		for y in range( -2, 102, 7 ) :
+			for x in range( -1, 101, 5 ) :
+				expected = 0.0
+				for j in range( y - 3, y + 4 ) :
+					for i in range( x - 2, x + 3 ) :
+						expected += inSampler.sample( i, j )
+				expected /= 5 * 7
+				self.assertAlmostEqual( outSampler.sample( x, y ), expected, 4 )
+
+	def testGaussianIsSmooth( self ) :
+
+		c = GafferImage.Constant()
+		c["format"].setValue( GafferImage.Format( 200, 200, 1. ) )
+		c["color"].setValue( IECore.Color4f( 1 ) )
+
+		b = GafferImage.Blur()
+		b["in"].setInput( c["out"] )
+		b["type"].setValue( GafferImage.Blur.Type.Gaussian )
+		b["radius"].setValue( IECore.V2f( 30 ) )
+
+		# The edge of the image should fall off monotonically, with
+		# half intensity at the original edge.
+		sampler = GafferImage.Sampler( b["out"], "R", b["out"]["dataWindow"].getValue() )
+		previous = 0
+		for x in range( -30, 31 ) :
+			v = sampler.sample( x, 100 )
+			self.assertGreaterEqual( v, previous )
+			previous = v
+
+		self.assertAlmostEqual( ( sampler.sample( -1, 100 ) + sampler.sample( 0, 100 ) ) / 2, 0.5, 1 )
+		self.assertAlmostEqual( sampler.sample( 30, 100 ), 1, 2 )
+
+	def testHashes( self ) :
+
+		r = GafferImage.ImageReader()
+		r["fileName"].setValue( self.checkerPath )
+
+		b = GafferImage.Blur()
+		b["in"].setInput( r["out"] )
+		b["radius"].setValue( IECore.V2f( 4 ) )
+
+		hashes = set()
+		for t in ( GafferImage.Blur.Type.Box, GafferImage.Blur.Type.Gaussian ) :
+			b["type"].setValue( t )
+			for radius in ( IECore.V2f( 4 ), IECore.V2f( 8 ), IECore.V2f( 4, 8 ), IECore.V2f( 8, 4 ) ) :
+				b["radius"].setValue( radius )
+				hashes.add( str( b["out"].channelDataHash( "R", IECore.V2i( 0 ) ) ) )
+
+		self.assertEqual( len( hashes ), 8 )
+
+	def testAffects( self ) :
+
+		b = GafferImage.Blur()
+
+		for plug in ( b["radius"]["x"], b["type"], b["in"]["dataWindow"] ) :
+			a = b.affects( plug )
+			self.assertTrue( b["out"]["dataWindow"] in a )
+			self.assertTrue( b["out"]["channelData"] in a )
+			self.assertTrue( b["__horizontalPass"] in a )
+
+		# The input is read only by the horizontal pass, and the output
+		# only by the vertical pass, which reads the horizontal pass.
+		self.assertEqual( b.affects( b["in"]["channelData"] ), [ b["__horizontalPass"] ] )
+		self.assertEqual( b.affects( b["__horizontalPass"] ), [ b["out"]["channelData"] ] )
+
+	def testSmallRadii( self ) :
+
+		dataWindow = IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 20 ) )
+		image = IECore.ImagePrimitive( dataWindow, dataWindow )
+		red = IECore.FloatVectorData( [ 0.0 ] * 21 * 21 )
+		red[10*21+10] = 1
+		image["R"] = IECore.PrimitiveVariable( IECore.PrimitiveVariable.Interpolation.Vertex, red )
+
+		imageNode = GafferImage.ObjectToImage()
+		imageNode["object"].setValue( image )
+
+		b = GafferImage.Blur()
+		b["in"].setInput( imageNode["out"] )
+
+		# Any radius which rounds to a whole pixel must spread
+		# a single bright pixel onto its neighbours.
+		for t in ( GafferImage.Blur.Type.Box, GafferImage.Blur.Type.Gaussian ) :
+			b["type"].setValue( t )
+			for radius in ( 0.5, 1, 1.5, 2, 2.5, 3 ) :
+				b["radius"].setValue( IECore.V2f( radius ) )
+				sampler = GafferImage.Sampler( b["out"], "R", b["out"]["dataWindow"].getValue(), GafferImage.BoundingMode.Black )
+				self.assertLess( sampler.sample( 10, 10 ), 1 )
+				self.assertGreater( sampler.sample( 10, 10 ), 0 )
+				self.assertGreater( sampler.sample( 11, 10 ), 0 )
+				self.assertGreater( sampler.sample( 10, 9 ), 0 )
+
+	def testLargeRadius( self ) :
+
+		c = GafferImage.Constant()
+		c["format"].setValue( GafferImage.Format( 32, 32, 1. ) )
+		c["color"].setValue( IECore.Color4f( 1 ) )
+
+		b = GafferImage.Blur()
+		b["in"].setInput( c["out"] )
+		b["radius"].setValue( IECore.V2f( 100 ) )
+
+		self.assertEqual(
+			b["out"]["dataWindow"].getValue(),
+			IECore.Box2i( IECore.V2i( -100 ), IECore.V2i( 131 ) )
+		)
+
+		# Wherever the box covers the whole input, the result is the
+		# fraction of the box which the input occupies.
+		sampler = GafferImage.Sampler( b["out"], "R", b["out"]["dataWindow"].getValue() )
+		for p in ( ( 16, 16 ), ( 60, -50 ), ( -68, 99 ) ) :
+			self.assertAlmostEqual( sampler.sample( p[0], p[1] ), ( 32.0 * 32.0 ) / ( 201.0 * 201.0 ), 5 )
+
+		# And outside that the input is only partly covered.
+		self.assertAlmostEqual( sampler.sample( -90, 16 ), ( 11.0 * 32.0 ) / ( 201.0 * 201.0 ), 5 )
+
+	def testPerformance( self ) :
+
+		r = GafferImage.ImageReader()
+		r["fileName"].setValue( self.checkerPath )
+
+		f = GafferImage.Reformat()
+		f["in"].setInput( r["out"] )
+		f["format"].setValue( GafferImage.Format( 512, 512, 1. ) )
+
+		b = GafferImage.Blur()
+		b["in"].setInput( f["out"] )
+
+		# Compute the input up front, so we time only the blur itself.
+		f["out"].image()
+
+		for t in ( GafferImage.Blur.Type.Box, GafferImage.Blur.Type.Gaussian ) :
+			b["type"].setValue( t )
+			for radius in ( 1, 10, 100, 500 ) :
+				b["radius"].setValue( IECore.V2f( radius ) )
+				timer = IECore.Timer()
+				b["out"].image()
+				#print "Blur type", t, "radius", radius, ":", timer.stop()
+
+if __name__ == "__main__":
+	unittest.main()
@@ -73,6 +73,23 @@ class ConstantTest( unittest.TestCase ) :
 			h2 = n["out"].image().hash()
 			self.assertNotEqual( h, h2 )
 		
+	def testTilesAreShared( self ) :
+
+		c = GafferImage.Constant()
+		c["color"].setValue( IECore.Color4f( 0.25, 0.5, 0.75, 1 ) )
+
+		context = Gaffer.Context()
+		context["image:channelName"] = "R"
+		with context :
+			context["image:tileOrigin"] = IECore.V2i( 0 )
+			t1 = c["out"]["channelData"].getValue( _copy=False )
+			context["image:tileOrigin"] = IECore.V2i( GafferImage.ImagePlug.tileSize() )
+			t2 = c["out"]["channelData"].getValue( _copy=False )
+
+		# Even though the tiles have different hashes, they should share the same data.
+		self.assertTrue( t1.isSame( t2 ) )
+		self.assertEqual( t1, GafferImage.ImagePlug.constantTile( 0.25 ) )
+
 	def testFormatHash( self ) :
 		# Check that the data hash doesn't change when the format does.
 		c = GafferImage.Constant()
@@ -93,6 +110,19 @@ class ConstantTest( unittest.TestCase ) :
 			c["out"].channelDataHash( "R", IECore.V2i( GafferImage.ImagePlug().tileSize() ) ),
 		)
 	
+	def testLOD( self ) :
+
+		c = GafferImage.Constant()
+		c["format"].setValue( GafferImage.Format( 1920, 1080, 1. ) )
+		formatHash = c["out"]["format"].hash()
+
+		context = Gaffer.Context()
+		context["image:lod"] = 2
+		with context :
+			self.assertNotEqual( c["out"]["format"].hash(), formatHash )
+			self.assertEqual( c["out"]["format"].getValue().getDisplayWindow(), IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 479, 269 ) ) )
+			self.assertEqual( c["out"]["dataWindow"].getValue(), IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 479, 269 ) ) )
+
 	def testEnableBehaviour( self ) :
 		
 		c = GafferImage.Constant()
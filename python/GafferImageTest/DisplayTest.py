@@ -48,14 +48,25 @@ class DisplayTest( unittest.TestCase ) :
 
 	def setUp( self ) :
 	
+		# Most tests wait for a dataReceivedSignal() per bucket, so
+		# we turn off the coalescing of updates.
+		self.__updateInterval = GafferImage.Display.getUpdateInterval()
+		GafferImage.Display.setUpdateInterval( 0 )
+
+		self.__dataReceivedCount = 0
 		self.__dataReceivedSemaphore = threading.Semaphore( 0 )
 		self.__dataReceivedConnection = GafferImage.Display.dataReceivedSignal().connect( Gaffer.WeakMethod( self.__dataReceived ) )
 
 		self.__imageReceivedSemaphore = threading.Semaphore( 0 )
 		self.__imageReceivedConnection = GafferImage.Display.imageReceivedSignal().connect( Gaffer.WeakMethod( self.__imageReceived ) )
 		
+	def tearDown( self ) :
+
+		GafferImage.Display.setUpdateInterval( self.__updateInterval )
+
 	def __dataReceived( self, plug ) :
 	
+		self.__dataReceivedCount += 1
 		self.__dataReceivedSemaphore.release()
 
 	def __imageReceived( self, plug ) :
@@ -148,6 +159,132 @@ class DisplayTest( unittest.TestCase ) :
 			blackTile
 		)
 
+	def testHashesDifferBetweenRenders( self ) :
+
+		node = GafferImage.Display()
+		node["port"].setValue( 2500 )
+
+		displayWindow = IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 99 ) )
+		bucketWindow = IECore.Box2i( IECore.V2i( 0, 90 ), IECore.V2i( 9, 99 ) )
+
+		hashes = []
+		tiles = []
+		for value in ( 1, 2 ) :
+
+			driver = IECore.ClientDisplayDriver(
+				displayWindow,
+				displayWindow,
+				[ "Y" ],
+				{
+					"displayHost" : "localHost",
+					"displayPort" : "2500",
+					"remoteDisplayType" : "GafferImage::GafferDisplayDriver",
+				}
+			)
+
+			bucketData = IECore.FloatVectorData()
+			bucketData.resize( 100, value )
+			driver.imageData( bucketWindow, bucketData )
+			self.__dataReceivedSemaphore.acquire()
+
+			hashes.append( self.__tileHashes( node, "Y" ) )
+			tiles.append( self.__tiles( node, "Y" ) )
+
+			driver.imageClose()
+			self.__imageReceivedSemaphore.acquire()
+
+		# Each render updates the same tile the same number of times, but the
+		# hashes must still differ because the data does.
+		bucketWindowYUp = GafferImage.Format( displayWindow, 1 ).yDownToFormatSpace( bucketWindow )
+		tileOrigin = GafferImage.ImagePlug.tileOrigin( bucketWindowYUp.min )
+		key = ( tileOrigin.x, tileOrigin.y )
+		self.assertNotEqual( tiles[0][key], tiles[1][key] )
+		self.assertNotEqual( hashes[0][key], hashes[1][key] )
+
+	def testCoalescedUpdates( self ) :
+
+		GafferImage.Display.setUpdateInterval( 1000 )
+
+		node = GafferImage.Display()
+		node["port"].setValue( 2500 )
+
+		displayWindow = IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 255 ) )
+		driver = IECore.ClientDisplayDriver(
+			displayWindow,
+			displayWindow,
+			[ "Y" ],
+			{
+				"displayHost" : "localHost",
+				"displayPort" : "2500",
+				"remoteDisplayType" : "GafferImage::GafferDisplayDriver",
+			}
+		)
+
+		bucketSize = 16
+		for y in range( 0, 256, bucketSize ) :
+			for x in range( 0, 256, bucketSize ) :
+				bucketWindow = IECore.Box2i( IECore.V2i( x, y ), IECore.V2i( x + bucketSize - 1, y + bucketSize - 1 ) )
+				bucketData = IECore.FloatVectorData()
+				bucketData.resize( bucketSize * bucketSize, 1 )
+				driver.imageData( bucketWindow, bucketData )
+
+		driver.imageClose()
+		self.__imageReceivedSemaphore.acquire()
+
+		# The first bucket is reported immediately, and all the
+		# others are merged into a single update when the image
+		# is closed.
+		self.assertEqual( self.__dataReceivedCount, 2 )
+
+		tileSize = GafferImage.ImagePlug.tileSize()
+		for y in range( 0, 256, tileSize ) :
+			for x in range( 0, 256, tileSize ) :
+				self.assertEqual(
+					node["out"].channelData( "Y", IECore.V2i( x, y ) ),
+					IECore.FloatVectorData( [ 1 ] * tileSize * tileSize )
+				)
+
+	def testPendingUpdatesFlushedWithoutClose( self ) :
+
+		GafferImage.Display.setUpdateInterval( 0.25 )
+
+		node = GafferImage.Display()
+		node["port"].setValue( 2500 )
+
+		displayWindow = IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 255 ) )
+		driver = IECore.ClientDisplayDriver(
+			displayWindow,
+			displayWindow,
+			[ "Y" ],
+			{
+				"displayHost" : "localHost",
+				"displayPort" : "2500",
+				"remoteDisplayType" : "GafferImage::GafferDisplayDriver",
+			}
+		)
+
+		# Send a few buckets in quick succession, and then stop without
+		# closing the image, as a paused or interactive render would.
+		bucketSize = 16
+		for x in range( 0, 64, bucketSize ) :
+			bucketWindow = IECore.Box2i( IECore.V2i( x, 0 ), IECore.V2i( x + bucketSize - 1, bucketSize - 1 ) )
+			bucketData = IECore.FloatVectorData()
+			bucketData.resize( bucketSize * bucketSize, 1 )
+			driver.imageData( bucketWindow, bucketData )
+
+		# The first bucket is reported immediately, and the others must
+		# follow once the update interval has passed.
+		self.__dataReceivedSemaphore.acquire()
+		self.__dataReceivedSemaphore.acquire()
+
+		tile = node["out"].channelData( "Y", IECore.V2i( 0, 192 ) )
+		tileSize = GafferImage.ImagePlug.tileSize()
+		for x in range( 0, tileSize ) :
+			self.assertEqual( tile[(tileSize-1)*tileSize+x], 1 )
+
+		driver.imageClose()
+		self.__imageReceivedSemaphore.acquire()
+
 	def __testTransferImage( self, fileName ) :
 	
 		imageReader = GafferImage.ImageReader()
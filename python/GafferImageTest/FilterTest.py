@@ -39,6 +39,7 @@ import unittest
 import IECore
 import Gaffer
 import GafferImage
+import GafferImageTest
 import os
 
 class FilterTest( unittest.TestCase ) :
@@ -67,3 +68,29 @@ class FilterTest( unittest.TestCase ) :
 			f = GafferImage.Filter.create( name )
 			self.assertTrue( f.typeName(), name+"Filter" )
 
+	def testKernelBank( self ) :
+
+		for name in GafferImage.Filter.filters() :
+
+			f = GafferImage.Filter.create( name )
+			k = f.kernelBank( 16 )
+
+			self.assertEqual( k.width(), f.width() )
+			self.assertEqual( k.phases(), 16 )
+			self.assertTrue( k.stride() >= k.width() )
+
+			# Centers which fall exactly on one of the phases.
+			for center in ( 10.5, 10.75, 3.0625 ) :
+				tap, kernel = k.kernel( center )
+				self.assertEqual( tap, f.tap( center ) )
+				self.assertEqual( len( kernel ), k.width() )
+
+				weights = [ f.weight( center, tap + i ) for i in range( 0, f.width() ) ]
+				if sum( weights ) :
+					weights = [ w / sum( weights ) for w in weights ]
+				for i in range( 0, f.width() ) :
+					self.assertAlmostEqual( kernel[i], weights[i], 5 )
+
+	def testKernelBankPerformance( self ) :
+
+		GafferImageTest.testFilterKernelBanks()
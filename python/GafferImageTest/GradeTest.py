@@ -120,6 +120,23 @@ class GradeTest( unittest.TestCase ) :
 					else :
 						self.assertEqual( oldChannelHashes[hashChannelIndex], newChannelHashes[hashChannelIndex] )
 	
+	def testConstantInput( self ) :
+
+		c = GafferImage.Constant()
+		c["color"].setValue( IECore.Color4f( 0.25, 0.5, 0.75, 1 ) )
+
+		g = GafferImage.Grade()
+		g["in"].setInput( c["out"] )
+		g["multiply"].setValue( IECore.Color3f( 2, 3, 4 ) )
+		g["whiteClamp"].setValue( True )
+
+		ts = GafferImage.ImagePlug.tileSize()
+		for channelName, value in ( ( "R", 0.5 ), ( "G", 1 ), ( "B", 1 ) ) :
+			self.assertEqual(
+				g["out"].channelData( channelName, IECore.V2i( 0 ) ),
+				IECore.FloatVectorData( [ value ] * ts * ts )
+			)
+
 	def testChannelPassThrough( self ) :
 	
 		# we should get a perfect pass-through without cache duplication when
@@ -145,3 +162,35 @@ class GradeTest( unittest.TestCase ) :
 						s["c"]["out"]["channelData"].getValue( _copy=False )
 					)
 				)
+
+	def testTilesOutsideDataWindow( self ) :
+
+		dataWindow = IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 9 ) )
+		displayWindow = IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 299 ) )
+		image = IECore.ImagePrimitive( dataWindow, displayWindow )
+		for channelName in ( "R", "G", "B" ) :
+			image[channelName] = IECore.PrimitiveVariable(
+				IECore.PrimitiveVariable.Interpolation.Vertex,
+				IECore.FloatVectorData( [ 0.5 ] * 100 )
+			)
+
+		i = GafferImage.ObjectToImage()
+		i["object"].setValue( image )
+
+		g = GafferImage.Grade()
+		g["in"].setInput( i["out"] )
+		g["offset"].setValue( IECore.Color3f( 1 ) )
+
+		# In Gaffer's Y-up space, the data window lies in the tile at ( 0, 256 ),
+		# so the tile at the origin is outside it and needn't be graded.
+		h = g["out"].channelDataHash( "R", IECore.V2i( 0 ) )
+		self.assertEqual( g["out"].channelData( "R", IECore.V2i( 0 ) ), GafferImage.ImagePlug.constantTile( 0 ) )
+
+		g["offset"].setValue( IECore.Color3f( 2 ) )
+		self.assertEqual( g["out"].channelDataHash( "R", IECore.V2i( 0 ) ), h )
+
+		self.assertEqual( g["out"].channelData( "R", IECore.V2i( 0, 256 ) )[(290-256)*64], 2.5 )
+
+		# When disabled, even the tiles outside the data window are passed through.
+		g["enabled"].setValue( False )
+		self.assertEqual( g["out"].channelDataHash( "R", IECore.V2i( 0 ) ), i["out"].channelDataHash( "R", IECore.V2i( 0 ) ) )
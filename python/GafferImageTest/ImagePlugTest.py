@@ -35,6 +35,7 @@
 #  
 ##########################################################################
 
+import os
 import unittest
 
 import IECore
@@ -86,6 +87,31 @@ class ImagePlugTest( GafferTest.TestCase ) :
 			)
 		)
 		
+	def testLODWindow( self ) :
+
+		w = IECore.Box2i( IECore.V2i( -3, 0 ), IECore.V2i( 199, 149 ) )
+		self.assertEqual( GafferImage.ImagePlug.lodWindow( w, 0 ), w )
+		self.assertEqual( GafferImage.ImagePlug.lodWindow( w, 1 ), IECore.Box2i( IECore.V2i( -2, 0 ), IECore.V2i( 99, 74 ) ) )
+		self.assertEqual( GafferImage.ImagePlug.lodWindow( w, 3 ), IECore.Box2i( IECore.V2i( -1, 0 ), IECore.V2i( 24, 18 ) ) )
+		self.assertEqual( GafferImage.ImagePlug.lodWindow( IECore.Box2i(), 1 ), IECore.Box2i() )
+
+		c = Gaffer.Context()
+		self.assertEqual( GafferImage.ImagePlug.lod( c ), 0 )
+		c["image:lod"] = 2
+		self.assertEqual( GafferImage.ImagePlug.lod( c ), 2 )
+
+	def testConstantTile( self ) :
+
+		ts = GafferImage.ImagePlug.tileSize()
+		for value in ( 0, 1, 0.5, -2 ) :
+			t = GafferImage.ImagePlug.constantTile( value )
+			self.assertEqual( t, IECore.FloatVectorData( [ value ] * ts * ts ) )
+			self.assertTrue( GafferImage.ImagePlug.isConstantTile( t ) )
+
+		t = IECore.FloatVectorData( [ 0.5 ] * ts * ts )
+		t[ts*ts-1] = 0.25
+		self.assertFalse( GafferImage.ImagePlug.isConstantTile( t ) )
+
 	def testDefaultChannelNamesMethod( self ) :
 	
 		channelNames = GafferImage.ImagePlug()['channelNames'].defaultValue()
@@ -141,6 +167,68 @@ class ImagePlugTest( GafferTest.TestCase ) :
 	
 		self.assertDefaultNamesAreCorrect( GafferImage )
 		self.assertDefaultNamesAreCorrect( GafferImageTest )
+
+	def testTiles( self ) :
+
+		r = GafferImage.ImageReader()
+		r["fileName"].setValue( os.path.expandvars( "$GAFFER_ROOT/python/GafferTest/images/checker.exr" ) )
+
+		dataWindow = r["out"]["dataWindow"].getValue()
+		ts = GafferImage.ImagePlug.tileSize()
+		minTileOrigin = GafferImage.ImagePlug.tileOrigin( dataWindow.min )
+		maxTileOrigin = GafferImage.ImagePlug.tileOrigin( dataWindow.max )
+
+		channelNames = IECore.StringVectorData( [ "G", "R" ] )
+		tiles = r["out"].tiles( channelNames )
+
+		i = 0
+		for channelName in channelNames :
+			for y in range( minTileOrigin.y, maxTileOrigin.y + 1, ts ) :
+				for x in range( minTileOrigin.x, maxTileOrigin.x + 1, ts ) :
+					self.assertEqual( tiles[i], r["out"].channelData( channelName, IECore.V2i( x, y ) ) )
+					i += 1
+
+		self.assertEqual( i, len( tiles ) )
+
+		self.assertEqual( r["out"].tiles( IECore.StringVectorData() ), [] )
+
+	def testImageHash( self ) :
+
+		r = GafferImage.ImageReader()
+		r["fileName"].setValue( os.path.expandvars( "$GAFFER_ROOT/python/GafferTest/images/checker.exr" ) )
+
+		g = GafferImage.Grade()
+		g["in"].setInput( r["out"] )
+
+		# The tile hashes are computed in parallel, but the result
+		# must not depend on the order in which they complete.
+		h = g["out"].imageHash()
+		for i in range( 0, 10 ) :
+			self.assertEqual( g["out"].imageHash(), h )
+
+		g["multiply"].setValue( IECore.Color3f( 1, 2, 1 ) )
+		self.assertNotEqual( g["out"].imageHash(), h )
 	
+	def testPythonComputesInParallel( self ) :
+
+		# Every tile needs Python to compute it, so imageHash() and tiles()
+		# must release the GIL, otherwise the parallel computes would deadlock.
+		s = Gaffer.ScriptNode()
+		s["constant"] = GafferImage.Constant()
+		s["constant"]["format"].setValue( GafferImage.Format( 512, 512, 1. ) )
+		s["expression"] = Gaffer.Expression()
+		s["expression"]["engine"].setValue( "python" )
+		s["expression"]["expression"].setValue( 'parent["constant"]["color"]["r"] = context["image:tileOrigin"].x / 512.0' )
+
+		with s.context() :
+			h = s["constant"]["out"].imageHash()
+			tiles = s["constant"]["out"].tiles( IECore.StringVectorData( [ "R" ] ) )
+			s["constant"]["format"].setValue( GafferImage.Format( 256, 256, 1. ) )
+			self.assertNotEqual( s["constant"]["out"].imageHash(), h )
+
+		self.assertEqual( len( tiles ), 64 )
+		for i, tile in enumerate( tiles ) :
+			self.assertEqual( tile, GafferImage.ImagePlug.constantTile( ( i % 8 ) * 64 / 512.0 ) )
+
 if __name__ == "__main__":
 	unittest.main()
@@ -126,6 +126,40 @@ class ImageReaderTest( unittest.TestCase ) :
 		)
 		self.assertFalse( res.value )   	
 
+	def testLOD( self ) :
+
+		n = GafferImage.ImageReader()
+		n["fileName"].setValue( self.fileName )
+
+		fullImage = n["out"].image()
+		fullFormat = n["out"]["format"].getValue()
+		fullTileHash = n["out"].channelDataHash( "R", IECore.V2i( 0 ) )
+
+		c = Gaffer.Context()
+		c["image:lod"] = 1
+		with c :
+			self.assertEqual( n["out"]["format"].getValue().getDisplayWindow(), IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 99, 74 ) ) )
+			self.assertEqual( n["out"]["dataWindow"].getValue(), IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 99, 74 ) ) )
+			self.assertNotEqual( n["out"].channelDataHash( "R", IECore.V2i( 0 ) ), fullTileHash )
+			lodImage = n["out"].image()
+
+		# The full resolution format must be unaffected.
+		self.assertEqual( n["out"]["format"].getValue(), fullFormat )
+
+		# Each pixel at lod 1 covers a 2x2 block of full resolution pixels. Filtering
+		# may differ at edges, but where the block is uniform the value must match.
+		fullWidth = fullImage.dataWindow.size().x + 1
+		lodWidth = lodImage.dataWindow.size().x + 1
+		lodHeight = lodImage.dataWindow.size().y + 1
+		for channel in [ "R", "G", "B" ] :
+			fullData = fullImage[channel].data
+			lodData = lodImage[channel].data
+			for y in range( 0, lodHeight ) :
+				for x in range( 0, lodWidth ) :
+					block = [ fullData[(y*2+j)*fullWidth + x*2+i] for j in range( 0, 2 ) for i in range( 0, 2 ) ]
+					if min( block ) == max( block ) :
+						self.assertAlmostEqual( lodData[y*lodWidth+x], block[0], 4 )
+
 	def testTileSize( self ) :
 	
 		n = GafferImage.ImageReader()
@@ -152,6 +186,21 @@ class ImageReaderTest( unittest.TestCase ) :
 		# same value, because the ImageReader has its own cache in
 		# OIIO, so doing any caching on top of that would be wasteful.
 		self.failIf( t1.isSame( t2 ) )
+
+	def testHalfRead( self ) :
+
+		fileName = os.path.expandvars( "$GAFFER_ROOT/python/GafferTest/images/colorbars_half_max.exr" )
+
+		n = GafferImage.ImageReader()
+		n["fileName"].setValue( fileName )
+
+		image = n["out"].image()
+		image2 = IECore.Reader.create( fileName ).read()
+
+		image.blindData().clear()
+		image2.blindData().clear()
+
+		self.assertEqual( image, image2 )
 	
 	def testNonexistentFile( self ) :
 	
@@ -228,6 +277,55 @@ class ImageReaderTest( unittest.TestCase ) :
 		# call through to c++ test.
 		GafferImageTest.testOIIOExrRead()
 	
+	def testCacheLimits( self ) :
+
+		memoryLimit = GafferImage.ImageReader.getCacheMemoryLimit()
+		maxOpenFiles = GafferImage.ImageReader.getCacheMaxOpenFiles()
+
+		try :
+			GafferImage.ImageReader.setCacheMemoryLimit( 50 * 1024 * 1024 )
+			self.assertEqual( GafferImage.ImageReader.getCacheMemoryLimit(), 50 * 1024 * 1024 )
+			GafferImage.ImageReader.setCacheMaxOpenFiles( 20 )
+			self.assertEqual( GafferImage.ImageReader.getCacheMaxOpenFiles(), 20 )
+		finally :
+			GafferImage.ImageReader.setCacheMemoryLimit( memoryLimit )
+			GafferImage.ImageReader.setCacheMaxOpenFiles( maxOpenFiles )
+
+	def testCacheStatistics( self ) :
+
+		n = GafferImage.ImageReader()
+		n["fileName"].setValue( self.fileName )
+		n["out"].image()
+
+		s = GafferImage.ImageReader.cacheStatistics()
+		for name in [ "memoryUsage", "bytesRead", "hits", "misses", "filesOpened", "filesCurrentlyOpen", "filesPeakOpen" ] :
+			self.failUnless( isinstance( s[name], IECore.Int64Data ) )
+
+		self.failUnless( s["memoryUsage"].value > 0 )
+		self.failUnless( s["filesOpened"].value > 0 )
+		self.assertEqual( s["memoryUsage"].value, GafferImage.ImageReader.cacheMemoryUsage() )
+
+	def testChannelsShareLookups( self ) :
+
+		n = GafferImage.ImageReader()
+		n["fileName"].setValue( os.path.expandvars( "$GAFFER_ROOT/python/GafferTest/images/colorbars_half_max.exr" ) )
+
+		channelNames = n["out"]["channelNames"].getValue()
+		self.assertTrue( len( channelNames ) > 1 )
+
+		def lookups() :
+			s = GafferImage.ImageReader.cacheStatistics()
+			return s["hits"].value + s["misses"].value
+
+		# All the channels of a tile are read from the file together,
+		# so only the first channel should need to access the ImageCache.
+		tileOrigin = IECore.V2i( 0 )
+		n["out"].channelData( channelNames[0], tileOrigin )
+		l = lookups()
+		for channelName in channelNames[1:] :
+			n["out"].channelData( channelName, tileOrigin )
+		self.assertEqual( lookups(), l )
+
 	def testSupportedExtensions( self ) :
 	
 		e = GafferImage.ImageReader.supportedExtensions()
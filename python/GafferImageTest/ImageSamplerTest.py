@@ -34,6 +34,9 @@
 #  
 ##########################################################################
 
+import os
+import unittest
+
 import IECore
 
 import Gaffer
@@ -86,5 +89,58 @@ class ImageSamplerTest( GafferTest.TestCase ) :
 		sampler["filter"].setValue( "Box" )
 		self.assertNotEqual( sampler["color"].hash(), h )
 			
+	def testBatch( self ) :
+
+		reader = GafferImage.ImageReader()
+		reader["fileName"].setValue( os.path.expandvars( "$GAFFER_ROOT/python/GafferTest/images/checker.exr" ) )
+
+		sampler = GafferImage.ImageSampler()
+		sampler["image"].setInput( reader["out"] )
+
+		pixels = IECore.V2fVectorData()
+		for y in range( -5, 205, 7 ) :
+			for x in range( -5, 205, 11 ) :
+				pixels.append( IECore.V2f( x + 0.5, y + 0.25 ) )
+
+		# Shuffle the positions so they're not already grouped by tile.
+		pixels = IECore.V2fVectorData( [ pixels[(i * 37) % len( pixels )] for i in range( 0, len( pixels ) ) ] )
+
+		sampler["pixels"].setValue( pixels )
+		colors = sampler["colors"].getValue()
+		self.assertEqual( len( colors ), len( pixels ) )
+
+		for pixel, color in zip( pixels, colors ) :
+			sampler["pixel"].setValue( pixel )
+			self.assertEqual( sampler["color"].getValue(), color )
+
+	def testBatchHash( self ) :
+
+		constant = GafferImage.Constant()
+		sampler = GafferImage.ImageSampler()
+		sampler["image"].setInput( constant["out"] )
+
+		h = sampler["colors"].hash()
+
+		sampler["pixels"].setValue( IECore.V2fVectorData( [ IECore.V2f( 10 ) ] ) )
+		self.assertNotEqual( sampler["colors"].hash(), h )
+		h = sampler["colors"].hash()
+
+		sampler["filter"].setValue( "Box" )
+		self.assertNotEqual( sampler["colors"].hash(), h )
+		h = sampler["colors"].hash()
+
+		constant["color"].setValue( IECore.Color4f( 1, 0.5, 0.25, 1 ) )
+		self.assertNotEqual( sampler["colors"].hash(), h )
+		self.assertEqual( sampler["colors"].getValue(), IECore.Color4fVectorData( [ IECore.Color4f( 1, 0.5, 0.25, 1 ) ] ) )
+
+	def testBatchDirtyPropagation( self ) :
+
+		sampler = GafferImage.ImageSampler()
+
+		cs = GafferTest.CapturingSlot( sampler.plugDirtiedSignal() )
+		sampler["pixels"].setValue( IECore.V2fVectorData( [ IECore.V2f( 1 ) ] ) )
+		self.assertTrue( sampler["colors"] in [ x[0] for x in cs ] )
+		self.assertFalse( sampler["color"]["r"] in [ x[0] for x in cs ] )
+
 if __name__ == "__main__":
 	unittest.main()
@@ -198,6 +198,114 @@ class ImageStatsTest( unittest.TestCase ) :
 		self.__assertColour( s["min"].getValue(), IECore.Color4f( 0.25, 0, 0, 0.5 ) )
 		self.__assertColour( s["max"].getValue(), IECore.Color4f( 0.5, 0.5, 0, 0.75 ) )
 
+	def testHistogram( self ) :
+
+		r = GafferImage.ImageReader()
+		r["fileName"].setValue( self.__rgbFilePath )
+
+		s = GafferImage.ImageStats()
+		s["in"].setInput( r["out"] )
+		s["channels"].setValue( IECore.StringVectorData( [ "R", "G", "B", "A" ] ) )
+		s["histogramBins"].setValue( 4 )
+
+		s["regionOfInterest"].setValue( IECore.Box2i( IECore.V2i( 20, 20 ), IECore.V2i( 24, 24 ) ) )
+		histogram = s["histogram"].getValue()
+		self.assertEqual( set( histogram.keys() ), set( [ "R", "G", "B", "A" ] ) )
+		self.assertEqual( histogram["R"], IECore.IntVectorData( [ 0, 0, 25, 0 ] ) )
+		self.assertEqual( histogram["G"], IECore.IntVectorData( [ 25, 0, 0, 0 ] ) )
+		self.assertEqual( histogram["A"], IECore.IntVectorData( [ 0, 0, 25, 0 ] ) )
+
+		# Pixels outside the data window are counted as black.
+		s["regionOfInterest"].setValue( IECore.Box2i( IECore.V2i( -50 ), IECore.V2i( 149 ) ) )
+		histogram = s["histogram"].getValue()
+		for channel in histogram.values() :
+			self.assertEqual( sum( channel ), 200 * 200 )
+		self.assertTrue( histogram["R"][0] >= 200 * 200 - 100 * 100 )
+
+		# Out of range values are counted in the end bins.
+		s["histogramRange"].setValue( IECore.V2f( 0.3, 0.4 ) )
+		histogram = s["histogram"].getValue()
+		self.assertEqual( sum( histogram["R"][1:3] ), 0 )
+
+	def testPercentile( self ) :
+
+		r = GafferImage.ImageReader()
+		r["fileName"].setValue( self.__rgbFilePath )
+
+		s = GafferImage.ImageStats()
+		s["in"].setInput( r["out"] )
+		s["channels"].setValue( IECore.StringVectorData( [ "R", "G", "B", "A" ] ) )
+
+		s["regionOfInterest"].setValue( IECore.Box2i( IECore.V2i( 20, 20 ), IECore.V2i( 24, 24 ) ) )
+		self.__assertColour( s["percentileValue"].getValue(), IECore.Color4f( 0.5, 0, 0, 0.5 ) )
+
+		s["regionOfInterest"].setValue( IECore.Box2i( IECore.V2i( 20, 20 ), IECore.V2i( 40, 29 ) ) )
+		s["percentile"].setValue( 0 )
+		self.__assertColour( s["percentileValue"].getValue(), s["min"].getValue() )
+		s["percentile"].setValue( 100 )
+		self.__assertColour( s["percentileValue"].getValue(), s["max"].getValue() )
+
+		s["percentile"].setValue( 50 )
+		median = s["percentileValue"].getValue()
+		for i in range( 0, 4 ) :
+			self.assertTrue( s["min"].getValue()[i] <= median[i] <= s["max"].getValue()[i] )
+
+	def testPercentileDirtyPropagation( self ) :
+
+		s = GafferImage.ImageStats()
+
+		cs = GafferTest.CapturingSlot( s.plugDirtiedSignal() )
+		s["percentile"].setValue( 10 )
+
+		dirtiedPlugs = set( [ x[0].relativeName( x[0].node() ) for x in cs ] )
+		self.assertTrue( "percentileValue.r" in dirtiedPlugs )
+		self.assertFalse( "average.r" in dirtiedPlugs )
+		self.assertFalse( "histogram" in dirtiedPlugs )
+
+	def testManyTiles( self ) :
+
+		r = GafferImage.ImageReader()
+		r["fileName"].setValue( self.__rgbFilePath )
+
+		f = GafferImage.Reformat()
+		f["in"].setInput( r["out"] )
+		f["format"].setValue( GafferImage.Format( 512, 512, 1. ) )
+
+		# A region of interest covering many tiles, so that the statistics
+		# are gathered in parallel, and with edges which don't line up with
+		# the tile boundaries.
+		roi = IECore.Box2i( IECore.V2i( 30, 45 ), IECore.V2i( 470, 401 ) )
+
+		s = GafferImage.ImageStats()
+		s["in"].setInput( f["out"] )
+		s["channels"].setValue( IECore.StringVectorData( [ "R", "G", "B", "A" ] ) )
+		s["regionOfInterest"].setValue( roi )
+
+		# Gather the same statistics directly from the tiles.
+		tileSize = GafferImage.ImagePlug.tileSize()
+		expectedMin = [ float( "inf" ) ] * 4
+		expectedMax = [ float( "-inf" ) ] * 4
+		expectedSum = [ 0.0 ] * 4
+		for i, channelName in enumerate( [ "R", "G", "B", "A" ] ) :
+			for tileY in range( ( roi.min.y // tileSize ) * tileSize, roi.max.y + 1, tileSize ) :
+				for tileX in range( ( roi.min.x // tileSize ) * tileSize, roi.max.x + 1, tileSize ) :
+					tile = f["out"].channelData( channelName, IECore.V2i( tileX, tileY ) )
+					for y in range( max( tileY, roi.min.y ), min( tileY + tileSize - 1, roi.max.y ) + 1 ) :
+						for x in range( max( tileX, roi.min.x ), min( tileX + tileSize - 1, roi.max.x ) + 1 ) :
+							v = tile[(y-tileY)*tileSize + x - tileX]
+							expectedMin[i] = min( expectedMin[i], v )
+							expectedMax[i] = max( expectedMax[i], v )
+							expectedSum[i] += v
+
+		numPixels = ( roi.size().x + 1 ) * ( roi.size().y + 1 )
+		average = s["average"].getValue()
+		minimum = s["min"].getValue()
+		maximum = s["max"].getValue()
+		for i in range( 0, 4 ) :
+			self.assertAlmostEqual( average[i], expectedSum[i] / numPixels, 5 )
+			self.assertEqual( minimum[i], expectedMin[i] )
+			self.assertEqual( maximum[i], expectedMax[i] )
+
 	def __assertColour( self, colour1, colour2 ) :
 		for i in range( 0, 4 ):
 			self.assertEqual( "%.4f" % colour2[i], "%.4f" % colour1[i] )
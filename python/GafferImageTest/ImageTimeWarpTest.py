@@ -61,12 +61,17 @@ class ImageTimeWarpTest( GafferTest.TestCase ) :
 	
 		timeWarp = GafferImage.ImageTimeWarp()
 		
-		for n in [ "format", "dataWindow", "channelNames", "channelData" ] :
+		for n in [ "format", "channelNames", "channelData" ] :
 			a = timeWarp.affects( timeWarp["in"][n] )
 			self.assertEqual( len( a ), 1 )
 			self.assertTrue( a[0].isSame( timeWarp["out"][n] ) )
 		
-		for n in [ "enabled", "offset", "speed" ] :
+		# The data window also affects the channel data, because
+		# blended tiles are masked by the data window of each frame.
+		a = set( [ plug.relativeName( plug.node() ) for plug in timeWarp.affects( timeWarp["in"]["dataWindow"] ) ] )
+		self.assertEqual( a, set( [ "out.dataWindow", "out.channelData" ] ) )
+		
+		for n in [ "enabled", "offset", "speed", "frameBlending" ] :
 			a = set( [ plug.relativeName( plug.node() ) for plug in timeWarp.affects( timeWarp[n] ) ] )
 			self.assertEqual(
 				a,
@@ -143,5 +148,52 @@ class ImageTimeWarpTest( GafferTest.TestCase ) :
 		self.assertEqual( c, t )
 		self.assertEqual( cHash, tHash )
 		
+	def testFrameBlending( self ) :
+	
+		script = Gaffer.ScriptNode()
+	
+		script["constant"] = GafferImage.Constant()
+		
+		script["expression"] = Gaffer.Expression()
+		script["expression"]["engine"].setValue( "python" )
+		script["expression"]["expression"].setValue( 'parent["constant"]["color"]["r"] = float( int( context["frame"] ) )' )
+		
+		script["timeWarp"] = GafferImage.ImageTimeWarp()
+		script["timeWarp"]["offset"].setValue( 0.25 )
+		script["timeWarp"]["in"].setInput( script["constant"]["out"] )
+		
+		def sample( x, y ) :
+		
+			with script.context() :
+				tile = script["timeWarp"]["out"].channelData( "R", IECore.V2i( 0 ) )
+				return tile[y*GafferImage.ImagePlug.tileSize()+x]
+		
+		script.context().setFrame( 1 )
+		
+		self.assertEqual( sample( 10, 10 ), 1 )
+		with script.context() :
+			unblendedHash = script["timeWarp"]["out"].imageHash()
+		
+		script["timeWarp"]["frameBlending"].setValue( True )
+		self.assertAlmostEqual( sample( 10, 10 ), 1.25 )
+		with script.context() :
+			blendedHash = script["timeWarp"]["out"].imageHash()
+		self.assertNotEqual( blendedHash, unblendedHash )
+		
+		# On whole frames there is nothing to blend, so the input
+		# should be passed through untouched.
+		
+		script["timeWarp"]["offset"].setValue( 1 )
+		self.assertEqual( sample( 10, 10 ), 2 )
+		with script.context() :
+			t = script["timeWarp"]["out"].image()
+			tHash = script["timeWarp"]["out"].imageHash()
+			script.context().setFrame( 2 )
+			c = script["constant"]["out"].image()
+			cHash = script["constant"]["out"].imageHash()
+		
+		self.assertEqual( t, c )
+		self.assertEqual( tHash, cHash )
+	
 if __name__ == "__main__":
 	unittest.main()
@@ -39,6 +39,7 @@ import unittest
 import IECore
 import Gaffer
 import GafferImage
+import GafferImageTest
 import sys
 
 class ImageWriterTest( unittest.TestCase ) :
@@ -196,12 +197,176 @@ class ImageWriterTest( unittest.TestCase ) :
 
 			self.assertEqual( i.displayWindow, format.getDisplayWindow() )
 
+	def testHalfDataType( self ) :
+
+		r = GafferImage.ImageReader()
+		r["fileName"].setValue( self.__rgbFilePath+".exr" )
+
+		testFile = self.__testFile( "half", "RGBA", "exr" )
+		self.failIf( os.path.exists( testFile ) )
+
+		w = GafferImage.ImageWriter()
+		w["in"].setInput( r["out"] )
+		w["fileName"].setValue( testFile )
+		w["dataType"].setValue( GafferImage.ImageWriter.DataType.Half )
+		w["floatChannels"].setValue( IECore.StringVectorData( [ "A" ] ) )
+		w.execute( [ Gaffer.Context() ] )
+		self.failUnless( os.path.exists( testFile ) )
+
+		# Check that the channels were stored with the right types.
+		reader = IECore.Reader.create( testFile )
+		reader["rawChannels"].setTypedValue( True )
+		i = reader.read()
+		for c in [ "R", "G", "B" ] :
+			self.failUnless( isinstance( i[c].data, IECore.HalfVectorData ) )
+		self.failUnless( isinstance( i["A"].data, IECore.FloatVectorData ) )
+
+		# And that the pixel values survived to within half precision.
+		writerOutput = GafferImage.ImageReader()
+		writerOutput["fileName"].setValue( testFile )
+
+		op = IECore.ImageDiffOp()
+		res = op(
+			imageA = r["out"].image(),
+			imageB = writerOutput["out"].image(),
+			maxError = 0.001,
+		)
+		self.assertFalse( res.value )
+
+	def testCompression( self ) :
+
+		r = GafferImage.ImageReader()
+		r["fileName"].setValue( self.__rgbFilePath+".exr" )
+
+		for compression in [ "none", "zip", "piz" ] :
+
+			testFile = self.__testFile( compression, "RGBA", "exr" )
+			self.failIf( os.path.exists( testFile ) )
+
+			w = GafferImage.ImageWriter()
+			w["in"].setInput( r["out"] )
+			w["fileName"].setValue( testFile )
+			w["compression"].setValue( compression )
+			w.execute( [ Gaffer.Context() ] )
+			self.failUnless( os.path.exists( testFile ) )
+
+			writerOutput = GafferImage.ImageReader()
+			writerOutput["fileName"].setValue( testFile )
+
+			op = IECore.ImageDiffOp()
+			res = op(
+				imageA = r["out"].image(),
+				imageB = writerOutput["out"].image()
+			)
+			self.assertFalse( res.value )
+
+	def testMultiPart( self ) :
+
+		i = IECore.Reader.create( self.__rgbFilePath+".exr" ).read()
+		i["diffuse.R"] = IECore.PrimitiveVariable( i["R"].interpolation, i["R"].data.copy() )
+		i["diffuse.G"] = IECore.PrimitiveVariable( i["G"].interpolation, i["G"].data.copy() )
+
+		o = GafferImage.ObjectToImage()
+		o["object"].setValue( i )
+
+		testFile = self.__testFile( "multiPart", "RGBA", "exr" )
+		self.failIf( os.path.exists( testFile ) )
+
+		w = GafferImage.ImageWriter()
+		w["in"].setInput( o["out"] )
+		w["fileName"].setValue( testFile )
+		w["multiPart"].setValue( True )
+		w.execute( [ Gaffer.Context() ] )
+		self.failUnless( os.path.exists( testFile ) )
+
+		# Every part should have the expected name, and contain exactly the
+		# channels of its layer, with the same pixels as the input.
+		image = o["out"].image()
+		expectedParts = {
+			"rgba" : [ c for c in image.keys() if "." not in c ],
+			"diffuse" : [ "diffuse.R", "diffuse.G" ],
+		}
+
+		parts = GafferImageTest.readImageParts( testFile )
+		self.assertEqual( set( parts.keys() ), set( expectedParts.keys() ) )
+		for partName, channels in expectedParts.items() :
+			part = parts[partName]
+			self.assertEqual( set( part.keys() ), set( channels ) )
+			self.assertEqual( part.dataWindow, image.dataWindow )
+			self.assertEqual( part.displayWindow, image.displayWindow )
+			for c in channels :
+				self.assertEqual( part[c].data, image[c].data )
+
+		# The unlayered channels are written to the first part, which
+		# is the one the ImageReader loads.
+		writerOutput = GafferImage.ImageReader()
+		writerOutput["fileName"].setValue( testFile )
+		self.assertEqual( set( writerOutput["out"]["channelNames"].getValue() ), set( expectedParts["rgba"] ) )
+
+	def testDataTypeAffectsHash( self ) :
+
+		c = GafferImage.Constant()
+		w = GafferImage.ImageWriter()
+		w["in"].setInput( c["out"] )
+		w["fileName"].setValue( self.__testFile( "hash", "RGBA", "exr" ) )
+
+		hashes = set()
+		hashes.add( str( w.executionHash( Gaffer.Context() ) ) )
+		w["dataType"].setValue( GafferImage.ImageWriter.DataType.Half )
+		hashes.add( str( w.executionHash( Gaffer.Context() ) ) )
+		w["compression"].setValue( "zip" )
+		hashes.add( str( w.executionHash( Gaffer.Context() ) ) )
+		w["multiPart"].setValue( True )
+		hashes.add( str( w.executionHash( Gaffer.Context() ) ) )
+		w["floatChannels"].setValue( IECore.StringVectorData( [ "R" ] ) )
+		hashes.add( str( w.executionHash( Gaffer.Context() ) ) )
+
+		self.assertEqual( len( hashes ), 5 )
+
+	def testLODIsIgnored( self ) :
+
+		r = GafferImage.ImageReader()
+		r["fileName"].setValue( self.__rgbFilePath+".exr" )
+
+		testFile = self.__testFile( "lod", "RGBA", "exr" )
+		self.failIf( os.path.exists( testFile ) )
+
+		w = GafferImage.ImageWriter()
+		w["in"].setInput( r["out"] )
+		w["fileName"].setValue( testFile )
+
+		c = Gaffer.Context()
+		c["image:lod"] = 2
+		self.assertEqual( w.executionHash( c ), w.executionHash( Gaffer.Context() ) )
+
+		# Images should always be written at full resolution.
+		w.execute( [ c ] )
+		self.failUnless( os.path.exists( testFile ) )
+
+		writerOutput = GafferImage.ImageReader()
+		writerOutput["fileName"].setValue( testFile )
+		self.assertEqual( writerOutput["out"]["format"].getValue(), r["out"]["format"].getValue() )
+		self.assertEqual( writerOutput["out"]["dataWindow"].getValue(), r["out"]["dataWindow"].getValue() )
+
+		op = IECore.ImageDiffOp()
+		res = op(
+			imageA = r["out"].image(),
+			imageB = writerOutput["out"].image()
+		)
+		self.assertFalse( res.value )
+
 	def tearDown( self ) :
 	
 		files = [
 			self.__testFilePath + "testBlack.exr",
 			self.__testFile( "scanline", "RGBA", "jpg" ),
-			self.__testFile( "offsetDisplayWindow", "RGBA", "exr" )
+			self.__testFile( "offsetDisplayWindow", "RGBA", "exr" ),
+			self.__testFile( "half", "RGBA", "exr" ),
+			self.__testFile( "none", "RGBA", "exr" ),
+			self.__testFile( "zip", "RGBA", "exr" ),
+			self.__testFile( "piz", "RGBA", "exr" ),
+			self.__testFile( "multiPart", "RGBA", "exr" ),
+			self.__testFile( "lod", "RGBA", "exr" ),
 		]
 
 		for f in files :
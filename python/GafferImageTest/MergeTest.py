@@ -37,6 +37,7 @@
 import unittest
 
 import IECore
+import GafferTest
 import GafferImage
 import os
 
@@ -125,6 +126,26 @@ class MergeTest( unittest.TestCase ) :
 		self.assertEqual( h1, expectedHash )
 		
 	
+	def testConstantInputs( self ) :
+
+		a = GafferImage.Constant()
+		a["color"].setValue( IECore.Color4f( 0.25, 0.5, 0.75, 0.5 ) )
+
+		b = GafferImage.Constant()
+		b["color"].setValue( IECore.Color4f( 1, 0, 0, 1 ) )
+
+		merge = GafferImage.Merge()
+		merge["operation"].setValue( 8 ) # 8 is the Enum value of the over operation.
+		merge["in"].setInput( b["out"] )
+		merge["in1"].setInput( a["out"] )
+
+		ts = GafferImage.ImagePlug.tileSize()
+		for channelName, value in ( ( "R", 0.75 ), ( "G", 0.5 ), ( "B", 0.75 ), ( "A", 1 ) ) :
+			self.assertEqual(
+				merge["out"].channelData( channelName, IECore.V2i( 0 ) ),
+				IECore.FloatVectorData( [ value ] * ts * ts )
+			)
+
 	# Overlay a red, green and blue tile of different data window sizes and check the data window is expanded on the result and looks as we expect.
 	def testOverRGBA( self ) :
 		r = GafferImage.ImageReader()
@@ -173,6 +194,140 @@ class MergeTest( unittest.TestCase ) :
 		
 		self.assertTrue( not IECore.ImageDiffOp()( imageA = expected, imageB = mergeResult, skipMissingChannels = False, maxError = 0.001 ).value )
 		
+	def testSparseInputs( self ) :
+
+		def sparseImage( dataWindow, value ) :
+
+			displayWindow = IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 299 ) )
+			image = IECore.ImagePrimitive( dataWindow, displayWindow )
+			numPixels = ( dataWindow.size().x + 1 ) * ( dataWindow.size().y + 1 )
+			for channelName in ( "R", "G", "B", "A" ) :
+				image[channelName] = IECore.PrimitiveVariable(
+					IECore.PrimitiveVariable.Interpolation.Vertex,
+					IECore.FloatVectorData( [ value ] * numPixels )
+				)
+
+			result = GafferImage.ObjectToImage()
+			result["object"].setValue( image )
+			return result
+
+		# In Gaffer's Y-up space, a covers only the tile at ( 0, 256 )
+		# and b covers only the tile at ( 256, 0 ).
+		a = sparseImage( IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 9 ) ), 0.5 )
+		b = sparseImage( IECore.Box2i( IECore.V2i( 290 ), IECore.V2i( 299 ) ), 0.25 )
+
+		merge = GafferImage.Merge()
+		merge["operation"].setValue( 8 ) # 8 is the Enum value of the over operation.
+		merge["in"].setInput( b["out"] )
+		merge["in1"].setInput( a["out"] )
+
+		# Neither input covers this tile, so it's black.
+		self.assertEqual( merge["out"].channelData( "R", IECore.V2i( 128 ) ), GafferImage.ImagePlug.constantTile( 0 ) )
+
+		# Only a covers this tile, and merging black over it has no effect, so
+		# it should be passed through.
+		self.assertEqual( merge["out"].channelDataHash( "R", IECore.V2i( 0, 256 ) ), a["out"].channelDataHash( "R", IECore.V2i( 0, 256 ) ) )
+		self.assertEqual( merge["out"].channelData( "R", IECore.V2i( 0, 256 ) ), a["out"].channelData( "R", IECore.V2i( 0, 256 ) ) )
+
+		# Only b covers this tile, and merging a transparent black a over it
+		# has no effect.
+		self.assertEqual( merge["out"].channelData( "R", IECore.V2i( 256, 0 ) ), b["out"].channelData( "R", IECore.V2i( 256, 0 ) ) )
+
+		# Moving an input so it covers a tile must change the hash.
+		h = merge["out"].channelDataHash( "R", IECore.V2i( 0, 256 ) )
+		b2 = sparseImage( IECore.Box2i( IECore.V2i( 0, 10 ), IECore.V2i( 9, 19 ) ), 0.25 )
+		merge["in"].setInput( b2["out"] )
+		self.assertNotEqual( merge["out"].channelDataHash( "R", IECore.V2i( 0, 256 ) ), h )
+
+	# A benchmark of ten 4K inputs, rather than a test as such. Uncomment the
+	# print to see the timings.
+	def testPerformance( self ) :
+
+		c = GafferImage.ImageReader()
+		c["fileName"].setValue( self.checkerPath )
+
+		reformat = GafferImage.Reformat()
+		reformat["in"].setInput( c["out"] )
+		reformat["format"].setValue( GafferImage.Format( 4096, 2160, 1. ) )
+
+		merge = GafferImage.Merge()
+		merge["operation"].setValue( 0 ) # 0 is the Enum value of the add operation.
+
+		grades = []
+		for i in range( 0, 10 ) :
+			grade = GafferImage.Grade()
+			grade["in"].setInput( reformat["out"] )
+			grade["multiply"].setValue( IECore.Color3f( 0.1 * ( i + 1 ) ) )
+			merge["in" + ( str( i ) if i else "" )].setInput( grade["out"] )
+			grades.append( grade )
+
+		# Compute the inputs up front, so we time only the merge itself.
+		for grade in grades :
+			grade["out"].image()
+
+		t = IECore.Timer()
+		merge["out"].image()
+		#print "Merge of 10 4K inputs :", t.stop()
+
+	def testManyInputs( self ) :
+
+		c = GafferImage.ImageReader()
+		c["fileName"].setValue( self.checkerPath )
+
+		merge = GafferImage.Merge()
+		merge["operation"].setValue( 0 ) # 0 is the Enum value of the add operation.
+
+		grades = []
+		for i in range( 0, 10 ) :
+			grade = GafferImage.Grade()
+			grade["in"].setInput( c["out"] )
+			grade["multiply"].setValue( IECore.Color3f( 0.1 * ( i + 1 ) ) )
+			merge["in" + ( str( i ) if i else "" )].setInput( grade["out"] )
+			grades.append( grade )
+
+		# Adding the inputs should be the same as scaling the original by the
+		# sum of the multipliers, for every pixel - including those processed
+		# by the scalar code at the end of each vectorised row.
+		tileOrigin = IECore.V2i( 0 )
+		expected = c["out"].channelData( "R", tileOrigin )
+		merged = merge["out"].channelData( "R", tileOrigin )
+		self.assertEqual( len( merged ), len( expected ) )
+		for i in range( 0, len( expected ) ) :
+			self.assertAlmostEqual( merged[i], expected[i] * 5.5, 4 )
+
+	def testInputDataWindowAffectsChannelData( self ) :
+
+		a = GafferImage.Constant()
+		a["format"].setValue( GafferImage.Format( 512, 512, 1. ) )
+		a["color"].setValue( IECore.Color4f( 0.5, 0.5, 0.5, 0.5 ) )
+
+		b = GafferImage.Constant()
+		b["format"].setValue( GafferImage.Format( 512, 512, 1. ) )
+		b["color"].setValue( IECore.Color4f( 0.25, 0.25, 0.25, 1 ) )
+
+		merge = GafferImage.Merge()
+		merge["operation"].setValue( 8 ) # 8 is the Enum value of the over operation.
+		merge["in"].setInput( b["out"] )
+		merge["in1"].setInput( a["out"] )
+
+		for name in [ "in", "in1" ] :
+			affected = [ p.relativeName( merge ) for p in merge.affects( merge[name]["dataWindow"] ) ]
+			self.assertTrue( "out.channelData" in affected )
+
+		tileOrigin = IECore.V2i( 256 )
+		h = merge["out"].channelDataHash( "R", tileOrigin )
+		self.assertAlmostEqual( merge["out"].channelData( "R", tileOrigin )[0], 0.625 )
+
+		# Shrinking a so that it no longer covers the tile must dirty and change
+		# the output, even though the channel data of a itself is unchanged.
+		aHash = a["out"].channelDataHash( "R", tileOrigin )
+		cs = GafferTest.CapturingSlot( merge.plugDirtiedSignal() )
+		a["format"].setValue( GafferImage.Format( 256, 256, 1. ) )
+		self.assertEqual( a["out"].channelDataHash( "R", tileOrigin ), aHash )
+		self.assertTrue( "out.channelData" in [ x[0].relativeName( merge ) for x in cs ] )
+
+		self.assertNotEqual( merge["out"].channelDataHash( "R", tileOrigin ), h )
+		self.assertEqual( merge["out"].channelData( "R", tileOrigin ), b["out"].channelData( "R", tileOrigin ) )
 
 if __name__ == "__main__":
 	unittest.main()
@@ -109,6 +109,137 @@ class OpenColorIOTest( unittest.TestCase ) :
 
 		self.assertNotEqual( i["out"].imageHash(), o["out"].imageHash() )
 	
+	def testChannelsComputedTogether( self ) :
+
+		i = GafferImage.ImageReader()
+		i["fileName"].setValue( self.fileName )
+
+		o = GafferImage.OpenColorIO()
+		o["in"].setInput( i["out"] )
+		o["inputSpace"].setValue( "linear" )
+		o["outputSpace"].setValue( "sRGB" )
+
+		c = Gaffer.Context()
+		c["image:tileOrigin"] = IECore.V2i( 0 )
+		hashes = []
+		with c :
+			for channelName in [ "R", "G", "B" ] :
+				c["image:channelName"] = channelName
+				hashes.append( o["__multiChannelData"].hash() )
+			data = o["__multiChannelData"].getValue()
+
+		# All the channels share the same multi-channel computation.
+		self.assertEqual( len( set( [ str( h ) for h in hashes ] ) ), 1 )
+		self.assertEqual( set( data.keys() ), set( [ "R", "G", "B" ] ) )
+		for channelName in [ "R", "G", "B" ] :
+			self.assertEqual( data[channelName], o["out"].channelData( channelName, IECore.V2i( 0 ) ) )
+
+	def testFusedChain( self ) :
+
+		i = GafferImage.ImageReader()
+		i["fileName"].setValue( self.fileName )
+
+		# A chain of two ColorProcessors, which will be fused into a single pass.
+		o1 = GafferImage.OpenColorIO()
+		o1["in"].setInput( i["out"] )
+		o1["inputSpace"].setValue( "linear" )
+		o1["outputSpace"].setValue( "sRGB" )
+
+		o2 = GafferImage.OpenColorIO()
+		o2["in"].setInput( o1["out"] )
+		o2["inputSpace"].setValue( "linear" )
+		o2["outputSpace"].setValue( "sRGB" )
+
+		# The same chain, but with a switch in the middle to prevent fusion.
+		s = GafferImage.ImageSwitch()
+		s["in"].setInput( o1["out"] )
+
+		o3 = GafferImage.OpenColorIO()
+		o3["in"].setInput( s["out"] )
+		o3["inputSpace"].setValue( "linear" )
+		o3["outputSpace"].setValue( "sRGB" )
+
+		self.assertEqual( o2["out"].image(), o3["out"].image() )
+
+		# Disabled nodes must not be fused.
+		o1["enabled"].setValue( False )
+		self.assertEqual( o2["out"].image(), o3["out"].image() )
+		self.assertNotEqual( o1["out"].image(), o2["out"].image() )
+
+	def testBakedLUT( self ) :
+
+		i = GafferImage.ImageReader()
+		i["fileName"].setValue( os.path.expandvars( "$GAFFER_ROOT/python/GafferTest/images/circles.exr" ) )
+
+		o = GafferImage.OpenColorIO()
+		o["in"].setInput( i["out"] )
+		o["inputSpace"].setValue( "linear" )
+		o["outputSpace"].setValue( "sRGB" )
+
+		exactHash = o["out"].channelDataHash( "R", IECore.V2i( 0 ) )
+		exactImage = o["out"].image()
+
+		o["bakeLUT"].setValue( True )
+		bakedHash = o["out"].channelDataHash( "R", IECore.V2i( 0 ) )
+		self.assertNotEqual( bakedHash, exactHash )
+
+		o["lutSize"].setValue( 65 )
+		self.assertNotEqual( o["out"].channelDataHash( "R", IECore.V2i( 0 ) ), bakedHash )
+
+		op = IECore.ImageDiffOp()
+		res = op(
+			imageA = exactImage,
+			imageB = o["out"].image(),
+			maxError = 0.01,
+		)
+		self.assertFalse( res.value )
+
+	def testBakedLUTOutOfRange( self ) :
+
+		c = GafferImage.Constant()
+		c["color"].setValue( IECore.Color4f( 2, -0.5, 0.5, 1 ) )
+
+		o = GafferImage.OpenColorIO()
+		o["in"].setInput( c["out"] )
+		o["inputSpace"].setValue( "linear" )
+		o["outputSpace"].setValue( "sRGB" )
+
+		exact = [ o["out"].channelData( n, IECore.V2i( 0 ) ) for n in [ "R", "G", "B" ] ]
+
+		# Values outside the domain of the LUT are transformed exactly.
+		o["bakeLUT"].setValue( True )
+		baked = [ o["out"].channelData( n, IECore.V2i( 0 ) ) for n in [ "R", "G", "B" ] ]
+
+		self.assertEqual( exact, baked )
+
+	def testBakedLUTPrecision( self ) :
+
+		c = GafferImage.Constant()
+
+		o = GafferImage.OpenColorIO()
+		o["in"].setInput( c["out"] )
+		o["inputSpace"].setValue( "linear" )
+		o["outputSpace"].setValue( "sRGB" )
+
+		# The LUT must keep its precision in the shadows, where the display
+		# transform is steepest, and must also cover values above 1.
+		for color in (
+			IECore.Color4f( 0.001, 0.004, 0.02, 1 ),
+			IECore.Color4f( 0.18, 0.5, 0.9, 1 ),
+			IECore.Color4f( 1.5, 2, 4, 1 ),
+		) :
+
+			c["color"].setValue( color )
+
+			o["bakeLUT"].setValue( False )
+			exact = [ o["out"].channelData( n, IECore.V2i( 0 ) )[0] for n in [ "R", "G", "B" ] ]
+
+			o["bakeLUT"].setValue( True )
+			baked = [ o["out"].channelData( n, IECore.V2i( 0 ) )[0] for n in [ "R", "G", "B" ] ]
+
+			for e, b in zip( exact, baked ) :
+				self.assertAlmostEqual( e, b, delta = 0.005 )
+
 	def testChannelsAreSeparate( self ) :
 	
 		i = GafferImage.ImageReader()
@@ -179,6 +179,24 @@ class ReformatTest( unittest.TestCase ) :
 			
 			self.assertFalse( res.value )	
 		
+	# Downscales by a large factor, which would previously have required a
+	# very large buffer on the stack.
+	def testLargeDownscale( self ) :
+
+		constant = GafferImage.Constant()
+		constant["format"].setValue( GafferImage.Format( 8192, 4320, 1. ) )
+		constant["color"].setValue( IECore.Color4f( 0.25, 0.5, 0.75, 1 ) )
+
+		reformat = GafferImage.Reformat()
+		reformat["in"].setInput( constant["out"] )
+		reformat["format"].setValue( GafferImage.Format( 256, 135, 1. ) )
+		reformat["filter"].setValue( "Mitchell" )
+
+		for channelName, value in ( ( "R", 0.25 ), ( "G", 0.5 ), ( "B", 0.75 ) ) :
+			data = reformat["out"].channelData( channelName, IECore.V2i( 0 ) )
+			for v in data :
+				self.assertAlmostEqual( v, value, 5 )
+
 	def testChannelNamesPassThrough( self ) :
 	
 		c = GafferImage.Constant()
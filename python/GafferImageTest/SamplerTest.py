@@ -175,6 +175,55 @@ class SamplerTest( unittest.TestCase ) :
 			self.assertEqual( s.sample( bounds.max.x+1, bounds.min.y ), br )
 			self.assertEqual( s.sample( bounds.max.x, bounds.min.y-1 ), br )
 	
+	def testRow( self ) :
+
+		s = Gaffer.ScriptNode()
+		r = GafferImage.ImageReader()
+		r["fileName"].setValue( self.fileName )
+		s.addChild( r )
+
+		c = Gaffer.Context()
+		c["image:channelName"] = 'R'
+		c["image:tileOrigin"] = IECore.V2i( 0 )
+
+		bounds = r["out"]["dataWindow"].getValue()
+
+		with c :
+			for boundingMode in ( GafferImage.BoundingMode.Black, GafferImage.BoundingMode.Clamp ) :
+
+				sampler = GafferImage.Sampler( r["out"], "R", bounds, boundingMode )
+				sampler.prefetch()
+
+				# Rows which start and end outside the sample window,
+				# and which cross several tiles.
+				xMin = bounds.min.x - 10
+				width = bounds.size().x + 21
+				for y in ( bounds.min.y - 1, bounds.min.y, ( bounds.min.y + bounds.max.y ) / 2, bounds.max.y, bounds.max.y + 1 ) :
+					row = sampler.row( xMin, y, width )
+					self.assertEqual( len( row ), width )
+					for i in range( 0, width ) :
+						self.assertEqual( row[i], sampler.sample( xMin + i, y ) )
+
+	def testPythonComputesInParallel( self ) :
+
+		# Every tile needs Python to compute it, so prefetch() and row() must
+		# release the GIL, otherwise the parallel computes would deadlock.
+		s = Gaffer.ScriptNode()
+		s["constant"] = GafferImage.Constant()
+		s["constant"]["format"].setValue( GafferImage.Format( 512, 512, 1. ) )
+		s["expression"] = Gaffer.Expression()
+		s["expression"]["engine"].setValue( "python" )
+		s["expression"]["expression"].setValue( 'parent["constant"]["color"]["r"] = context["image:tileOrigin"].x / 512.0' )
+
+		bounds = IECore.Box2i( IECore.V2i( 0 ), IECore.V2i( 511 ) )
+		with s.context() :
+			sampler = GafferImage.Sampler( s["constant"]["out"], "R", bounds )
+			sampler.prefetch()
+			row = sampler.row( 0, 100, 512 )
+
+		for x in range( 0, 512 ) :
+			self.assertAlmostEqual( row[x], ( x // 64 ) * 64 / 512.0 )
+
 	# Test that the hash() method accumulates all of the hashes of the tiles within the sample area
 	# for a large number of different sample areas.
 	def testSampleHash( self ) :
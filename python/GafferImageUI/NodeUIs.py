@@ -58,6 +58,7 @@ Gaffer.Metadata.registerPlugValue( GafferImage.ImageNode, "enabled", "nodeUI:sec
 # ImageStats
 GafferUI.PlugValueWidget.registerCreator( GafferImage.ImageStats, "channels", GafferImageUI.ChannelMaskPlugValueWidget, inputImagePlug = "in" )
 GafferUI.Nodule.registerNodule( GafferImage.ImageStats, "channels", __noduleCreator )
+GafferUI.PlugValueWidget.registerCreator( GafferImage.ImageStats, "histogram", None )
 
 # ChannelDataProcessor
 GafferUI.PlugValueWidget.registerCreator( GafferImage.ImageNode, "channels", GafferImageUI.ChannelMaskPlugValueWidget, inputImagePlug = "in" )
@@ -104,6 +105,10 @@ GafferUI.PlugValueWidget.registerCreator( GafferImage.ImageWriter, "channels", G
 GafferUI.Nodule.registerNodule( GafferImage.ImageWriter, "fileName", lambda plug : None )
 GafferUI.Nodule.registerNodule( GafferImage.ImageWriter, "channels", lambda plug : None )
 GafferUI.Nodule.registerNodule( GafferImage.ImageWriter, "writeMode", lambda plug : None )
+GafferUI.Nodule.registerNodule( GafferImage.ImageWriter, "dataType", lambda plug : None )
+GafferUI.Nodule.registerNodule( GafferImage.ImageWriter, "floatChannels", lambda plug : None )
+GafferUI.Nodule.registerNodule( GafferImage.ImageWriter, "compression", lambda plug : None )
+GafferUI.Nodule.registerNodule( GafferImage.ImageWriter, "multiPart", lambda plug : None )
 
 writeModeLabelsAndValues = [ ( "Scanline", 0), ( "Tile", 1 ) ]
 
@@ -114,6 +119,26 @@ GafferUI.PlugValueWidget.registerCreator(
 	labelsAndValues = writeModeLabelsAndValues
 )
 
+dataTypeLabelsAndValues = [ ( "Float", 0 ), ( "Half", 1 ) ]
+
+GafferUI.PlugValueWidget.registerCreator(
+	GafferImage.ImageWriter,
+	"dataType",
+	GafferUI.EnumPlugValueWidget,
+	labelsAndValues = dataTypeLabelsAndValues
+)
+
+GafferUI.PlugValueWidget.registerCreator( GafferImage.ImageWriter, "floatChannels", GafferImageUI.ChannelMaskPlugValueWidget, inputImagePlug = "in" )
+
+compressionLabelsAndValues = [ ( "Default", "" ), ( "None", "none" ), ( "RLE", "rle" ), ( "Zip", "zip" ), ( "Zip Scanline", "zips" ), ( "Piz", "piz" ), ( "Pxr24", "pxr24" ), ( "B44", "b44" ), ( "B44A", "b44a" ) ]
+
+GafferUI.PlugValueWidget.registerCreator(
+	GafferImage.ImageWriter,
+	"compression",
+	GafferUI.EnumPlugValueWidget,
+	labelsAndValues = compressionLabelsAndValues
+)
+
 # Constant
 GafferUI.PlugValueWidget.registerCreator(
 	GafferImage.Constant,
@@ -160,4 +185,13 @@ GafferUI.PlugValueWidget.registerCreator(
 	labelsAndValues = removeChannelsLabelsAndValues
 )
 
+# Blur
+blurTypeLabelsAndValues = [ ( "Box", 0 ), ( "Gaussian", 1 ) ]
+GafferUI.PlugValueWidget.registerCreator(
+	GafferImage.Blur,
+	"type",
+	GafferUI.EnumPlugValueWidget,
+	labelsAndValues = blurTypeLabelsAndValues
+)
+
 
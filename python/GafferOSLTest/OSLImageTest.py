@@ -184,6 +184,44 @@ class OSLImageTest( GafferOSLTest.OSLTestCase ) :
 		self.assertEqual( outputImage["R"].data, IECore.FloatVectorData( [ 0 ] * inputImage["R"].data.size() ) )
 		self.assertEqual( outputImage["G"].data, inputImage["G"].data )
 		self.assertEqual( outputImage["B"].data, inputImage["B"].data )
-		
+
+	def testManyTiles( self ) :
+
+		# The shading globals are cached per tile, so check that
+		# every tile of a larger image is shaded correctly.
+
+		getRed = GafferOSL.OSLShader()
+		getRed.loadShader( "ImageProcessing/InChannel" )
+		getRed["parameters"]["channelName"].setValue( "R" )
+
+		outG = GafferOSL.OSLShader()
+		outG.loadShader( "ImageProcessing/OutChannel" )
+		outG["parameters"]["channelName"].setValue( "G" )
+		outG["parameters"]["channelValue"].setInput( getRed["out"]["channelValue"] )
+
+		imageShader = GafferOSL.OSLShader()
+		imageShader.loadShader( "ImageProcessing/OutImage" )
+		imageShader["parameters"]["in0"].setInput( outG["out"]["channel"] )
+
+		reader = GafferImage.ImageReader()
+		reader["fileName"].setValue( os.path.expandvars( "$GAFFER_ROOT/python/GafferTest/images/checkerWithNegativeDataWindow.200x150.exr" ) )
+
+		image = GafferOSL.OSLImage()
+		image["in"].setInput( reader["out"] )
+		image["shader"].setInput( imageShader["out"] )
+
+		dataWindow = reader["out"]["dataWindow"].getValue()
+		tileSize = GafferImage.ImagePlug.tileSize()
+		tileOrigin = GafferImage.ImagePlug.tileOrigin( dataWindow.min )
+		hashes = set()
+		for y in range( tileOrigin.y, dataWindow.max.y + 1, tileSize ) :
+			for x in range( tileOrigin.x, dataWindow.max.x + 1, tileSize ) :
+				t = IECore.V2i( x, y )
+				self.assertEqual( image["out"].channelData( "G", t ), reader["out"].channelData( "R", t ) )
+				self.assertEqual( image["out"].channelData( "R", t ), reader["out"].channelData( "R", t ) )
+				hashes.add( str( image["out"].channelDataHash( "G", t ) ) )
+
+		self.assertEqual( len( hashes ), ( ( dataWindow.max.x - tileOrigin.x ) / tileSize + 1 ) * ( ( dataWindow.max.y - tileOrigin.y ) / tileSize + 1 ) )
+
 if __name__ == "__main__":
 	unittest.main()
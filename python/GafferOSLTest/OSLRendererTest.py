@@ -35,6 +35,8 @@
 ##########################################################################
 
 import os
+import unittest
+import multiprocessing
 
 import IECore
 
@@ -301,6 +303,66 @@ class OSLRendererTest( GafferOSLTest.OSLTestCase ) :
 				self.assertEqual( shading["v"][i], IECore.V3f( 0 ) )
 				self.assertEqual( shading["n"][i], IECore.V3f( 0 ) )
 				self.assertEqual( shading["c"][i], IECore.Color3f( 0 ) )
-						
+
+	def testManyPoints( self ) :
+
+		# Enough points to be shaded in many parallel chunks.
+		globals = self.compileShader( os.path.dirname( __file__ ) + "/shaders/globals.osl" )
+		debug = self.compileShader( os.path.dirname( __file__ ) + "/shaders/debugClosure.osl" )
+
+		points = self.rectanglePoints( divisions = IECore.V2i( 200 ) )
+
+		r = GafferOSL.OSLRenderer()
+		with IECore.WorldBlock( r ) :
+
+			r.shader( "surface", globals, { "global" : "u" } )
+			shading = r.shadingEngine().shade( points )
+			self.assertEqual( len( shading["Ci"] ), len( points["P"] ) )
+			for i in range( 0, len( points["P"] ) ) :
+				self.assertEqual( shading["Ci"][i], IECore.Color3f( points["u"][i] ) )
+
+			r.shader( "surface", debug, { "name" : "a", "weight" : IECore.Color3f( 1, 0, 0 ) } )
+			shading = r.shadingEngine().shade( points )
+			self.assertEqual( len( shading["a"] ), len( points["P"] ) )
+			for a in shading["a"] :
+				self.assertEqual( a, IECore.Color3f( 1, 0, 0 ) )
+
+	def testManyPointsWithMultipleDebugClosures( self ) :
+
+		# Each parallel chunk of points meets the debug closures
+		# independently, and all must write to the same results.
+		shader = self.compileShader( os.path.dirname( __file__ ) + "/shaders/multipleDebugClosures.osl" )
+		points = self.rectanglePoints( divisions = IECore.V2i( 200 ) )
+
+		r = GafferOSL.OSLRenderer()
+		with IECore.WorldBlock( r ) :
+
+			r.shader( "surface", shader, {} )
+			shading = r.shadingEngine().shade( points )
+
+			for n in ( "u", "v", "P" ) :
+				self.assertEqual( len( shading[n] ), len( points["P"] ) )
+				for i in range( 0, len( points["P"] ) ) :
+					self.assertEqual( shading[n][i], IECore.Color3f( points[n][i] ) )
+
+	@unittest.skipUnless( hasattr( IECore, "tbb_task_scheduler_init" ), "Thread count can't be controlled" )
+	def testPerformance( self ) :
+
+		shader = self.compileShader( os.path.dirname( __file__ ) + "/shaders/globals.osl" )
+		points = self.rectanglePoints( divisions = IECore.V2i( 500 ) )
+
+		r = GafferOSL.OSLRenderer()
+		with IECore.WorldBlock( r ) :
+
+			r.shader( "surface", shader, { "global" : "P" } )
+			e = r.shadingEngine()
+
+			# Shading should scale with the number of threads.
+			for numThreads in ( 1, 2, 4, multiprocessing.cpu_count() ) :
+				with IECore.tbb_task_scheduler_init( numThreads ) :
+					t = IECore.Timer()
+					e.shade( points )
+					#print numThreads, "threads", t.stop()
+
 if __name__ == "__main__":
 	unittest.main()
@@ -0,0 +1,518 @@
+//////////////////////////////////////////////////////////////////////////
+//  
+//  Copyright (c) 2014, John Haddon. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//  
+//      * Redistributions of source code must retain the above
+//        copyright notice, this list of conditions and the following
+//        disclaimer.
+//  
+//      * Redistributions in binary form must reproduce the above
+//        copyright notice, this list of conditions and the following
+//        disclaimer in the documentation and/or other materials provided with
+//        the distribution.
+//  
+//      * Neither the name of John Haddon nor the names of
+//        any other contributors to this software may be used to endorse or
+//        promote products derived from this software without specific prior
+//        written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//////////////////////////////////////////////////////////////////////////
+
+#include <cmath>
+
+#include "Gaffer/Context.h"
+
+#include "GafferImage/Blur.h"
+#include "GafferImage/Sampler.h"
+
+using namespace std;
+using namespace Imath;
+using namespace IECore;
+using namespace Gaffer;
+using namespace GafferImage;
+
+//////////////////////////////////////////////////////////////////////////
+// Utilities
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// Applies a box blur of the specified radius to a row of pixels, using
+// a running sum so that the cost per pixel is independent of the radius. The
+// result is written back into the start of the row, and is shorter than
+// the input by 2 * radius pixels - only pixels with a full neighbourhood
+// are output.
+void boxBlurRow( float *row, int length, int radius, vector<double> &sums )
+{
+	sums.resize( length + 1 );
+	sums[0] = 0;
+	for( int i = 0; i < length; ++i )
+	{
+		sums[i+1] = sums[i] + row[i];
+	}
+
+	const int width = 2 * radius + 1;
+	const double normalisation = 1.0 / width;
+	for( int i = 0, e = length - 2 * radius; i < e; ++i )
+	{
+		row[i] = ( sums[i+width] - sums[i] ) * normalisation;
+	}
+}
+
+// As above, but blurring vertically through a block of height rows each
+// rowLength pixels long. The column sums are accumulated a row at a time
+// so that memory is accessed sequentially.
+void boxBlurColumns( float *rows, int rowLength, int height, int radius, vector<double> &sums )
+{
+	sums.resize( ( height + 1 ) * rowLength );
+	fill( sums.begin(), sums.begin() + rowLength, 0.0 );
+	for( int i = 0; i < height; ++i )
+	{
+		const double *previousSums = &sums[i*rowLength];
+		double *currentSums = &sums[(i+1)*rowLength];
+		const float *row = rows + i * rowLength;
+		for( int x = 0; x < rowLength; ++x )
+		{
+			currentSums[x] = previousSums[x] + row[x];
+		}
+	}
+
+	const int width = 2 * radius + 1;
+	const double normalisation = 1.0 / width;
+	for( int i = 0, e = height - 2 * radius; i < e; ++i )
+	{
+		const double *lowerSums = &sums[i*rowLength];
+		const double *upperSums = &sums[(i+width)*rowLength];
+		float *row = rows + i * rowLength;
+		for( int x = 0; x < rowLength; ++x )
+		{
+			row[x] = ( upperSums[x] - lowerSums[x] ) * normalisation;
+		}
+	}
+}
+
+int sumRadii( const vector<int> &radii )
+{
+	int result = 0;
+	for( vector<int>::const_iterator it = radii.begin(), eIt = radii.end(); it != eIt; ++it )
+	{
+		result += *it;
+	}
+	return result;
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+// Blur
+//////////////////////////////////////////////////////////////////////////
+
+IE_CORE_DEFINERUNTIMETYPED( Blur );
+
+size_t Blur::g_firstPlugIndex = 0;
+
+Blur::Blur( const std::string &name )
+	:	ImageProcessor( name )
+{
+	storeIndexOfNextChild( g_firstPlugIndex );
+	addChild( new V2fPlug( "radius", Plug::In, V2f( 0 ), V2f( 0 ) ) );
+	addChild( new IntPlug( "type", Plug::In, Box, Box, Gaussian ) );
+	addChild( new FloatVectorDataPlug( "__horizontalPass", Plug::Out, new FloatVectorData ) );
+}
+
+Blur::~Blur()
+{
+}
+
+Gaffer::V2fPlug *Blur::radiusPlug()
+{
+	return getChild<V2fPlug>( g_firstPlugIndex );
+}
+
+const Gaffer::V2fPlug *Blur::radiusPlug() const
+{
+	return getChild<V2fPlug>( g_firstPlugIndex );
+}
+
+Gaffer::IntPlug *Blur::typePlug()
+{
+	return getChild<IntPlug>( g_firstPlugIndex + 1 );
+}
+
+const Gaffer::IntPlug *Blur::typePlug() const
+{
+	return getChild<IntPlug>( g_firstPlugIndex + 1 );
+}
+
+Gaffer::FloatVectorDataPlug *Blur::horizontalPassPlug()
+{
+	return getChild<FloatVectorDataPlug>( g_firstPlugIndex + 2 );
+}
+
+const Gaffer::FloatVectorDataPlug *Blur::horizontalPassPlug() const
+{
+	return getChild<FloatVectorDataPlug>( g_firstPlugIndex + 2 );
+}
+
+void Blur::affects( const Gaffer::Plug *input, AffectedPlugsContainer &outputs ) const
+{
+	ImageProcessor::affects( input, outputs );
+
+	if( input == inPlug()->formatPlug() || input == inPlug()->channelNamesPlug() )
+	{
+		outputs.push_back( outPlug()->getChild<ValuePlug>( input->getName() ) );
+	}
+	else if( input == inPlug()->dataWindowPlug() )
+	{
+		outputs.push_back( outPlug()->dataWindowPlug() );
+		outputs.push_back( outPlug()->channelDataPlug() );
+		outputs.push_back( horizontalPassPlug() );
+	}
+	else if( input == inPlug()->channelDataPlug() )
+	{
+		outputs.push_back( horizontalPassPlug() );
+	}
+	else if( radiusPlug()->isAncestorOf( input ) || input == typePlug() )
+	{
+		outputs.push_back( outPlug()->dataWindowPlug() );
+		outputs.push_back( outPlug()->channelDataPlug() );
+		outputs.push_back( horizontalPassPlug() );
+	}
+	else if( input == horizontalPassPlug() )
+	{
+		outputs.push_back( outPlug()->channelDataPlug() );
+	}
+}
+
+bool Blur::enabled() const
+{
+	if( !ImageProcessor::enabled() )
+	{
+		return false;
+	}
+
+	return totalRadius( 0 ) || totalRadius( 1 );
+}
+
+void Blur::hash( const Gaffer::ValuePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
+{
+	ImageProcessor::hash( output, context, h );
+
+	if( output == horizontalPassPlug() )
+	{
+		hashHorizontalPass( context, h );
+	}
+}
+
+void Blur::compute( Gaffer::ValuePlug *output, const Gaffer::Context *context ) const
+{
+	if( output == horizontalPassPlug() )
+	{
+		static_cast<FloatVectorDataPlug *>( output )->setValue( computeHorizontalPass( context ) );
+		return;
+	}
+
+	ImageProcessor::compute( output, context );
+}
+
+void Blur::hashFormat( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
+{
+	h = inPlug()->formatPlug()->hash();
+}
+
+void Blur::hashDataWindow( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
+{
+	ImageProcessor::hashDataWindow( output, context, h );
+	inPlug()->dataWindowPlug()->hash( h );
+	h.append( V2i( totalRadius( 0 ), totalRadius( 1 ) ) );
+}
+
+void Blur::hashChannelNames( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
+{
+	h = inPlug()->channelNamesPlug()->hash();
+}
+
+void Blur::hashChannelData( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
+{
+	const V2i tileOrigin = context->get<V2i>( ImagePlug::tileOriginContextName );
+	if( tileCoverage( tileOrigin, outPlug()->dataWindowPlug()->getValue() ) == EmptyTile )
+	{
+		h = blackTileHash();
+		return;
+	}
+
+	ImageProcessor::hashChannelData( output, context, h );
+
+	vector<int> radiiY;
+	boxRadii( 1, radiiY );
+	for( vector<int>::const_iterator it = radiiY.begin(), eIt = radiiY.end(); it != eIt; ++it )
+	{
+		h.append( *it );
+	}
+
+	// Hash the horizontal passes for all the tiles above and below us that
+	// the vertical pass will read from. Those outside the input data window
+	// are black, and aren't read at all.
+
+	const int tileSize = ImagePlug::tileSize();
+	const int radiusY = sumRadii( radiiY );
+	const int minY = tileOrigin.y - radiusY;
+	const int maxY = tileOrigin.y + tileSize - 1 + radiusY;
+	const Box2i inputDataWindow = inPlug()->dataWindowPlug()->getValue();
+
+	ContextPtr tmpContext = new Context( *context, Context::Borrowed );
+	Context::Scope scopedContext( tmpContext );
+	for( int y = ImagePlug::tileOrigin( V2i( tileOrigin.x, minY ) ).y; y <= maxY; y += tileSize )
+	{
+		if( y > inputDataWindow.max.y || y + tileSize - 1 < inputDataWindow.min.y )
+		{
+			continue;
+		}
+		tmpContext->set( ImagePlug::tileOriginContextName, V2i( tileOrigin.x, y ) );
+		horizontalPassPlug()->hash( h );
+	}
+
+	h.append( inputDataWindow );
+	h.append( tileOrigin );
+}
+
+GafferImage::Format Blur::computeFormat( const Gaffer::Context *context, const ImagePlug *parent ) const
+{
+	return inPlug()->formatPlug()->getValue();
+}
+
+Imath::Box2i Blur::computeDataWindow( const Gaffer::Context *context, const ImagePlug *parent ) const
+{
+	Box2i dataWindow = inPlug()->dataWindowPlug()->getValue();
+	if( dataWindow.isEmpty() )
+	{
+		return dataWindow;
+	}
+
+	const V2i radius( totalRadius( 0 ), totalRadius( 1 ) );
+	dataWindow.min -= radius;
+	dataWindow.max += radius;
+	return dataWindow;
+}
+
+IECore::ConstStringVectorDataPtr Blur::computeChannelNames( const Gaffer::Context *context, const ImagePlug *parent ) const
+{
+	return inPlug()->channelNamesPlug()->getValue();
+}
+
+IECore::ConstFloatVectorDataPtr Blur::computeChannelData( const std::string &channelName, const Imath::V2i &tileOrigin, const Gaffer::Context *context, const ImagePlug *parent ) const
+{
+	// Tiles which the blur doesn't reach are outside the data window,
+	// so we needn't compute them.
+	if( tileCoverage( tileOrigin, outPlug()->dataWindowPlug()->getValue() ) == EmptyTile )
+	{
+		return ImagePlug::blackTile();
+	}
+
+	vector<int> radiiY;
+	boxRadii( 1, radiiY );
+
+	// Gather the horizontally blurred rows that the vertical pass needs
+	// from the tiles above and below us, into a buffer which is tileSize
+	// wide. Rows outside the input data window are left black.
+
+	const int tileSize = ImagePlug::tileSize();
+	const int radiusY = sumRadii( radiiY );
+	const int minY = tileOrigin.y - radiusY;
+	const int maxY = tileOrigin.y + tileSize - 1 + radiusY;
+	const Box2i inputDataWindow = inPlug()->dataWindowPlug()->getValue();
+
+	vector<float> intermediate( ( maxY - minY + 1 ) * tileSize, 0.0f );
+
+	{
+		ContextPtr tmpContext = new Context( *context, Context::Borrowed );
+		Context::Scope scopedContext( tmpContext );
+		for( int y = ImagePlug::tileOrigin( V2i( tileOrigin.x, minY ) ).y; y <= maxY; y += tileSize )
+		{
+			if( y > inputDataWindow.max.y || y + tileSize - 1 < inputDataWindow.min.y )
+			{
+				continue;
+			}
+			tmpContext->set( ImagePlug::tileOriginContextName, V2i( tileOrigin.x, y ) );
+			ConstFloatVectorDataPtr horizontalData = horizontalPassPlug()->getValue();
+			const vector<float> &horizontal = horizontalData->readable();
+
+			const int beginY = std::max( y, minY );
+			const int endY = std::min( y + tileSize - 1, maxY ) + 1;
+			std::copy(
+				horizontal.begin() + ( beginY - y ) * tileSize,
+				horizontal.begin() + ( endY - y ) * tileSize,
+				intermediate.begin() + ( beginY - minY ) * tileSize
+			);
+		}
+	}
+
+	// Then blur vertically, through all the rows at once.
+
+	vector<double> sums;
+	int height = maxY - minY + 1;
+	for( vector<int>::const_iterator it = radiiY.begin(), eIt = radiiY.end(); it != eIt; ++it )
+	{
+		boxBlurColumns( &intermediate[0], tileSize, height, *it, sums );
+		height -= 2 * *it;
+	}
+
+	FloatVectorDataPtr resultData = new FloatVectorData;
+	resultData->writable().assign( intermediate.begin(), intermediate.begin() + tileSize * tileSize );
+	return resultData;
+}
+
+void Blur::hashHorizontalPass( const Gaffer::Context *context, IECore::MurmurHash &h ) const
+{
+	const V2i tileOrigin = context->get<V2i>( ImagePlug::tileOriginContextName );
+	const std::string &channelName = context->get<std::string>( ImagePlug::channelNameContextName );
+
+	vector<int> radiiX;
+	boxRadii( 0, radiiX );
+	for( vector<int>::const_iterator it = radiiX.begin(), eIt = radiiX.end(); it != eIt; ++it )
+	{
+		h.append( *it );
+	}
+
+	const int radiusX = sumRadii( radiiX );
+	const Box2i inputWindow(
+		tileOrigin - V2i( radiusX, 0 ),
+		tileOrigin + V2i( ImagePlug::tileSize() - 1 + radiusX, ImagePlug::tileSize() - 1 )
+	);
+
+	Sampler sampler( inPlug(), channelName, inputWindow, Sampler::Black );
+	sampler.hash( h );
+
+	// The sampler only hashes the tiles it accesses, so we must also
+	// account for the data window which determines which pixels are black.
+	h.append( inPlug()->dataWindowPlug()->getValue() );
+	h.append( tileOrigin );
+}
+
+IECore::ConstFloatVectorDataPtr Blur::computeHorizontalPass( const Gaffer::Context *context ) const
+{
+	const V2i tileOrigin = context->get<V2i>( ImagePlug::tileOriginContextName );
+	const std::string &channelName = context->get<std::string>( ImagePlug::channelNameContextName );
+
+	vector<int> radiiX;
+	boxRadii( 0, radiiX );
+
+	const int tileSize = ImagePlug::tileSize();
+	const int radiusX = sumRadii( radiiX );
+	const Box2i inputWindow(
+		tileOrigin - V2i( radiusX, 0 ),
+		tileOrigin + V2i( tileSize - 1 + radiusX, tileSize - 1 )
+	);
+
+	Sampler sampler( inPlug(), channelName, inputWindow, Sampler::Black );
+	sampler.prefetch();
+
+	// Blur one input row at a time, keeping only the tileSize pixels
+	// which have a full neighbourhood.
+
+	FloatVectorDataPtr resultData = new FloatVectorData;
+	vector<float> &result = resultData->writable();
+	result.resize( tileSize * tileSize );
+
+	const int inputWidth = tileSize + 2 * radiusX;
+	vector<float> row( inputWidth );
+	vector<double> sums;
+
+	for( int i = 0; i < tileSize; ++i )
+	{
+		sampler.row( inputWindow.min.x, tileOrigin.y + i, inputWidth, &row[0] );
+		int length = inputWidth;
+		for( vector<int>::const_iterator it = radiiX.begin(), eIt = radiiX.end(); it != eIt; ++it )
+		{
+			boxBlurRow( &row[0], length, *it, sums );
+			length -= 2 * *it;
+		}
+		std::copy( row.begin(), row.begin() + tileSize, result.begin() + i * tileSize );
+	}
+
+	return resultData;
+}
+
+void Blur::boxRadii( int axis, std::vector<int> &radii ) const
+{
+	radii.clear();
+
+	const float radius = radiusPlug()->getValue()[axis] / float( 1 << ImagePlug::lod( Context::current() ) );
+	if( radius <= 0.0f )
+	{
+		return;
+	}
+
+	if( typePlug()->getValue() == Box )
+	{
+		const int r = (int)floor( radius + 0.5f );
+		if( r > 0 )
+		{
+			radii.push_back( r );
+		}
+		return;
+	}
+
+	// Gaussian. Three successive box blurs give a good approximation to a
+	// gaussian, provided their widths are chosen so that the variance of
+	// the result matches. Box widths must be odd so that they are centred
+	// on a pixel, so we choose from the two odd widths either side of the
+	// ideal width, using as many of each as gives the closest variance.
+	// See "Fast Almost-Gaussian Filtering" (Kovesi, 2010).
+
+	const int n = 3;
+	const double sigma = radius / 3.0;
+	const double idealWidth = sqrt( 12.0 * sigma * sigma / n + 1.0 );
+	int lowerWidth = (int)floor( idealWidth );
+	if( lowerWidth % 2 == 0 )
+	{
+		lowerWidth--;
+	}
+	const int upperWidth = lowerWidth + 2;
+
+	const double idealLowerCount = ( 12.0 * sigma * sigma - n * lowerWidth * lowerWidth - 4.0 * n * lowerWidth - 3.0 * n ) / ( -4.0 * lowerWidth - 4.0 );
+	const int lowerCount = (int)floor( idealLowerCount + 0.5 );
+
+	for( int i = 0; i < n; ++i )
+	{
+		const int width = i < lowerCount ? lowerWidth : upperWidth;
+		const int r = ( width - 1 ) / 2;
+		if( r > 0 )
+		{
+			radii.push_back( r );
+		}
+	}
+
+	// Small gaussians have a variance closer to that of unit width boxes
+	// than to any wider ones, so the above yields no blur at all. Rather
+	// than ignore a radius that would have blurred a box, fall back to the
+	// smallest box we can.
+	if( radii.empty() && radius >= 0.5f )
+	{
+		radii.push_back( 1 );
+	}
+}
+
+int Blur::totalRadius( int axis ) const
+{
+	vector<int> radii;
+	boxRadii( axis, radii );
+	return sumRadii( radii );
+}
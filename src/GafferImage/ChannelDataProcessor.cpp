@@ -85,6 +85,11 @@ void ChannelDataProcessor::affects( const Gaffer::Plug *input, AffectedPlugsCont
 	)
 	{
 		outputs.push_back( outPlug()->getChild<ValuePlug>( input->getName() ) );	
+		if( input == inPlug()->dataWindowPlug() )
+		{
+			// Tiles outside the data window are output as black.
+			outputs.push_back( outPlug()->channelDataPlug() );
+		}
 	}
 
 	if( input == channelMaskPlug() )
@@ -93,6 +98,26 @@ void ChannelDataProcessor::affects( const Gaffer::Plug *input, AffectedPlugsCont
 	}
 }
 
+void ChannelDataProcessor::hash( const Gaffer::ValuePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
+{
+	// Tiles outside the data window are output as black by computeChannelData(),
+	// so we hash them here rather than leaving it to every derived class. We check
+	// the coverage first as it is the cheaper test, but must still pass through
+	// when the node or channel is disabled, to match ImageProcessor::compute().
+	if(
+		output == outPlug()->channelDataPlug() &&
+		inputTileCoverage( context ) == EmptyTile &&
+		enabled() &&
+		channelEnabled( context->get<std::string>( ImagePlug::channelNameContextName ) )
+	)
+	{
+		h = blackTileHash();
+		return;
+	}
+
+	ImageProcessor::hash( output, context, h );
+}
+
 bool ChannelDataProcessor::channelEnabled( const std::string &channel ) const
 {
 	if( !ImageProcessor::channelEnabled( channel ) )
@@ -107,7 +132,27 @@ bool ChannelDataProcessor::channelEnabled( const std::string &channel ) const
 
 IECore::ConstFloatVectorDataPtr ChannelDataProcessor::computeChannelData( const std::string &channelName, const Imath::V2i &tileOrigin, const Gaffer::Context *context, const ImagePlug *parent ) const
 {
-	IECore::FloatVectorDataPtr outData = inPlug()->channelData( channelName, tileOrigin )->copy();
+	// There's no point processing tiles outside the data window, as they
+	// would be ignored anyway. This is matched by the blackTileHash()
+	// output by hash().
+	if( inputTileCoverage( context ) == EmptyTile )
+	{
+		return ImagePlug::blackTile();
+	}
+
+	IECore::ConstFloatVectorDataPtr inData = inPlug()->channelData( channelName, tileOrigin );
+
+	// If the input is constant then so is the output, so we only
+	// need to process a single value.
+	float value;
+	if( ImagePlug::isConstantTile( inData.get(), value ) )
+	{
+		IECore::FloatVectorDataPtr valueData = new IECore::FloatVectorData( std::vector<float>( 1, value ) );
+		processChannelData( context, parent, channelName, valueData );
+		return ImagePlug::constantTile( valueData->readable()[0] );
+	}
+
+	IECore::FloatVectorDataPtr outData = inData->copy();
 	processChannelData( context, parent, channelName, outData );
 	return outData;
 }
@@ -53,17 +53,9 @@ ColorProcessor::ColorProcessor( const std::string &name )
 	:	ImageProcessor( name )
 {
 	storeIndexOfNextChild( g_firstPlugIndex );
-	
-	addChild(
-		new ObjectPlug(
-			"__colorData",
-			Gaffer::Plug::Out,
-			new ObjectVector
-		)
-	);
 
 	// Because our implementation of computeChannelData() is so simple,
-	// just copying data out of our intermediate colorDataPlug(), it is
+	// just copying data out of our intermediate multiChannelDataPlug(), it is
 	// actually quicker not to cache the result.
 	outPlug()->channelDataPlug()->setFlags( Plug::Cacheable, false );
 }
@@ -72,16 +64,6 @@ ColorProcessor::~ColorProcessor()
 {
 }
 
-Gaffer::ObjectPlug *ColorProcessor::colorDataPlug()
-{
-	return getChild<ObjectPlug>( g_firstPlugIndex );
-}
-
-const Gaffer::ObjectPlug *ColorProcessor::colorDataPlug() const
-{
-	return getChild<ObjectPlug>( g_firstPlugIndex );
-}
-
 void ColorProcessor::affects( const Gaffer::Plug *input, AffectedPlugsContainer &outputs ) const
 {
 	ImageProcessor::affects( input, outputs );
@@ -92,14 +74,15 @@ void ColorProcessor::affects( const Gaffer::Plug *input, AffectedPlugsContainer
 	)
 	{
 		outputs.push_back( outPlug()->getChild<ValuePlug>( input->getName() ) );	
+		if( input == inPlug()->dataWindowPlug() )
+		{
+			// Tiles outside the data window are output as black.
+			outputs.push_back( outPlug()->channelDataPlug() );
+		}
 	}
 	else if( affectsColorData( input ) )
 	{
-		outputs.push_back( colorDataPlug() );
-	}
-	else if( input == colorDataPlug()  )
-	{
-		outputs.push_back( outPlug()->channelDataPlug() );
+		outputs.push_back( multiChannelDataPlug() );
 	}
 }
 
@@ -113,44 +96,78 @@ bool ColorProcessor::channelEnabled( const std::string &channel ) const
 	return channel == "R" || channel == "G" || channel == "B";
 }
 
-void ColorProcessor::hash( const Gaffer::ValuePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
+void ColorProcessor::hashMultiChannelData( const Imath::V2i &tileOrigin, const Gaffer::Context *context, IECore::MurmurHash &h ) const
 {
-	ImageProcessor::hash( output, context, h );
-	
-	if( output == colorDataPlug() )
+	ImageProcessor::hashMultiChannelData( tileOrigin, context, h );
+	hashColorData( context, h );
+}
+
+IECore::ConstCompoundObjectPtr ColorProcessor::computeMultiChannelData( const Imath::V2i &tileOrigin, const Gaffer::Context *context ) const
+{
+	// Find the chain of ColorProcessors upstream of us which can be fused into
+	// a single pass. The chain is ordered from downstream to upstream.
+	std::vector<const ColorProcessor *> chain( 1, this );
+	while( const ColorProcessor *upstream = chain.back()->fusableInput() )
+	{
+		chain.push_back( upstream );
+	}
+
+	// Get the input data from the top of the chain. We modify it in place
+	// if no-one else holds a reference to it, and otherwise take a copy.
+	FloatVectorDataPtr rgb[3];
+	{
+		const ImagePlug *in = chain.back()->inPlug();
+		ContextPtr tmpContext = new Context( *context, Context::Borrowed );
+		Context::Scope scopedContext( tmpContext );
+		const char *channelNames[3] = { "R", "G", "B" };
+		for( int i = 0; i < 3; ++i )
+		{
+			tmpContext->set( ImagePlug::channelNameContextName, string( channelNames[i] ) );
+			ConstFloatVectorDataPtr channelData = in->channelDataPlug()->getValue();
+			if( channelData->refCount() == 1 )
+			{
+				rgb[i] = const_cast<FloatVectorData *>( channelData.get() );
+			}
+			else
+			{
+				rgb[i] = channelData->copy();
+			}
+		}
+	}
+
+	for( std::vector<const ColorProcessor *>::const_reverse_iterator it = chain.rbegin(), eIt = chain.rend(); it != eIt; ++it )
 	{
-		hashColorData( context, h );
+		(*it)->processColorData( context, rgb[0].get(), rgb[1].get(), rgb[2].get() );
 	}
+
+	CompoundObjectPtr result = new CompoundObject();
+	result->members()["R"] = rgb[0];
+	result->members()["G"] = rgb[1];
+	result->members()["B"] = rgb[2];
+
+	return result;
 }
 
-void ColorProcessor::compute( Gaffer::ValuePlug *output, const Gaffer::Context *context ) const
+const ColorProcessor *ColorProcessor::fusableInput() const
 {
-	if( output == colorDataPlug() )
+	const ImagePlug *input = inPlug()->getInput<ImagePlug>();
+	if( !input )
 	{
-		FloatVectorDataPtr r, g, b;
-		{
-			ContextPtr tmpContext = new Context( *context, Context::Borrowed );
-			Context::Scope scopedContext( tmpContext );
-			tmpContext->set( ImagePlug::channelNameContextName, string( "R" ) );
-			r = inPlug()->channelDataPlug()->getValue()->copy();
-			tmpContext->set( ImagePlug::channelNameContextName, string( "G" ) );
-			g = inPlug()->channelDataPlug()->getValue()->copy();
-			tmpContext->set( ImagePlug::channelNameContextName, string( "B" ) );
-			b = inPlug()->channelDataPlug()->getValue()->copy();
-		}	
-		
-		processColorData( context, r.get(), g.get(), b.get() );
-		
-		ObjectVectorPtr result = new ObjectVector();
-		result->members().push_back( r );
-		result->members().push_back( g );
-		result->members().push_back( b );
-		
-		static_cast<ObjectPlug *>( output )->setValue( result );
-		return;
+		return NULL;
 	}
-	
-	ImageProcessor::compute( output, context );
+
+	const ColorProcessor *upstream = runTimeCast<const ColorProcessor>( input->node() );
+	if( !upstream || input != upstream->outPlug() )
+	{
+		return NULL;
+	}
+
+	if( !upstream->enabled() || !upstream->channelEnabled( "R" ) || !upstream->channelEnabled( "G" ) || !upstream->channelEnabled( "B" ) )
+	{
+		return NULL;
+	}
+
+	return upstream;
 }
 
 void ColorProcessor::hashFormat( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
@@ -185,29 +202,27 @@ IECore::ConstStringVectorDataPtr ColorProcessor::computeChannelNames( const Gaff
 
 void ColorProcessor::hashChannelData( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
 {
+	if( inputTileCoverage( context ) == EmptyTile )
+	{
+		h = blackTileHash();
+		return;
+	}
+
 	ImageProcessor::hashChannelData( output, context, h );
 	h.append( context->get<std::string>( ImagePlug::channelNameContextName ) );
-	colorDataPlug()->hash( h );
+	multiChannelDataPlug()->hash( h );
 }
 
 IECore::ConstFloatVectorDataPtr ColorProcessor::computeChannelData( const std::string &channelName, const Imath::V2i &tileOrigin, const Gaffer::Context *context, const ImagePlug *parent ) const
 {
-	ConstObjectVectorPtr colorData = staticPointerCast<const ObjectVector>( colorDataPlug()->getValue() );
-	if( channelName == "R" )
+	// Tiles outside the data window would be ignored anyway, so we
+	// avoid processing the colour data for them.
+	if( inputTileCoverage( context ) == EmptyTile )
 	{
-		return staticPointerCast<const FloatVectorData>( colorData->members()[0] );
+		return ImagePlug::blackTile();
 	}
-	else if( channelName == "G" )
-	{
-		return staticPointerCast<const FloatVectorData>( colorData->members()[1] );
-	}
-	else if( channelName == "B" )
-	{
-		return staticPointerCast<const FloatVectorData>( colorData->members()[2] );
-	}
-	// We're not allowed to return NULL, but we should never get here because channelEnabled()
-	// should be preventing it.
-	return NULL;
+
+	return multiChannelData( channelName );
 }
 
 bool ColorProcessor::affectsColorData( const Gaffer::Plug *input ) const
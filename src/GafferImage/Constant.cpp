@@ -111,6 +111,7 @@ void Constant::hashFormat( const GafferImage::ImagePlug *output, const Gaffer::C
 {
 	ImageNode::hashFormat( output, context, h );
 	h.append( formatPlug()->hash() );
+	h.append( ImagePlug::lod( context ) );
 }
 
 void Constant::hashChannelNames( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
@@ -122,6 +123,7 @@ void Constant::hashDataWindow( const GafferImage::ImagePlug *output, const Gaffe
 {
 	ImageNode::hashDataWindow( output, context, h );
 	h.append( formatPlug()->hash() );
+	h.append( ImagePlug::lod( context ) );
 }
 
 void Constant::hashChannelData( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
@@ -135,12 +137,12 @@ void Constant::hashChannelData( const GafferImage::ImagePlug *output, const Gaff
 
 GafferImage::Format Constant::computeFormat( const Gaffer::Context *context, const ImagePlug *parent ) const
 {
-	return formatPlug()->getValue();
+	return ImagePlug::lodFormat( formatPlug()->getValue(), ImagePlug::lod( context ) );
 }
 
 Imath::Box2i Constant::computeDataWindow( const Gaffer::Context *context, const ImagePlug *parent ) const
 {
-	return formatPlug()->getValue().getDisplayWindow();
+	return ImagePlug::lodWindow( formatPlug()->getValue().getDisplayWindow(), ImagePlug::lod( context ) );
 }
 
 IECore::ConstStringVectorDataPtr Constant::computeChannelNames( const Gaffer::Context *context, const ImagePlug *parent ) const
@@ -156,18 +158,8 @@ IECore::ConstStringVectorDataPtr Constant::computeChannelNames( const Gaffer::Co
 
 IECore::ConstFloatVectorDataPtr Constant::computeChannelData( const std::string &channelName, const Imath::V2i &tileOrigin, const Gaffer::Context *context, const ImagePlug *parent ) const
 {
-	FloatVectorDataPtr resultData = new FloatVectorData;
-	vector<float> &result = resultData->writable();
-	result.resize( ImagePlug::tileSize() * ImagePlug::tileSize() );
-	
 	int idx = channelName == "R" ? 0 : channelName == "G" ? 1 : channelName == "B" ? 2 : 3;
 	const float v = colorPlug()->getValue()[idx];
 	
-	float *ptr = &result[0];
-	for( int i = 0; i < ImagePlug::tileSize() * ImagePlug::tileSize(); i++ )
-	{
-		*ptr++ = v;
-	}
-	
-	return resultData;
+	return ImagePlug::constantTile( v );
 }
@@ -34,10 +34,20 @@
 //  
 //////////////////////////////////////////////////////////////////////////
 
+#include <set>
+
 #include "boost/bind.hpp"
 #include "boost/bind/placeholders.hpp"
 #include "boost/lexical_cast.hpp"
 #include "boost/multi_array.hpp"
+#include "boost/noncopyable.hpp"
+#include "boost/thread/thread.hpp"
+#include "boost/thread/mutex.hpp"
+#include "boost/thread/condition_variable.hpp"
+
+#include "tbb/atomic.h"
+#include "tbb/spin_mutex.h"
+#include "tbb/tick_count.h"
 
 #include "IECore/LRUCache.h"
 #include "IECore/DisplayDriverServer.h"
@@ -71,6 +81,12 @@ static DisplayDriverServerPtr cacheGetter( int key, size_t &cost )
 
 static DisplayDriverServerCache g_serverCache( cacheGetter, 10 );
 
+// Used to give each driver a unique id, so that tile hashes from one
+// render can never be confused with those from another.
+static tbb::atomic<size_t> g_driverCount;
+
+static double g_updateInterval = 0.1;
+
 //////////////////////////////////////////////////////////////////////////
 // Implementation of a DisplayDriver to support the node itself
 //////////////////////////////////////////////////////////////////////////
@@ -89,7 +105,8 @@ class GafferDisplayDriver : public IECore::DisplayDriver
 			const vector<string> &channelNames, ConstCompoundDataPtr parameters )
 			:	DisplayDriver( displayWindow, dataWindow, channelNames, parameters ),
 				m_gafferFormat( displayWindow, 1 ),
-				m_gafferDataWindow( m_gafferFormat.yDownToFormatSpace( dataWindow ) )
+				m_gafferDataWindow( m_gafferFormat.yDownToFormatSpace( dataWindow ) ),
+				m_id( g_driverCount++ )
 		{
 			const V2i dataWindowMinTileIndex = ImagePlug::tileOrigin( m_gafferDataWindow.min ) / ImagePlug::tileSize();
 			const V2i dataWindowMaxTileIndex = ImagePlug::tileOrigin( m_gafferDataWindow.max ) / ImagePlug::tileSize();
@@ -129,28 +146,42 @@ class GafferDisplayDriver : public IECore::DisplayDriver
 			Box2i yUpBox = m_gafferFormat.yDownToFormatSpace( box );
 			const V2i boxMinTileOrigin = ImagePlug::tileOrigin( yUpBox.min );
 			const V2i boxMaxTileOrigin = ImagePlug::tileOrigin( yUpBox.max );
+			const int numChannels = channelNames().size();
 			for( int tileOriginY = boxMinTileOrigin.y; tileOriginY <= boxMaxTileOrigin.y; tileOriginY += ImagePlug::tileSize() )
 			{
 				for( int tileOriginX = boxMinTileOrigin.x; tileOriginX <= boxMaxTileOrigin.x; tileOriginX += ImagePlug::tileSize() )
 				{
-					for( int channelIndex = 0, numChannels = channelNames().size(); channelIndex < numChannels; ++channelIndex )
+					const V2i tileOrigin( tileOriginX, tileOriginY );
+					if( !inDataWindow( tileOrigin ) )
 					{
-						const V2i tileOrigin( tileOriginX, tileOriginY );
-						ConstFloatVectorDataPtr tileData = getTile( tileOrigin, channelIndex );
-						if( !tileData )
+						// we've been sent data outside of the data window
+						continue;
+					}
+
+					const Box2i tileBound( tileOrigin, tileOrigin + Imath::V2i( GafferImage::ImagePlug::tileSize() - 1 ) );
+					const Box2i transferBound = IECore::boxIntersection( tileBound, yUpBox );
+					const V2i tileIndex = tileOrigin / ImagePlug::tileSize();
+
+					// we hold the write lock while updating the tiles, so that no
+					// other thread can take a reference to a tile which we are
+					// modifying in place.
+					tbb::spin_rw_mutex::scoped_lock tileLock( m_tileMutex, true /* write */ );
+					for( int channelIndex = 0; channelIndex < numChannels; ++channelIndex )
+					{
+						Tile &tile = m_tiles[tileIndex.x][tileIndex.y][channelIndex];
+						if( !tile.data )
 						{
-							// we've been sent data outside of the data window
-							continue;
+							tile.data = new FloatVectorData( vector<float>( ImagePlug::tileSize() * ImagePlug::tileSize(), 0.0f ) );
 						}
+						else if( tile.data->refCount() > 1 )
+						{
+							// the tile might well have been returned from computeChannelData
+							// and be being held in the cache, so we must create a new object
+							// to hold the updated data rather than modify it in place.
+							tile.data = tile.data->copy();
+						}
+						vector<float> &updatedTile = tile.data->writable();
 						
-						// we must create a new object to hold the updated tile data,
-						// because the old one might well have been returned from
-						// computeChannelData and be being held in the cache.
-						FloatVectorDataPtr updatedTileData = tileData->copy();
-						vector<float> &updatedTile = updatedTileData->writable();
-						
-						const Box2i tileBound( tileOrigin, tileOrigin + Imath::V2i( GafferImage::ImagePlug::tileSize() - 1 ) );
-						const Box2i transferBound = IECore::boxIntersection( tileBound, yUpBox );
 						for( int y = transferBound.min.y; y<=transferBound.max.y; ++y )
 						{
 							int srcY = m_gafferFormat.formatToYDownSpace( y );
@@ -165,16 +196,18 @@ class GafferDisplayDriver : public IECore::DisplayDriver
 							}
 						}
 						
-						setTile( tileOrigin, channelIndex, updatedTileData );
+						tile.version++;
 					}
 				}
 			}
 			
-			dataReceivedSignal()( this, box );
+			updateReceived( yUpBox, false );
 		}
 		
 		virtual void imageClose()
 		{
+			updateReceived( Box2i(), true );
+			unschedulePendingUpdate( this );
 			imageReceivedSignal()( this );
 		}
 
@@ -196,7 +229,8 @@ class GafferDisplayDriver : public IECore::DisplayDriver
 				return ImagePlug::blackTile();
 			}
 			
-			ConstFloatVectorDataPtr tile = getTile( tileOrigin, cIt - channelNames().begin() );
+			unsigned version;
+			ConstFloatVectorDataPtr tile = getTile( tileOrigin, cIt - channelNames().begin(), version );
 			if( tile )
 			{
 				return tile;
@@ -206,6 +240,31 @@ class GafferDisplayDriver : public IECore::DisplayDriver
 				return ImagePlug::blackTile();
 			}
 		}
+
+		/// Computes the hash for channelData() from the version of the tile
+		/// rather than from its contents. This is much cheaper, and each update
+		/// increments the version only for the tiles it touches, so the hashes
+		/// of all other tiles remain unchanged.
+		void channelDataHash( const Imath::V2i &tileOrigin, const std::string &channelName, IECore::MurmurHash &h )
+		{
+			vector<string>::const_iterator cIt = find( channelNames().begin(), channelNames().end(), channelName );
+			unsigned version = 0;
+			if( cIt != channelNames().end() )
+			{
+				getTile( tileOrigin, cIt - channelNames().begin(), version );
+			}
+
+			if( !version )
+			{
+				h = ImagePlug::blackTile()->Object::hash();
+				return;
+			}
+
+			h.append( m_id );
+			h.append( tileOrigin );
+			h.append( (int)( cIt - channelNames().begin() ) );
+			h.append( version );
+		}
 		
 		typedef boost::signal<void ( GafferDisplayDriver *, const Imath::Box2i & )> DataReceivedSignal;
 		DataReceivedSignal &dataReceivedSignal()
@@ -230,47 +289,137 @@ class GafferDisplayDriver : public IECore::DisplayDriver
 	
 		static const DisplayDriverDescription<GafferDisplayDriver> g_description;
 
-		ConstFloatVectorDataPtr getTile( const V2i &tileOrigin, size_t channelIndex )
+		// Accumulates the region which has been updated, emitting dataReceivedSignal()
+		// for the accumulated region no more often than Display::getUpdateInterval()
+		// allows. This avoids flooding the ui with an update per bucket. Updates which
+		// are held back are emitted by a later bucket, by imageClose(), or failing
+		// both, by the pending update thread once the interval has passed.
+		void updateReceived( const Box2i &region, bool flush )
+		{
+			Box2i updatedRegion;
+			bool pending = false;
+			{
+				tbb::spin_mutex::scoped_lock lock( m_updateMutex );
+				m_updatedRegion.extendBy( region );
+				const tbb::tick_count now = tbb::tick_count::now();
+				if( flush || ( now - m_lastUpdateTime ).seconds() >= Display::getUpdateInterval() )
+				{
+					updatedRegion = m_updatedRegion;
+					m_updatedRegion = Box2i();
+					m_lastUpdateTime = now;
+				}
+				else
+				{
+					pending = !m_updatedRegion.isEmpty();
+				}
+			}
+
+			if( !updatedRegion.isEmpty() )
+			{
+				dataReceivedSignal()( this, updatedRegion );
+			}
+			else if( pending )
+			{
+				schedulePendingUpdate( this );
+			}
+		}
+
+		// Emits any pending update if the update interval has passed, returning
+		// true if an update is still pending.
+		bool flushPendingUpdate()
+		{
+			Box2i updatedRegion;
+			{
+				tbb::spin_mutex::scoped_lock lock( m_updateMutex );
+				if( m_updatedRegion.isEmpty() )
+				{
+					return false;
+				}
+				const tbb::tick_count now = tbb::tick_count::now();
+				if( ( now - m_lastUpdateTime ).seconds() < Display::getUpdateInterval() )
+				{
+					return true;
+				}
+				updatedRegion = m_updatedRegion;
+				m_updatedRegion = Box2i();
+				m_lastUpdateTime = now;
+			}
+
+			dataReceivedSignal()( this, updatedRegion );
+			return false;
+		}
+
+		// A single thread, shared by all drivers, flushes the pending updates of
+		// drivers which have stopped receiving buckets without being closed - as
+		// happens when a render is paused, or an interactive render has converged.
+		// It holds a reference to each driver with a pending update, so drivers are
+		// never destroyed while they are in its care. The thread is owned by a single
+		// PendingUpdates instance, which stops and joins it when destroyed at exit.
+		class PendingUpdates;
+		static PendingUpdates &pendingUpdates();
+		static void schedulePendingUpdate( GafferDisplayDriver *driver );
+		static void unschedulePendingUpdate( GafferDisplayDriver *driver );
+
+		bool inDataWindow( const V2i &tileOrigin ) const
 		{
 			V2i tileIndex = tileOrigin / ImagePlug::tileSize();
-			
-			if(
-				tileIndex.x < m_tiles.index_bases()[0] ||
-				tileIndex.x >= (int)(m_tiles.index_bases()[0] + m_tiles.shape()[0] ) ||
-				tileIndex.y < m_tiles.index_bases()[1] ||
-				tileIndex.y >= (int)(m_tiles.index_bases()[1] + m_tiles.shape()[1] )
-			)
+			return
+				tileIndex.x >= m_tiles.index_bases()[0] &&
+				tileIndex.x < (int)(m_tiles.index_bases()[0] + m_tiles.shape()[0] ) &&
+				tileIndex.y >= m_tiles.index_bases()[1] &&
+				tileIndex.y < (int)(m_tiles.index_bases()[1] + m_tiles.shape()[1] );
+		}
+
+		// Returns NULL if the tile is outside the data window, and the black tile
+		// if no data has been received for it yet. Version is set to the number of
+		// times the tile has been updated.
+		ConstFloatVectorDataPtr getTile( const V2i &tileOrigin, size_t channelIndex, unsigned &version )
+		{
+			version = 0;
+			if( !inDataWindow( tileOrigin ) )
 			{
 				// outside data window
 				return NULL;
 			}
 			
+			V2i tileIndex = tileOrigin / ImagePlug::tileSize();
 			tbb::spin_rw_mutex::scoped_lock tileLock( m_tileMutex, false /* read */ );
 			
-			ConstFloatVectorDataPtr result = m_tiles[tileIndex.x][tileIndex.y][channelIndex];
-			if( !result )
+			const Tile &tile = m_tiles[tileIndex.x][tileIndex.y][channelIndex];
+			version = tile.version;
+			if( !tile.data )
 			{
-				result = ImagePlug::blackTile();
+				return ImagePlug::blackTile();
 			}
 			
-			return result;
+			return tile.data;
 		}
-		
-		void setTile( const V2i &tileOrigin, size_t channelIndex, ConstFloatVectorDataPtr tile )
+
+		struct Tile
 		{
-			V2i tileIndex = tileOrigin / ImagePlug::tileSize();
-			tbb::spin_rw_mutex::scoped_lock tileLock( m_tileMutex, true /* write */ );
-			m_tiles[tileIndex.x][tileIndex.y][channelIndex] = tile;
-		}
+			Tile()
+				:	version( 0 )
+			{
+			}
+
+			// we only ever hand out const references to the data, and
+			// only modify it in place when we hold the sole reference.
+			FloatVectorDataPtr data;
+			unsigned version;
+		};
 
 		// indexed by tileIndexX, tileIndexY, channelIndex.
-		typedef boost::multi_array<ConstFloatVectorDataPtr, 3> TileArray;
+		typedef boost::multi_array<Tile, 3> TileArray;
 		TileArray m_tiles;
 		tbb::spin_rw_mutex m_tileMutex;
 
 		Format m_gafferFormat;
 		Imath::Box2i m_gafferDataWindow;
 		IECore::ConstCompoundDataPtr m_parameters;
+		size_t m_id;
+		tbb::spin_mutex m_updateMutex;
+		Box2i m_updatedRegion;
+		tbb::tick_count m_lastUpdateTime;
 		DataReceivedSignal m_dataReceivedSignal;
 		ImageReceivedSignal m_imageReceivedSignal;
 
@@ -278,6 +427,126 @@ class GafferDisplayDriver : public IECore::DisplayDriver
 
 const DisplayDriver::DisplayDriverDescription<GafferDisplayDriver> GafferDisplayDriver::g_description;
 
+class GafferDisplayDriver::PendingUpdates : boost::noncopyable
+{
+
+	public :
+
+		PendingUpdates()
+			:	m_stop( false )
+		{
+		}
+
+		~PendingUpdates()
+		{
+			{
+				boost::lock_guard<boost::mutex> lock( m_mutex );
+				m_stop = true;
+			}
+			m_condition.notify_all();
+			if( m_thread.joinable() )
+			{
+				m_thread.join();
+			}
+		}
+
+		void schedule( GafferDisplayDriver *driver )
+		{
+			boost::lock_guard<boost::mutex> lock( m_mutex );
+			if( m_stop )
+			{
+				return;
+			}
+
+			if( !m_thread.joinable() )
+			{
+				boost::thread thread( boost::bind( &PendingUpdates::run, this ) );
+				m_thread.swap( thread );
+			}
+
+			if( m_drivers.insert( driver ).second )
+			{
+				m_condition.notify_one();
+			}
+		}
+
+		void unschedule( GafferDisplayDriver *driver )
+		{
+			// Removing the driver may drop the last reference to it, so we
+			// must not destroy it while holding the lock.
+			GafferDisplayDriverPtr driverPtr = driver;
+			boost::lock_guard<boost::mutex> lock( m_mutex );
+			m_drivers.erase( driverPtr );
+		}
+
+	private :
+
+		typedef std::set<GafferDisplayDriverPtr> Drivers;
+
+		void run()
+		{
+			boost::unique_lock<boost::mutex> lock( m_mutex );
+			while( !m_stop )
+			{
+				if( m_drivers.empty() )
+				{
+					m_condition.wait( lock );
+					continue;
+				}
+
+				// Give further buckets a chance to arrive, and then flush whatever
+				// has been waiting for at least the update interval.
+				const double interval = std::max( Display::getUpdateInterval(), 0.01 );
+				m_condition.timed_wait( lock, boost::posix_time::microseconds( (long)( interval * 1000000.0 ) ) );
+				if( m_stop )
+				{
+					break;
+				}
+
+				Drivers drivers;
+				drivers.swap( m_drivers );
+				lock.unlock();
+
+				Drivers stillPending;
+				for( Drivers::const_iterator it = drivers.begin(), eIt = drivers.end(); it != eIt; ++it )
+				{
+					if( (*it)->flushPendingUpdate() )
+					{
+						stillPending.insert( *it );
+					}
+				}
+				drivers.clear();
+
+				lock.lock();
+				m_drivers.insert( stillPending.begin(), stillPending.end() );
+				stillPending.clear();
+			}
+		}
+
+		boost::mutex m_mutex;
+		boost::condition_variable m_condition;
+		Drivers m_drivers;
+		bool m_stop;
+		boost::thread m_thread;
+
+};
+
+GafferDisplayDriver::PendingUpdates &GafferDisplayDriver::pendingUpdates()
+{
+	static PendingUpdates g_pendingUpdates;
+	return g_pendingUpdates;
+}
+
+void GafferDisplayDriver::schedulePendingUpdate( GafferDisplayDriver *driver )
+{
+	pendingUpdates().schedule( driver );
+}
+
+void GafferDisplayDriver::unschedulePendingUpdate( GafferDisplayDriver *driver )
+{
+	pendingUpdates().unschedule( driver );
+}
+
 } // namespace GafferImage
 
 //////////////////////////////////////////////////////////////////////////
@@ -365,6 +634,16 @@ void Display::affects( const Gaffer::Plug *input, AffectedPlugsContainer &output
 	}
 }
 
+void Display::setUpdateInterval( double seconds )
+{
+	g_updateInterval = seconds;
+}
+
+double Display::getUpdateInterval()
+{
+	return g_updateInterval;
+}
+
 Node::UnaryPlugSignal &Display::dataReceivedSignal()
 {
 	static UnaryPlugSignal s;
@@ -457,15 +736,18 @@ Imath::Box2i Display::computeDataWindow( const Gaffer::Context *context, const I
 
 void Display::hashChannelData( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
 {
-	ConstFloatVectorDataPtr channelData = ImagePlug::blackTile();
 	if( m_driver )
 	{
-		channelData = m_driver->channelData(
+		m_driver->channelDataHash(
 			context->get<Imath::V2i>( ImagePlug::tileOriginContextName ),
-			context->get<std::string>( ImagePlug::channelNameContextName )
+			context->get<std::string>( ImagePlug::channelNameContextName ),
+			h
 		);
 	}
-	h = channelData->Object::hash();
+	else
+	{
+		h = ImagePlug::blackTile()->Object::hash();
+	}
 }
 
 IECore::ConstFloatVectorDataPtr Display::computeChannelData( const std::string &channelName, const Imath::V2i &tileOrigin, const Gaffer::Context *context, const ImagePlug *parent ) const
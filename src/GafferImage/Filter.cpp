@@ -86,6 +86,46 @@ FilterPtr Filter::create( const std::string &name, float scale )
 	return 0; // We should never get here.
 }
 
+Filter::KernelBank::KernelBank( const Filter *filter, int phases )
+	:	m_width( filter->width() ),
+		m_stride( ( ( filter->width() + SIMD::Float::width - 1 ) / SIMD::Float::width ) * SIMD::Float::width ),
+		m_phases( phases ),
+		m_scaledRadius( filter->m_scaledRadius )
+{
+	// We store phases + 1 kernels, so that a phase which rounds up to a whole
+	// pixel needn't wrap around to the first kernel and the next tap.
+	m_weights.resize( ( m_phases + 1 ) * m_stride, 0.0f );
+	for( int phase = 0; phase <= m_phases; ++phase )
+	{
+		// A center whose first tap is pixel 0.
+		const float center = m_scaledRadius + float( phase ) / m_phases;
+		float *weights = &(m_weights[phase * m_stride]);
+		float weightedSum = 0.0f;
+		for( int i = 0; i < m_width; ++i )
+		{
+			weights[i] = filter->weight( center, i );
+			weightedSum += weights[i];
+		}
+
+		if( weightedSum != 0.0f )
+		{
+			for( int i = 0; i < m_width; ++i )
+			{
+				weights[i] /= weightedSum;
+			}
+		}
+	}
+}
+
+Filter::ConstKernelBankPtr Filter::kernelBank( int phases ) const
+{
+	if( phases < 1 )
+	{
+		throw IECore::Exception( "Number of phases must be greater than 0." );
+	}
+	return new KernelBank( this, phases );
+}
+
 // Register all of the filters against their names.
 Filter::FilterRegistration<BoxFilter> BoxFilter::m_registration( "Box" );
 Filter::FilterRegistration<BSplineFilter> BSplineFilter::m_registration( "BSpline" );
@@ -243,8 +243,7 @@ void Grade::hashChannelData( const GafferImage::ImagePlug *output, const Gaffer:
 
 void Grade::processChannelData( const Gaffer::Context *context, const ImagePlug *parent, const std::string &channel, FloatVectorDataPtr outData ) const
 {
-	// Calculate the valid data window that we are to merge.
-	const int dataWidth = ImagePlug::tileSize()*ImagePlug::tileSize();
+	const int dataWidth = outData->readable().size();
 
 	// Do some pre-processing.
 	float A, B, gamma;
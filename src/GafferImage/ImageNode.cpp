@@ -35,6 +35,8 @@
 //  
 //////////////////////////////////////////////////////////////////////////
 
+#include "boost/format.hpp"
+
 #include "Gaffer/Context.h"
 #include "Gaffer/ScriptNode.h"
 
@@ -56,6 +58,7 @@ ImageNode::ImageNode( const std::string &name )
 	storeIndexOfNextChild( g_firstPlugIndex );
 	addChild( new ImagePlug( "out", Gaffer::Plug::Out ) );
 	addChild( new BoolPlug( "enabled", Gaffer::Plug::In, true ) );
+	addChild( new ObjectPlug( "__multiChannelData", Gaffer::Plug::Out, new CompoundObject ) );
 }
 
 ImageNode::~ImageNode()
@@ -82,6 +85,16 @@ const BoolPlug *ImageNode::enabledPlug() const
 	return getChild<BoolPlug>( g_firstPlugIndex + 1 );
 }
 
+ObjectPlug *ImageNode::multiChannelDataPlug()
+{
+	return getChild<ObjectPlug>( g_firstPlugIndex + 2 );
+}
+
+const ObjectPlug *ImageNode::multiChannelDataPlug() const
+{
+	return getChild<ObjectPlug>( g_firstPlugIndex + 2 );
+}
+
 bool ImageNode::enabled() const
 {
 	return enabledPlug()->getValue();
@@ -125,6 +138,10 @@ void ImageNode::hash( const Gaffer::ValuePlug *output, const Gaffer::Context *co
 	else
 	{
 		ComputeNode::hash( output, context, h );	
+		if( output == multiChannelDataPlug() )
+		{
+			hashMultiChannelData( context->get<V2i>( ImagePlug::tileOriginContextName ), context, h );
+		}
 	}
 }
 
@@ -148,6 +165,27 @@ void ImageNode::hashChannelData( const GafferImage::ImagePlug *parent, const Gaf
 	ComputeNode::hash( parent->channelDataPlug(), context, h );
 }
 
+void ImageNode::hashMultiChannelData( const Imath::V2i &tileOrigin, const Gaffer::Context *context, IECore::MurmurHash &h ) const
+{
+	h.append( tileOrigin );
+}
+
+IECore::ConstCompoundObjectPtr ImageNode::computeMultiChannelData( const Imath::V2i &tileOrigin, const Gaffer::Context *context ) const
+{
+	return new CompoundObject;
+}
+
+IECore::ConstFloatVectorDataPtr ImageNode::multiChannelData( const std::string &channelName ) const
+{
+	ConstCompoundObjectPtr multiChannelData = staticPointerCast<const CompoundObject>( multiChannelDataPlug()->getValue() );
+	const FloatVectorData *channelData = multiChannelData->member<FloatVectorData>( channelName );
+	if( !channelData )
+	{
+		throw Exception( boost::str( boost::format( "Channel \"%s\" was not computed by computeMultiChannelData()" ) % channelName ) );
+	}
+	return channelData;
+}
+
 void ImageNode::parentChanging( Gaffer::GraphComponent *newParent )
 {
 	// Initialise the default format and setup any format knobs that are on this node.
@@ -165,6 +203,14 @@ void ImageNode::parentChanging( Gaffer::GraphComponent *newParent )
 
 void ImageNode::compute( ValuePlug *output, const Context *context ) const
 {
+	if( output == multiChannelDataPlug() )
+	{
+		static_cast<ObjectPlug *>( output )->setValue(
+			computeMultiChannelData( context->get<V2i>( ImagePlug::tileOriginContextName ), context )
+		);
+		return;
+	}
+
 	ImagePlug *imagePlug = output->parent<ImagePlug>();
 	if( !imagePlug )
 	{
@@ -233,4 +279,8 @@ void ImageNode::affects( const Gaffer::Plug *input, AffectedPlugsContainer &outp
 			outputs.push_back( it->get() );
 		}
 	}
+	else if( input == multiChannelDataPlug() )
+	{
+		outputs.push_back( outPlug()->channelDataPlug() );
+	}
 }
@@ -40,6 +40,7 @@
 #include "IECore/Exception.h"
 #include "IECore/BoxOps.h"
 #include "IECore/BoxAlgo.h"
+#include "IECore/LRUCache.h"
 
 #include "Gaffer/Context.h"
 
@@ -56,89 +57,187 @@ using namespace tbb;
 IE_CORE_DEFINERUNTIMETYPED( ImagePlug );
 
 //////////////////////////////////////////////////////////////////////////
-// Implementation of CopyTiles:
-// A simple class for multithreading the copying of
-// image tiles from an input plug to an output plug.
+// Utilities for processing every channel of every tile of an image in a
+// single parallel loop.
 //////////////////////////////////////////////////////////////////////////
 
-namespace GafferImage
+namespace
 {
 
-namespace Detail
+// Maps work items onto ( channel, tile ) pairs. Work items are indexed as
+// ( channelIndex * numTilesY + tileIndexY ) * numTilesX + tileIndexX, so
+// the tiles of each channel are contiguous, and are ordered in rows
+// starting from the bottom left of the data window.
+class TileIndexer
 {
 
-class CopyTiles
+	public :
+
+		TileIndexer( const Box2i &dataWindow, size_t numChannels )
+			:	m_numTilesX( 0 ), m_numTilesY( 0 ), m_numChannels( numChannels )
+		{
+			if( !dataWindow.isEmpty() )
+			{
+				m_minTileOrigin = ImagePlug::tileOrigin( dataWindow.min );
+				const V2i maxTileOrigin = ImagePlug::tileOrigin( dataWindow.max );
+				m_numTilesX = ( maxTileOrigin.x - m_minTileOrigin.x ) / ImagePlug::tileSize() + 1;
+				m_numTilesY = ( maxTileOrigin.y - m_minTileOrigin.y ) / ImagePlug::tileSize() + 1;
+			}
+		}
+
+		size_t numWorkItems() const
+		{
+			return m_numTilesX * m_numTilesY * m_numChannels;
+		}
+
+		size_t channelIndex( size_t workItem ) const
+		{
+			return workItem / ( m_numTilesX * m_numTilesY );
+		}
+
+		V2i tileOrigin( size_t workItem ) const
+		{
+			const size_t tileIndex = workItem % ( m_numTilesX * m_numTilesY );
+			return V2i(
+				m_minTileOrigin.x + ( tileIndex % m_numTilesX ) * ImagePlug::tileSize(),
+				m_minTileOrigin.y + ( tileIndex / m_numTilesX ) * ImagePlug::tileSize()
+			);
+		}
+
+	private :
+
+		V2i m_minTileOrigin;
+		size_t m_numTilesX;
+		size_t m_numTilesY;
+		size_t m_numChannels;
+
+};
+
+// Computes the hash of each work item, so that they can then be
+// combined serially in a deterministic order.
+class TileHasher
 {
-	public:
-		CopyTiles(
-				const vector<float *> &imageChannelData,
-				const vector<string> &channelNames,
-				const Gaffer::FloatVectorDataPlug *channelDataPlug,
-				const Box2i& dataWindow,
-				const Context *context, const int tileSize
-			) :
-				m_imageChannelData( imageChannelData ),
-				m_channelNames( channelNames ),
-				m_channelDataPlug( channelDataPlug ),
-				m_dataWindow( dataWindow ),
-				m_parentContext( context ),
-				m_tileSize( tileSize )
-		{}
 
-		void operator()( const blocked_range2d<size_t>& r ) const
+	public :
+
+		TileHasher( const ImagePlug *plug, const vector<string> &channelNames, const TileIndexer &indexer, const Context *context, vector<MurmurHash> &hashes )
+			:	m_plug( plug ), m_channelNames( channelNames ), m_indexer( indexer ), m_parentContext( context ), m_hashes( hashes )
 		{
-			ContextPtr context = new Context( *m_parentContext );
-			const Box2i operationWindow( V2i( r.rows().begin()+m_dataWindow.min.x, r.cols().begin()+m_dataWindow.min.y ), V2i( r.rows().end()+m_dataWindow.min.x-1, r.cols().end()+m_dataWindow.min.y-1 ) );
-			V2i minTileOrigin = ImagePlug::tileOrigin( operationWindow.min );
-			V2i maxTileOrigin = ImagePlug::tileOrigin( operationWindow.max );
-			size_t imageStride = m_dataWindow.size().x + 1;
+		}
 
-			for( int tileOriginY = minTileOrigin.y; tileOriginY <= maxTileOrigin.y; tileOriginY += m_tileSize )
+		void operator()( const blocked_range<size_t> &r ) const
+		{
+			ContextPtr context = new Context( *m_parentContext, Context::Borrowed );
+			for( size_t i = r.begin(); i != r.end(); ++i )
 			{
-				for( int tileOriginX = minTileOrigin.x; tileOriginX <= maxTileOrigin.x; tileOriginX += m_tileSize )
+				context->set( ImagePlug::channelNameContextName, m_channelNames[m_indexer.channelIndex( i )] );
+				context->set( ImagePlug::tileOriginContextName, m_indexer.tileOrigin( i ) );
+				Context::Scope scope( context );
+				m_hashes[i] = m_plug->channelDataPlug()->hash();
+			}
+		}
+
+	private :
+
+		const ImagePlug *m_plug;
+		const vector<string> &m_channelNames;
+		const TileIndexer &m_indexer;
+		const Context *m_parentContext;
+		vector<MurmurHash> &m_hashes;
+
+};
+
+// Computes the tile for each work item, storing it without copying.
+class TileFetcher
+{
+
+	public :
+
+		TileFetcher( const ImagePlug *plug, const vector<string> &channelNames, const TileIndexer &indexer, const Context *context, vector<ConstFloatVectorDataPtr> &tiles )
+			:	m_plug( plug ), m_channelNames( channelNames ), m_indexer( indexer ), m_parentContext( context ), m_tiles( tiles )
+		{
+		}
+
+		void operator()( const blocked_range<size_t> &r ) const
+		{
+			ContextPtr context = new Context( *m_parentContext, Context::Borrowed );
+			for( size_t i = r.begin(); i != r.end(); ++i )
+			{
+				context->set( ImagePlug::channelNameContextName, m_channelNames[m_indexer.channelIndex( i )] );
+				context->set( ImagePlug::tileOriginContextName, m_indexer.tileOrigin( i ) );
+				Context::Scope scope( context );
+				m_tiles[i] = m_plug->channelDataPlug()->getValue();
+			}
+		}
+
+	private :
+
+		const ImagePlug *m_plug;
+		const vector<string> &m_channelNames;
+		const TileIndexer &m_indexer;
+		const Context *m_parentContext;
+		vector<ConstFloatVectorDataPtr> &m_tiles;
+
+};
+
+// Computes the tile for each work item and copies it into the channels
+// of an ImagePrimitive, flipping it into the Y-down space used by Cortex.
+// Tiles are released as soon as they have been copied, so the full image
+// is never held in tile form.
+class TileCopier
+{
+
+	public :
+
+		TileCopier( const ImagePlug *plug, const vector<string> &channelNames, const TileIndexer &indexer, const Box2i &dataWindow, const Context *context, const vector<float *> &imageChannelData )
+			:	m_plug( plug ), m_channelNames( channelNames ), m_indexer( indexer ), m_dataWindow( dataWindow ), m_parentContext( context ), m_imageChannelData( imageChannelData )
+		{
+		}
+
+		void operator()( const blocked_range<size_t> &r ) const
+		{
+			ContextPtr context = new Context( *m_parentContext, Context::Borrowed );
+			const size_t imageStride = m_dataWindow.size().x + 1;
+			for( size_t i = r.begin(); i != r.end(); ++i )
+			{
+				const size_t channelIndex = m_indexer.channelIndex( i );
+				const V2i tileOrigin = m_indexer.tileOrigin( i );
+				context->set( ImagePlug::channelNameContextName, m_channelNames[channelIndex] );
+				context->set( ImagePlug::tileOriginContextName, tileOrigin );
+				Context::Scope scope( context );
+
+				ConstFloatVectorDataPtr tileData = m_plug->channelDataPlug()->getValue();
+
+				const Box2i tileBound( tileOrigin, tileOrigin + V2i( ImagePlug::tileSize() - 1 ) );
+				const Box2i b = boxIntersection( tileBound, m_dataWindow );
+				for( int y = b.min.y; y <= b.max.y; ++y )
 				{
-					for( vector<string>::const_iterator it = m_channelNames.begin(), eIt = m_channelNames.end(); it != eIt; it++ )
-					{
-						context->set( ImagePlug::channelNameContextName, *it );
-						context->set( ImagePlug::tileOriginContextName, V2i( tileOriginX, tileOriginY ) );
-						Context::Scope scope( context );
-						Box2i tileBound( V2i( tileOriginX, tileOriginY ), V2i( tileOriginX + m_tileSize - 1, tileOriginY + m_tileSize - 1 ) );
-						Box2i b = boxIntersection( tileBound, operationWindow );
-
-						ConstFloatVectorDataPtr tileData = m_channelDataPlug->getValue();
-
-						for( int y = b.min.y; y<=b.max.y; y++ )
-						{
-							const float *tilePtr = &(tileData->readable()[0]) + (y - tileOriginY) * m_tileSize + (b.min.x - tileOriginX);
-							float *channelPtr = m_imageChannelData[it-m_channelNames.begin()] + ( m_dataWindow.size().y - ( y - m_dataWindow.min.y ) ) * imageStride + (b.min.x - m_dataWindow.min.x);
-							for( int x = b.min.x; x <= b.max.x; x++ )
-							{
-								*channelPtr++ = *tilePtr++;
-							}
-						}
-					}
+					const float *tilePtr = &(tileData->readable()[0]) + ( y - tileOrigin.y ) * ImagePlug::tileSize() + ( b.min.x - tileOrigin.x );
+					float *channelPtr = m_imageChannelData[channelIndex] + ( m_dataWindow.size().y - ( y - m_dataWindow.min.y ) ) * imageStride + ( b.min.x - m_dataWindow.min.x );
+					std::copy( tilePtr, tilePtr + ( b.max.x - b.min.x + 1 ), channelPtr );
 				}
 			}
 		}
-		
-	private:
-		const vector<float *> &m_imageChannelData;
+
+	private :
+
+		const ImagePlug *m_plug;
 		const vector<string> &m_channelNames;
-		const Gaffer::FloatVectorDataPlug *m_channelDataPlug;
+		const TileIndexer &m_indexer;
 		const Box2i &m_dataWindow;
 		const Context *m_parentContext;
-		const int m_tileSize;
-};
+		const vector<float *> &m_imageChannelData;
 
 };
 
-};
+} // namespace
 
 //////////////////////////////////////////////////////////////////////////
 // Implementation of ImagePlug
 //////////////////////////////////////////////////////////////////////////
 const IECore::InternedString ImagePlug::channelNameContextName = "image:channelName";
 const IECore::InternedString ImagePlug::tileOriginContextName = "image:tileOrigin";
+const IECore::InternedString ImagePlug::lodContextName = "image:lod";
 
 size_t ImagePlug::g_firstPlugIndex = 0;
 
@@ -213,6 +312,97 @@ const IECore::FloatVectorData *ImagePlug::blackTile()
 	return g_blackTile.get();
 };
 
+static IECore::ConstFloatVectorDataPtr constantTileGetter( const float &value, size_t &cost )
+{
+	cost = 1;
+	return new IECore::FloatVectorData( std::vector<float>( ImagePlug::tileSize()*ImagePlug::tileSize(), value ) );
+}
+
+typedef IECore::LRUCache<float, IECore::ConstFloatVectorDataPtr> ConstantTileCache;
+static ConstantTileCache g_constantTileCache( constantTileGetter, 1000 );
+
+IECore::ConstFloatVectorDataPtr ImagePlug::constantTile( float value )
+{
+	if( value == 0.0f )
+	{
+		return blackTile();
+	}
+	else if( value == 1.0f )
+	{
+		return whiteTile();
+	}
+	else if( value != value )
+	{
+		// NaN can't be used as a key for the cache.
+		size_t cost;
+		return constantTileGetter( value, cost );
+	}
+	return g_constantTileCache.get( value );
+}
+
+bool ImagePlug::isConstantTile( const IECore::FloatVectorData *tile, float &value )
+{
+	const std::vector<float> &data = tile->readable();
+	if( data.empty() )
+	{
+		return false;
+	}
+
+	value = data[0];
+	if( tile == blackTile() || tile == whiteTile() )
+	{
+		return true;
+	}
+
+	for( std::vector<float>::const_iterator it = data.begin() + 1, eIt = data.end(); it != eIt; ++it )
+	{
+		if( *it != value )
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int ImagePlug::lod( const Gaffer::Context *context )
+{
+	return std::max( 0, context->get<int>( lodContextName, 0 ) );
+}
+
+namespace
+{
+
+// Division rounding towards negative infinity.
+inline int floorDivide( int a, int b )
+{
+	return a >= 0 ? a / b : -( ( -a + b - 1 ) / b );
+}
+
+} // namespace
+
+Imath::Box2i ImagePlug::lodWindow( const Imath::Box2i &window, int lod )
+{
+	if( lod <= 0 || window.isEmpty() )
+	{
+		return window;
+	}
+
+	const int scale = 1 << lod;
+	return Box2i(
+		V2i( floorDivide( window.min.x, scale ), floorDivide( window.min.y, scale ) ),
+		V2i( floorDivide( window.max.x, scale ), floorDivide( window.max.y, scale ) )
+	);
+}
+
+Format ImagePlug::lodFormat( const Format &format, int lod )
+{
+	if( lod <= 0 )
+	{
+		return format;
+	}
+	return Format( lodWindow( format.getDisplayWindow(), lod ), format.getPixelAspect() );
+}
+
 bool ImagePlug::acceptsChild( const GraphComponent *potentialChild ) const
 {
 	return children().size() != 4;
@@ -330,8 +520,11 @@ IECore::ImagePrimitivePtr ImagePlug::image() const
 		imageChannelData.push_back( &(c[0]) );
 	}
 	
-	parallel_for( blocked_range2d<size_t>( 0, dataWindow.size().x+1, tileSize(), 0, dataWindow.size().y+1, tileSize() ),
-		      GafferImage::Detail::CopyTiles( imageChannelData, channelNames, channelDataPlug(), dataWindow, Context::current(), tileSize()) );
+	const TileIndexer indexer( dataWindow, channelNames.size() );
+	parallel_for(
+		blocked_range<size_t>( 0, indexer.numWorkItems() ),
+		TileCopier( this, channelNames, indexer, dataWindow, Context::current(), imageChannelData )
+	);
 	
 	return result;
 }
@@ -346,26 +539,30 @@ IECore::MurmurHash ImagePlug::imageHash() const
 	result.append( dataWindowPlug()->hash() );
 	result.append( channelNamesPlug()->hash() );
 
-	V2i minTileOrigin = tileOrigin( dataWindow.min );
-	V2i maxTileOrigin = tileOrigin( dataWindow.max );
+	// Compute the tile hashes in parallel, and then combine them
+	// serially so that the result doesn't depend on scheduling.
+	const TileIndexer indexer( dataWindow, channelNames.size() );
+	vector<MurmurHash> tileHashes( indexer.numWorkItems() );
+	parallel_for(
+		blocked_range<size_t>( 0, tileHashes.size() ),
+		TileHasher( this, channelNames, indexer, Context::current(), tileHashes )
+	);
 
-	ContextPtr context = new Context( *Context::current(), Context::Borrowed );
-	for( vector<string>::const_iterator it = channelNames.begin(), eIt = channelNames.end(); it!=eIt; it++ )
+	for( vector<MurmurHash>::const_iterator it = tileHashes.begin(), eIt = tileHashes.end(); it != eIt; ++it )
 	{
-		for( int tileOriginY = minTileOrigin.y; tileOriginY<=maxTileOrigin.y; tileOriginY += tileSize() )
-		{
-			for( int tileOriginX = minTileOrigin.x; tileOriginX<=maxTileOrigin.x; tileOriginX += tileSize() )
-			{
-				for( vector<string>::const_iterator it = channelNames.begin(), eIt = channelNames.end(); it!=eIt; it++ )
-				{
-					context->set( ImagePlug::channelNameContextName, *it );
-					context->set( ImagePlug::tileOriginContextName, V2i( tileOriginX, tileOriginY ) );
-					Context::Scope scope( context );
-					channelDataPlug()->hash( result );
-				}
-			}
-		}
+		result.append( *it );
 	}
 	
 	return result;
 }
+
+void ImagePlug::tiles( const std::vector<std::string> &channelNames, std::vector<IECore::ConstFloatVectorDataPtr> &tiles ) const
+{
+	const TileIndexer indexer( dataWindowPlug()->getValue(), channelNames.size() );
+	tiles.clear();
+	tiles.resize( indexer.numWorkItems() );
+	parallel_for(
+		blocked_range<size_t>( 0, tiles.size() ),
+		TileFetcher( this, channelNames, indexer, Context::current(), tiles )
+	);
+}
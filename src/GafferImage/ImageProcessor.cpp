@@ -35,6 +35,8 @@
 //  
 //////////////////////////////////////////////////////////////////////////
 
+#include "IECore/BoxOps.h"
+
 #include "Gaffer/Context.h"
 
 #include "GafferImage/ImageProcessor.h"
@@ -152,3 +154,36 @@ void ImageProcessor::compute( ValuePlug *output, const Context *context ) const
 		ImageNode::compute( output, context );
 	}
 }
+
+ImageProcessor::TileCoverage ImageProcessor::tileCoverage( const Imath::V2i &tileOrigin, const Imath::Box2i &dataWindow )
+{
+	const Imath::Box2i tileBound( tileOrigin, tileOrigin + Imath::V2i( ImagePlug::tileSize() - 1 ) );
+	if( !dataWindow.intersects( tileBound ) )
+	{
+		return EmptyTile;
+	}
+	else if( IECore::boxContains( dataWindow, tileBound ) )
+	{
+		return FullTile;
+	}
+	return PartialTile;
+}
+
+ImageProcessor::TileCoverage ImageProcessor::inputTileCoverage( const Gaffer::Context *context, const ImagePlug *input ) const
+{
+	if( !input )
+	{
+		input = inPlug();
+	}
+
+	return tileCoverage(
+		context->get<Imath::V2i>( ImagePlug::tileOriginContextName ),
+		input->dataWindowPlug()->getValue()
+	);
+}
+
+const IECore::MurmurHash &ImageProcessor::blackTileHash()
+{
+	static IECore::MurmurHash g_blackTileHash = ImagePlug::blackTile()->Object::hash();
+	return g_blackTileHash;
+}
@@ -40,6 +40,10 @@
 #include "OpenImageIO/imagecache.h"
 OIIO_NAMESPACE_USING
 
+#include "IECore/VectorTypedData.h"
+#include "IECore/SimpleTypedData.h"
+#include "IECore/LRUCache.h"
+
 #include "Gaffer/Context.h"
 
 #include "GafferImage/ImageReader.h"
@@ -68,21 +72,209 @@ static ImageCache *imageCache()
 	{
 		if( lock.upgrade_to_writer() )
 		{
+			// We deliberately don't set the "forcefloat" attribute, so that
+			// half images remain half in the cache and take up half the memory.
+			// "forcefloat" was previously used to work around an OpenImageIO bug
+			// when reading a subset of the channels from non-float images, but
+			// we always read all channels at once, which avoids it.
 			cache = ImageCache::create();
-			// ImageReaderTest.testOIIOJpgRead exposes a bug in
-			// OpenImageIO where ImageCache::get_pixels() returns
-			// incorrect data when reading from non-float images.
-			// By forcing the image to be float on loading, we
-			// can work around that problem.
-			/// \todo Consider removing this once the bug is fixed in
-			/// OIIO - and test any performance implications of performing
-			/// the conversion in get_pixels() rather than immediately on load.
-			cache->attribute( "forcefloat", 1 );
+			// Have the cache generate MIP levels for files which don't
+			// have their own, so that reduced levels of detail can be
+			// read cheaply.
+			cache->attribute( "automip", 1 );
 		}
 	}
 	return cache;
 }
 
+// Extracts a single channel from a tile of interleaved data, flipping
+// it in the Y axis to convert it to our internal image data representation.
+static FloatVectorDataPtr deinterleave( const vector<float> &interleavedData, int nChannels, int channel )
+{
+	FloatVectorDataPtr resultData = new FloatVectorData;
+	vector<float> &result = resultData->writable();
+	result.resize( ImagePlug::tileSize() * ImagePlug::tileSize() );
+	for( int y = 0; y < ImagePlug::tileSize(); ++y )
+	{
+		const float *in = &(interleavedData[ y * ImagePlug::tileSize() * nChannels + channel ]);
+		float *out = &(result[ ( ImagePlug::tileSize() - y - 1 ) * ImagePlug::tileSize() ]);
+		for( int x = 0; x < ImagePlug::tileSize(); ++x, in += nChannels )
+		{
+			*out++ = *in;
+		}
+	}
+	return resultData;
+}
+
+// Fills interleavedData with the pixels of the tile at tileOrigin for the
+// specified level of detail, laid out in the same Y-down order as the
+// pixels read for a full resolution tile.
+static void readLODPixels( ustring fileName, const ImageSpec *spec, const Format &format, const V2i &tileOrigin, int lod, vector<float> &interleavedData )
+{
+	const int scale = 1 << lod;
+	const int tileSize = ImagePlug::tileSize();
+	const int nChannels = spec->nchannels;
+
+	// The full resolution pixels covered by the tile, in the Y-down space of the file.
+	const int minX = tileOrigin.x * scale;
+	const int minY = format.formatToYDownSpace( ( tileOrigin.y + tileSize ) * scale - 1 );
+
+	// Use a MIP level from the file (or generated by the cache) if there is one
+	// and its pixels line up with ours. Each MIP level pixel covers a block of
+	// full resolution pixels starting at the data window origin, so that
+	// must be a multiple of the scale, and so must the height of the flip
+	// between the Y-down space of the file and our Y-up space.
+	const Box2i &displayWindow = format.getDisplayWindow();
+	const ImageSpec *levelSpec = imageCache()->imagespec( fileName, 0, lod );
+	if(
+		levelSpec &&
+		spec->x % scale == 0 && spec->y % scale == 0 &&
+		( displayWindow.min.y + displayWindow.max.y + 1 ) % scale == 0
+	)
+	{
+		const int levelX = levelSpec->x + ( minX - spec->x ) / scale;
+		const int levelY = levelSpec->y + ( minY - spec->y ) / scale;
+		imageCache()->get_pixels(
+			fileName,
+			0, lod, // subimage, miplevel
+			levelX, levelX + tileSize,
+			levelY, levelY + tileSize,
+			0, 1,
+			TypeDesc::FLOAT,
+			&(interleavedData[0])
+		);
+		return;
+	}
+
+	// Otherwise we average blocks of full resolution pixels ourselves, reading
+	// one row of blocks at a time to bound the memory used at low levels of detail.
+	const int width = tileSize * scale;
+	const float normalisation = 1.0f / ( scale * scale );
+	vector<float> rows( width * scale * nChannels );
+	for( int y = 0; y < tileSize; ++y )
+	{
+		imageCache()->get_pixels(
+			fileName,
+			0, 0, // subimage, miplevel
+			minX, minX + width,
+			minY + y * scale, minY + ( y + 1 ) * scale,
+			0, 1,
+			TypeDesc::FLOAT,
+			&(rows[0])
+		);
+
+		float *out = &(interleavedData[ y * tileSize * nChannels ]);
+		std::fill( out, out + tileSize * nChannels, 0.0f );
+		for( int blockY = 0; blockY < scale; ++blockY )
+		{
+			const float *in = &(rows[ blockY * width * nChannels ]);
+			for( int x = 0; x < tileSize; ++x )
+			{
+				for( int blockX = 0; blockX < scale; ++blockX )
+				{
+					for( int c = 0; c < nChannels; ++c )
+					{
+						out[x * nChannels + c] += *in++;
+					}
+				}
+			}
+		}
+
+		for( int i = 0; i < tileSize * nChannels; ++i )
+		{
+			out[i] *= normalisation;
+		}
+	}
+}
+
+//////////////////////////////////////////////////////////////////////////
+// The ImageCache stores pixels in their native format, so every get_pixels()
+// call converts them to float. Rather than do that separately for each channel
+// of a tile, we read all the channels at once and hold the interleaved result
+// briefly in a small cache, from which the remaining channels are then taken.
+// This cache is only intended to span the requests for the channels of a tile,
+// which are typically made together, and is not a substitute for the ImageCache.
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+struct TileCacheKey
+{
+
+	TileCacheKey()
+	{
+	}
+
+	TileCacheKey( const std::string &fileName, const V2i &tileOrigin, int lod )
+		:	fileName( fileName ), tileOrigin( tileOrigin ), lod( lod )
+	{
+		hash.append( fileName );
+		hash.append( tileOrigin );
+		hash.append( lod );
+	}
+
+	bool operator == ( const TileCacheKey &other ) const
+	{
+		return hash == other.hash;
+	}
+
+	std::string fileName;
+	V2i tileOrigin;
+	int lod;
+	MurmurHash hash;
+
+};
+
+inline size_t tbb_hasher( const TileCacheKey &cacheKey )
+{
+	return tbb_hasher( cacheKey.hash );
+}
+
+ConstFloatVectorDataPtr tileGetter( const TileCacheKey &key, size_t &cost )
+{
+	ustring uFileName( key.fileName.c_str() );
+	const ImageSpec *spec = imageCache()->imagespec( uFileName );
+	Format format( Imath::Box2i( Imath::V2i( spec->full_x, spec->full_y ), Imath::V2i( spec->full_width + spec->full_x - 1, spec->full_height + spec->full_y - 1 ) ) );
+
+	FloatVectorDataPtr resultData = new FloatVectorData;
+	vector<float> &interleavedData = resultData->writable();
+	interleavedData.resize( ImagePlug::tileSize() * ImagePlug::tileSize() * spec->nchannels );
+	if( key.lod )
+	{
+		readLODPixels( uFileName, spec, format, key.tileOrigin, key.lod, interleavedData );
+	}
+	else
+	{
+		const int newY = format.formatToYDownSpace( key.tileOrigin.y + ImagePlug::tileSize() - 1 );
+		imageCache()->get_pixels(
+			uFileName,
+			0, 0, // subimage, miplevel
+			key.tileOrigin.x, key.tileOrigin.x + ImagePlug::tileSize(),
+			newY, newY + ImagePlug::tileSize(),
+			0, 1,
+			TypeDesc::FLOAT,
+			&(interleavedData[0])
+		);
+	}
+
+	cost = interleavedData.size() * sizeof( float );
+	return resultData;
+}
+
+typedef LRUCache<TileCacheKey, ConstFloatVectorDataPtr> TileCache;
+TileCache g_tileCache( tileGetter, 1024 * 1024 * 32 );
+
+} // namespace
+
+template<typename T>
+static T imageCacheAttribute( const char *name, TypeDesc type )
+{
+	T result = 0;
+	imageCache()->getattribute( name, type, &result );
+	return result;
+}
+
 //////////////////////////////////////////////////////////////////////////
 // ImageReader implementation
 //////////////////////////////////////////////////////////////////////////
@@ -149,6 +341,50 @@ size_t ImageReader::supportedExtensions( std::vector<std::string> &extensions )
 	return extensions.size();
 }
 
+size_t ImageReader::getCacheMemoryLimit()
+{
+	const float megabytes = imageCacheAttribute<float>( "max_memory_MB", TypeDesc::FLOAT );
+	return (size_t)( megabytes * 1024.0f * 1024.0f );
+}
+
+void ImageReader::setCacheMemoryLimit( size_t bytes )
+{
+	imageCache()->attribute( "max_memory_MB", (float)( bytes / ( 1024.0 * 1024.0 ) ) );
+}
+
+size_t ImageReader::getCacheMaxOpenFiles()
+{
+	return imageCacheAttribute<int>( "max_open_files", TypeDesc::INT );
+}
+
+void ImageReader::setCacheMaxOpenFiles( size_t maxOpenFiles )
+{
+	imageCache()->attribute( "max_open_files", (int)maxOpenFiles );
+}
+
+size_t ImageReader::cacheMemoryUsage()
+{
+	return imageCacheAttribute<long long>( "stat:cache_memory_used", TypeDesc::INT64 );
+}
+
+IECore::CompoundDataPtr ImageReader::cacheStatistics()
+{
+	const long long lookups = imageCacheAttribute<long long>( "stat:find_tile_calls", TypeDesc::INT64 );
+	const long long misses = imageCacheAttribute<int>( "stat:find_tile_cache_misses", TypeDesc::INT );
+
+	CompoundDataPtr result = new CompoundData;
+	CompoundDataMap &statistics = result->writable();
+	statistics["memoryUsage"] = new Int64Data( cacheMemoryUsage() );
+	statistics["bytesRead"] = new Int64Data( imageCacheAttribute<long long>( "stat:bytes_read", TypeDesc::INT64 ) );
+	statistics["hits"] = new Int64Data( lookups - misses );
+	statistics["misses"] = new Int64Data( misses );
+	statistics["filesOpened"] = new Int64Data( imageCacheAttribute<int>( "stat:open_files_created", TypeDesc::INT ) );
+	statistics["filesCurrentlyOpen"] = new Int64Data( imageCacheAttribute<int>( "stat:open_files_current", TypeDesc::INT ) );
+	statistics["filesPeakOpen"] = new Int64Data( imageCacheAttribute<int>( "stat:open_files_peak", TypeDesc::INT ) );
+
+	return result;
+}
+
 void ImageReader::affects( const Gaffer::Plug *input, AffectedPlugsContainer &outputs ) const
 {
 	ImageNode::affects( input, outputs );
@@ -166,6 +402,7 @@ void ImageReader::hashFormat( const GafferImage::ImagePlug *output, const Gaffer
 {
 	ImageNode::hashFormat( output, context, h );
 	fileNamePlug()->hash( h );
+	h.append( ImagePlug::lod( context ) );
 }
 
 void ImageReader::hashChannelNames( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
@@ -178,6 +415,7 @@ void ImageReader::hashDataWindow( const GafferImage::ImagePlug *output, const Ga
 {
 	ImageNode::hashDataWindow( output, context, h );
 	fileNamePlug()->hash( h );
+	h.append( ImagePlug::lod( context ) );
 }
 
 void ImageReader::hashChannelData( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
@@ -185,6 +423,7 @@ void ImageReader::hashChannelData( const GafferImage::ImagePlug *output, const G
 	ImageNode::hashChannelData( output, context, h );
 	h.append( context->get<V2i>( ImagePlug::tileOriginContextName ) );
 	h.append( context->get<std::string>( ImagePlug::channelNameContextName ) );
+	h.append( ImagePlug::lod( context ) );
 	fileNamePlug()->hash( h );
 }
 
@@ -200,6 +439,13 @@ GafferImage::Format ImageReader::computeFormat( const Gaffer::Context *context,
 		),
 		1.
 	);
+
+	const int lod = ImagePlug::lod( context );
+	if( lod )
+	{
+		return ImagePlug::lodFormat( format, lod );
+	}
+
 	/// \todo This shouldn't really be here. Compute methods shouldn't really have side effects and the
 	/// registerFormat() method is not only slow but it's also not threadsafe.
 	return GafferImage::Format::registerFormat( format );
@@ -213,7 +459,7 @@ Imath::Box2i ImageReader::computeDataWindow( const Gaffer::Context *context, con
 	Format format( Imath::Box2i( Imath::V2i( spec->full_x, spec->full_y ), Imath::V2i( spec->full_width + spec->full_x - 1, spec->full_height + spec->full_y - 1 ) ) );
 	Imath::Box2i dataWindow( Imath::V2i( spec->x, spec->y ), Imath::V2i( spec->width + spec->x - 1, spec->height + spec->y - 1 ) );
 
-	return format.yDownToFormatSpace( dataWindow );
+	return ImagePlug::lodWindow( format.yDownToFormatSpace( dataWindow ), ImagePlug::lod( context ) );
 }
 
 IECore::ConstStringVectorDataPtr ImageReader::computeChannelNames( const Gaffer::Context *context, const ImagePlug *parent ) const
@@ -239,33 +485,6 @@ IECore::ConstFloatVectorDataPtr ImageReader::computeChannelData( const std::stri
 		}
 	}
 
-	Format format( Imath::Box2i( Imath::V2i( spec->full_x, spec->full_y ), Imath::V2i( spec->full_width + spec->full_x - 1, spec->full_height + spec->full_y - 1 ) ) );
-	const int newY = format.formatToYDownSpace( tileOrigin.y + ImagePlug::tileSize() - 1 );
-
-	std::vector<float> channelData( ImagePlug::tileSize() * ImagePlug::tileSize() );
-	size_t channelIndex = channelIt - spec->channelnames.begin();
-	imageCache()->get_pixels(
-		uFileName,
-		0, 0, // subimage, miplevel
-		tileOrigin.x, tileOrigin.x + ImagePlug::tileSize(),
-		newY, newY + ImagePlug::tileSize(),
-		0, 1,
-		channelIndex, channelIndex + 1,
-		TypeDesc::FLOAT,
-		&(channelData[0])
-	);
-
-	// Create the output data buffer.
-	FloatVectorDataPtr resultData = new FloatVectorData;
-	vector<float> &result = resultData->writable();	
-	result.resize( ImagePlug::tileSize() * ImagePlug::tileSize() );
-
-	// Flip the tile in the Y axis to convert it to our internal image data representation.
-	for( int y = 0; y < ImagePlug::tileSize(); ++y )
-	{
-		memcpy( &(result[ ( ImagePlug::tileSize() - y - 1 ) * ImagePlug::tileSize() ]), &(channelData[ y * ImagePlug::tileSize() ]), sizeof(float)*ImagePlug::tileSize()  );
-	}
-
-	return resultData;
+	ConstFloatVectorDataPtr interleavedData = g_tileCache.get( TileCacheKey( fileName, tileOrigin, ImagePlug::lod( context ) ) );
+	return deinterleave( interleavedData->readable(), spec->nchannels, channelIt - spec->channelnames.begin() );
 }
-
@@ -34,6 +34,11 @@
 //  
 //////////////////////////////////////////////////////////////////////////
 
+#include "tbb/parallel_for.h"
+#include "tbb/blocked_range.h"
+
+#include "Gaffer/Context.h"
+
 #include "GafferImage/ImageSampler.h"
 #include "GafferImage/ImagePlug.h"
 #include "GafferImage/FilterPlug.h"
@@ -45,6 +50,132 @@ using namespace IECore;
 using namespace Gaffer;
 using namespace GafferImage;
 
+//////////////////////////////////////////////////////////////////////////
+// Utilities for batch sampling
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// A group of sample locations which all lie within the same tile,
+// along with the window needed to sample them all.
+struct SampleGroup
+{
+	Box2i window;
+	vector<size_t> indices;
+};
+
+struct TileOrderLess
+{
+
+	TileOrderLess( const vector<V2f> &pixels )
+		:	m_pixels( pixels )
+	{
+	}
+
+	bool operator()( size_t a, size_t b ) const
+	{
+		const V2i tileA = ImagePlug::tileOrigin( V2i( m_pixels[a] ) );
+		const V2i tileB = ImagePlug::tileOrigin( V2i( m_pixels[b] ) );
+		return tileA.y < tileB.y || ( tileA.y == tileB.y && tileA.x < tileB.x );
+	}
+
+	const vector<V2f> &m_pixels;
+
+};
+
+void groupSamples( const vector<V2f> &pixels, vector<SampleGroup> &groups )
+{
+	vector<size_t> indices( pixels.size() );
+	for( size_t i = 0, e = indices.size(); i < e; ++i )
+	{
+		indices[i] = i;
+	}
+	sort( indices.begin(), indices.end(), TileOrderLess( pixels ) );
+
+	V2i currentTile;
+	for( vector<size_t>::const_iterator it = indices.begin(), eIt = indices.end(); it != eIt; ++it )
+	{
+		// We use the same sample window per pixel as ImageSampler::colorPlug()
+		// does, so that the results are identical.
+		const V2i pixel( pixels[*it] );
+		const V2i tile = ImagePlug::tileOrigin( pixel );
+		if( groups.empty() || tile != currentTile )
+		{
+			groups.push_back( SampleGroup() );
+			currentTile = tile;
+		}
+		SampleGroup &group = groups.back();
+		group.indices.push_back( *it );
+		group.window.extendBy( pixel - V2i( 1 ) );
+		group.window.extendBy( pixel + V2i( 1 ) );
+	}
+}
+
+// Returns the names of the channels to be sampled for each component of
+// a colour, using the empty string for channels which don't exist.
+void colorChannelNames( const ImagePlug *image, vector<string> &channelNames )
+{
+	static const char *names[] = { "R", "G", "B", "A" };
+	ConstStringVectorDataPtr imageChannelNames = image->channelNamesPlug()->getValue();
+	const vector<string> &c = imageChannelNames->readable();
+	channelNames.resize( 4 );
+	for( int i = 0; i < 4; ++i )
+	{
+		channelNames[i] = find( c.begin(), c.end(), names[i] ) != c.end() ? names[i] : "";
+	}
+}
+
+class GroupSampler
+{
+
+	public :
+
+		GroupSampler( const ImagePlug *image, const vector<string> &channelNames, ConstFilterPtr filter, const vector<SampleGroup> &groups, const vector<V2f> &pixels, vector<Color4f> &colors, const Context *context )
+			:	m_image( image ), m_channelNames( channelNames ), m_filter( filter ), m_groups( groups ), m_pixels( pixels ), m_colors( colors ), m_context( context )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			Context::Scope scope( m_context );
+			for( size_t i = r.begin(); i != r.end(); ++i )
+			{
+				const SampleGroup &group = m_groups[i];
+				for( int c = 0; c < 4; ++c )
+				{
+					if( m_channelNames[c].empty() )
+					{
+						continue;
+					}
+					Sampler sampler( m_image, m_channelNames[c], group.window, m_filter );
+					for( vector<size_t>::const_iterator it = group.indices.begin(), eIt = group.indices.end(); it != eIt; ++it )
+					{
+						const V2f &pixel = m_pixels[*it];
+						m_colors[*it][c] = sampler.sample( pixel.x, pixel.y );
+					}
+				}
+			}
+		}
+
+	private :
+
+		const ImagePlug *m_image;
+		const vector<string> &m_channelNames;
+		ConstFilterPtr m_filter;
+		const vector<SampleGroup> &m_groups;
+		const vector<V2f> &m_pixels;
+		vector<Color4f> &m_colors;
+		const Context *m_context;
+
+};
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+// ImageSampler
+//////////////////////////////////////////////////////////////////////////
+
 IE_CORE_DEFINERUNTIMETYPED( ImageSampler );
 
 size_t ImageSampler::g_firstPlugIndex = 0;
@@ -59,6 +190,8 @@ ImageSampler::ImageSampler( const std::string &name )
 	addChild( new V2fPlug( "pixel" ) );
 	addChild( new FilterPlug( "filter" ) );
 	addChild( new Color4fPlug( "color", Plug::Out ) );
+	addChild( new V2fVectorDataPlug( "pixels", Plug::In, new V2fVectorData ) );
+	addChild( new Color4fVectorDataPlug( "colors", Plug::Out, new Color4fVectorData ) );
 	
 }
 
@@ -106,6 +239,26 @@ const Gaffer::Color4fPlug *ImageSampler::colorPlug() const
 	return getChild<Color4fPlug>( g_firstPlugIndex + 3 );
 }
 
+Gaffer::V2fVectorDataPlug *ImageSampler::pixelsPlug()
+{
+	return getChild<V2fVectorDataPlug>( g_firstPlugIndex + 4 );
+}
+
+const Gaffer::V2fVectorDataPlug *ImageSampler::pixelsPlug() const
+{
+	return getChild<V2fVectorDataPlug>( g_firstPlugIndex + 4 );
+}
+
+Gaffer::Color4fVectorDataPlug *ImageSampler::colorsPlug()
+{
+	return getChild<Color4fVectorDataPlug>( g_firstPlugIndex + 5 );
+}
+
+const Gaffer::Color4fVectorDataPlug *ImageSampler::colorsPlug() const
+{
+	return getChild<Color4fVectorDataPlug>( g_firstPlugIndex + 5 );
+}
+
 void ImageSampler::affects( const Gaffer::Plug *input, AffectedPlugsContainer &outputs ) const
 {
 	ComputeNode::affects( input, outputs );
@@ -118,6 +271,11 @@ void ImageSampler::affects( const Gaffer::Plug *input, AffectedPlugsContainer &o
 			outputs.push_back( componentIt->get() );
 		}
 	}
+
+	if( inputParent == imagePlug() || input == pixelsPlug() || input == filterPlug() )
+	{
+		outputs.push_back( colorsPlug() );
+	}
 }
 
 void ImageSampler::hash( const Gaffer::ValuePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
@@ -141,6 +299,10 @@ void ImageSampler::hash( const Gaffer::ValuePlug *output, const Gaffer::Context
 			h.append( filter );
 		}
 	}
+	else if( output == colorsPlug() )
+	{
+		hashColors( context, h );
+	}
 }
 
 void ImageSampler::compute( Gaffer::ValuePlug *output, const Gaffer::Context *context ) const
@@ -163,6 +325,11 @@ void ImageSampler::compute( Gaffer::ValuePlug *output, const Gaffer::Context *co
 		static_cast<FloatPlug *>( output )->setValue( sample );
 		return;
 	}
+	else if( output == colorsPlug() )
+	{
+		static_cast<Color4fVectorDataPlug *>( output )->setValue( computeColors( context ) );
+		return;
+	}
 	
 	ComputeNode::compute( output, context );	
 }
@@ -197,3 +364,57 @@ std::string ImageSampler::channelName( const Gaffer::ValuePlug *output ) const
 
 	return "";	
 }
+
+void ImageSampler::hashColors( const Gaffer::Context *context, IECore::MurmurHash &h ) const
+{
+	ConstV2fVectorDataPtr pixelsData = pixelsPlug()->getValue();
+	pixelsData->hash( h );
+
+	const string filter = filterPlug()->getValue();
+	h.append( filter );
+
+	vector<string> channelNames;
+	colorChannelNames( imagePlug(), channelNames );
+	for( vector<string>::const_iterator it = channelNames.begin(), eIt = channelNames.end(); it != eIt; ++it )
+	{
+		h.append( *it );
+	}
+
+	imagePlug()->dataWindowPlug()->hash( h );
+
+	vector<SampleGroup> groups;
+	groupSamples( pixelsData->readable(), groups );
+	ConstFilterPtr f = Filter::create( filter );
+	for( vector<SampleGroup>::const_iterator it = groups.begin(), eIt = groups.end(); it != eIt; ++it )
+	{
+		for( vector<string>::const_iterator cIt = channelNames.begin(), ceIt = channelNames.end(); cIt != ceIt; ++cIt )
+		{
+			if( cIt->size() )
+			{
+				Sampler sampler( imagePlug(), *cIt, it->window, f );
+				sampler.hash( h );
+			}
+		}
+	}
+}
+
+IECore::ConstColor4fVectorDataPtr ImageSampler::computeColors( const Gaffer::Context *context ) const
+{
+	ConstV2fVectorDataPtr pixelsData = pixelsPlug()->getValue();
+	const vector<V2f> &pixels = pixelsData->readable();
+
+	Color4fVectorDataPtr result = new Color4fVectorData;
+	vector<Color4f> &colors = result->writable();
+	colors.resize( pixels.size(), Color4f( 0 ) );
+
+	vector<string> channelNames;
+	colorChannelNames( imagePlug(), channelNames );
+
+	vector<SampleGroup> groups;
+	groupSamples( pixels, groups );
+
+	GroupSampler groupSampler( imagePlug(), channelNames, Filter::create( filterPlug()->getValue() ), groups, pixels, colors, context );
+	tbb::parallel_for( tbb::blocked_range<size_t>( 0, groups.size() ), groupSampler );
+
+	return result;
+}
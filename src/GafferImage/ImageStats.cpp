@@ -34,21 +34,189 @@
 //  
 //////////////////////////////////////////////////////////////////////////
 
+
 #include "boost/bind.hpp"
 
+#include "tbb/parallel_reduce.h"
+#include "tbb/blocked_range.h"
+
+#include "IECore/BoxOps.h"
+
 #include "Gaffer/TypedPlug.h"
 #include "Gaffer/BoxPlug.h"
 #include "Gaffer/Context.h"
 #include "Gaffer/ScriptNode.h"
 
 #include "GafferImage/ImageStats.h"
-#include "GafferImage/Sampler.h"
 #include "GafferImage/ChannelMaskPlug.h"
 #include "GafferImage/Format.h"
 
+using namespace Imath;
+using namespace IECore;
 using namespace GafferImage;
 using namespace Gaffer;
 
+//////////////////////////////////////////////////////////////////////////
+// Implementation of StatisticsReducer. This is used with tbb::parallel_reduce
+// to gather the statistics for all channels in a single pass over the tiles.
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+struct ChannelStatistics
+{
+
+	ChannelStatistics( int bins )
+		:	min( std::numeric_limits<float>::max() ), max( -std::numeric_limits<float>::max() ), sum( 0. ), histogram( bins, 0 )
+	{
+	}
+
+	float min;
+	float max;
+	double sum;
+	std::vector<int> histogram;
+
+};
+
+class StatisticsReducer
+{
+
+	public :
+
+		StatisticsReducer( const ImagePlug *image, const std::vector<std::string> &channelNames, const std::vector<V2i> &tileOrigins, const Box2i &window, int bins, const V2f &range, const Context *context )
+			:	m_image( image ), m_channelNames( channelNames ), m_tileOrigins( tileOrigins ), m_window( window ),
+				m_rangeMin( range[0] ), m_binScale( range[1] > range[0] ? bins / ( range[1] - range[0] ) : 0.f ), m_context( context ),
+				m_statistics( channelNames.size(), ChannelStatistics( bins ) )
+		{
+		}
+
+		StatisticsReducer( StatisticsReducer &other, tbb::split )
+			:	m_image( other.m_image ), m_channelNames( other.m_channelNames ), m_tileOrigins( other.m_tileOrigins ), m_window( other.m_window ),
+				m_rangeMin( other.m_rangeMin ), m_binScale( other.m_binScale ), m_context( other.m_context ),
+				m_statistics( other.m_channelNames.size(), ChannelStatistics( other.m_statistics[0].histogram.size() ) )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r )
+		{
+			Context::Scope scope( m_context );
+			const int tileSize = ImagePlug::tileSize();
+			for( size_t i = r.begin(); i != r.end(); ++i )
+			{
+				const V2i &tileOrigin = m_tileOrigins[i];
+				const Box2i b = boxIntersection( Box2i( tileOrigin, tileOrigin + V2i( tileSize - 1 ) ), m_window );
+				for( size_t c = 0, e = m_channelNames.size(); c < e; ++c )
+				{
+					ConstFloatVectorDataPtr tileData = m_image->channelData( m_channelNames[c], tileOrigin );
+					ChannelStatistics &statistics = m_statistics[c];
+					for( int y = b.min.y; y <= b.max.y; ++y )
+					{
+						const float *p = &(tileData->readable()[0]) + ( y - tileOrigin.y ) * tileSize + ( b.min.x - tileOrigin.x );
+						for( int x = b.min.x; x <= b.max.x; ++x )
+						{
+							accumulate( statistics, *p++, 1 );
+						}
+					}
+				}
+			}
+		}
+
+		void join( const StatisticsReducer &other )
+		{
+			for( size_t c = 0, e = m_statistics.size(); c < e; ++c )
+			{
+				ChannelStatistics &statistics = m_statistics[c];
+				const ChannelStatistics &otherStatistics = other.m_statistics[c];
+				statistics.min = std::min( statistics.min, otherStatistics.min );
+				statistics.max = std::max( statistics.max, otherStatistics.max );
+				statistics.sum += otherStatistics.sum;
+				for( size_t i = 0, ei = statistics.histogram.size(); i < ei; ++i )
+				{
+					statistics.histogram[i] += otherStatistics.histogram[i];
+				}
+			}
+		}
+
+		/// Accounts for pixels which are within the region of interest
+		/// but not within the data window.
+		void accumulateConstant( float value, int count )
+		{
+			for( std::vector<ChannelStatistics>::iterator it = m_statistics.begin(), eIt = m_statistics.end(); it != eIt; ++it )
+			{
+				accumulate( *it, value, count );
+			}
+		}
+
+		const std::vector<ChannelStatistics> &statistics() const
+		{
+			return m_statistics;
+		}
+
+	private :
+
+		inline void accumulate( ChannelStatistics &statistics, float value, int count ) const
+		{
+			statistics.min = std::min( value, statistics.min );
+			statistics.max = std::max( value, statistics.max );
+			statistics.sum += double( value ) * count;
+			// Out of range values (and NaNs) are counted in the end bins.
+			const float f = ( value - m_rangeMin ) * m_binScale;
+			const int lastBin = statistics.histogram.size() - 1;
+			const int bin = f > 0.f ? ( f < lastBin ? int( f ) : lastBin ) : 0;
+			statistics.histogram[bin] += count;
+		}
+
+		const ImagePlug *m_image;
+		const std::vector<std::string> &m_channelNames;
+		const std::vector<V2i> &m_tileOrigins;
+		const Box2i &m_window;
+		const float m_rangeMin;
+		const float m_binScale;
+		const Context *m_context;
+		std::vector<ChannelStatistics> m_statistics;
+
+};
+
+float percentileFromHistogram( const std::vector<int> &histogram, const V2f &range, float percentile, float min, float max )
+{
+	size_t total = 0;
+	for( std::vector<int>::const_iterator it = histogram.begin(), eIt = histogram.end(); it != eIt; ++it )
+	{
+		total += *it;
+	}
+
+	if( !total )
+	{
+		return 0.f;
+	}
+
+	const double target = std::max( 0.f, std::min( percentile, 100.f ) ) / 100. * total;
+	const double binWidth = ( range[1] - range[0] ) / histogram.size();
+	size_t cumulative = 0;
+	for( size_t i = 0, e = histogram.size(); i < e; ++i )
+	{
+		const int count = histogram[i];
+		if( count && cumulative + count >= target )
+		{
+			// Interpolate linearly within the bin, and clamp to the true
+			// range of values to account for the outliers counted in the
+			// end bins.
+			const double value = range[0] + ( i + ( target - cumulative ) / count ) * binWidth;
+			return std::max( min, std::min( float( value ), max ) );
+		}
+		cumulative += count;
+	}
+
+	return max;
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+// ImageStats
+//////////////////////////////////////////////////////////////////////////
+
 IE_CORE_DEFINERUNTIMETYPED( ImageStats );
 
 size_t ImageStats::g_firstPlugIndex = 0;
@@ -70,9 +238,16 @@ ImageStats::ImageStats( const std::string &name )
 	addChild( new Color4fPlug( "average", Gaffer::Plug::Out ) );
 	addChild( new Color4fPlug( "min", Gaffer::Plug::Out ) );
 	addChild( new Color4fPlug( "max", Gaffer::Plug::Out ) );
+	addChild( new IntPlug( "histogramBins", Gaffer::Plug::In, 256, 1 ) );
+	addChild( new V2fPlug( "histogramRange", Gaffer::Plug::In, V2f( 0, 1 ) ) );
+	addChild( new FloatPlug( "percentile", Gaffer::Plug::In, 50, 0, 100 ) );
+	addChild( new Color4fPlug( "percentileValue", Gaffer::Plug::Out ) );
+	addChild( new CompoundObjectPlug( "histogram", Gaffer::Plug::Out, new CompoundObject ) );
+	addChild( new CompoundObjectPlug( "__statistics", Gaffer::Plug::Out, new CompoundObject ) );
 	plugInputChangedSignal().connect( boost::bind( &ImageStats::inputChanged, this, ::_1 ) );
 }
 
+
 ImageStats::~ImageStats()
 {
 }
@@ -137,6 +312,66 @@ const Color4fPlug *ImageStats::maxPlug() const
 	return getChild<Color4fPlug>( g_firstPlugIndex + 5 );
 }
 
+IntPlug *ImageStats::histogramBinsPlug()
+{
+	return getChild<IntPlug>( g_firstPlugIndex + 6 );
+}
+
+const IntPlug *ImageStats::histogramBinsPlug() const
+{
+	return getChild<IntPlug>( g_firstPlugIndex + 6 );
+}
+
+V2fPlug *ImageStats::histogramRangePlug()
+{
+	return getChild<V2fPlug>( g_firstPlugIndex + 7 );
+}
+
+const V2fPlug *ImageStats::histogramRangePlug() const
+{
+	return getChild<V2fPlug>( g_firstPlugIndex + 7 );
+}
+
+FloatPlug *ImageStats::percentilePlug()
+{
+	return getChild<FloatPlug>( g_firstPlugIndex + 8 );
+}
+
+const FloatPlug *ImageStats::percentilePlug() const
+{
+	return getChild<FloatPlug>( g_firstPlugIndex + 8 );
+}
+
+Color4fPlug *ImageStats::percentileValuePlug()
+{
+	return getChild<Color4fPlug>( g_firstPlugIndex + 9 );
+}
+
+const Color4fPlug *ImageStats::percentileValuePlug() const
+{
+	return getChild<Color4fPlug>( g_firstPlugIndex + 9 );
+}
+
+CompoundObjectPlug *ImageStats::histogramPlug()
+{
+	return getChild<CompoundObjectPlug>( g_firstPlugIndex + 10 );
+}
+
+const CompoundObjectPlug *ImageStats::histogramPlug() const
+{
+	return getChild<CompoundObjectPlug>( g_firstPlugIndex + 10 );
+}
+
+CompoundObjectPlug *ImageStats::statisticsPlug()
+{
+	return getChild<CompoundObjectPlug>( g_firstPlugIndex + 11 );
+}
+
+const CompoundObjectPlug *ImageStats::statisticsPlug() const
+{
+	return getChild<CompoundObjectPlug>( g_firstPlugIndex + 11 );
+}
+
 void ImageStats::inputChanged( Gaffer::Plug *plug )
 {
 	const Imath::Box2i regionOfInterest( regionOfInterestPlug()->getValue() );
@@ -176,80 +411,190 @@ void ImageStats::affects( const Gaffer::Plug *input, AffectedPlugsContainer &out
 	if (
 			input == channelsPlug() ||
 			input->parent<ImagePlug>() == inPlug() ||
-			regionOfInterestPlug()->isAncestorOf( input )
+			regionOfInterestPlug()->isAncestorOf( input ) ||
+			input == histogramBinsPlug() ||
+			histogramRangePlug()->isAncestorOf( input )
 	   ) 
+	{
+		outputs.push_back( statisticsPlug() );
+		return;
+	}
+
+	if( input == statisticsPlug() )
 	{
 		for( unsigned int i = 0; i < 4; ++i )
 		{
 			outputs.push_back( minPlug()->getChild(i) );	
 			outputs.push_back( averagePlug()->getChild(i) );	
 			outputs.push_back( maxPlug()->getChild(i) );	
+			outputs.push_back( percentileValuePlug()->getChild(i) );
 		}
+		outputs.push_back( histogramPlug() );
 		return;
 	}
+
+	if( input == percentilePlug() )
+	{
+		for( unsigned int i = 0; i < 4; ++i )
+		{
+			outputs.push_back( percentileValuePlug()->getChild(i) );
+		}
+	}
 }
 
 void ImageStats::hash( const ValuePlug *output, const Context *context, IECore::MurmurHash &h ) const
 {
 	ComputeNode::hash( output, context, h);
-	
-	bool earlyOut = true;
-	for( int i = 0; i < 4; ++i )
+
+	if( output == statisticsPlug() )
 	{
-		if (
-				output == minPlug()->getChild(i) ||
-				output == maxPlug()->getChild(i) ||
-				output == averagePlug()->getChild(i)
-		   )
+		hashStatistics( context, h );
+		return;
+	}
+
+	if( output == histogramPlug() )
+	{
+		statisticsPlug()->hash( h );
+		return;
+	}
+
+	const Color4fPlug *colorOutput = output->parent<Color4fPlug>();
+	if(
+		colorOutput != minPlug() &&
+		colorOutput != maxPlug() &&
+		colorOutput != averagePlug() &&
+		colorOutput != percentileValuePlug()
+	)
+	{
+		return;
+	}
+
+	std::string channel;
+	channelNameFromOutput( output, channel );
+	if( !channel.empty() )
+	{
+		statisticsPlug()->hash( h );
+		h.append( channel );
+		if( colorOutput == percentileValuePlug() )
 		{
-			earlyOut = false;
-			break;
+			percentilePlug()->hash( h );
 		}
+		return;
 	}
-	if( earlyOut )
+
+	// If there is no channel for the output then we just append the default value that we will give the plug.
+	if( output == colorOutput->getChild(3) )
 	{
-		return;
+		h.append( 0 );
 	}
+	else
+	{
+		h.append( 1 );
+	}
+}
 
-	const Imath::Box2i regionOfInterest( regionOfInterestPlug()->getValue() );
+void ImageStats::hashStatistics( const Gaffer::Context *context, IECore::MurmurHash &h ) const
+{
+	const Box2i regionOfInterest( regionOfInterestPlug()->getValue() );
 	regionOfInterestPlug()->hash( h );
-	inPlug()->channelNamesPlug()->hash( h );
+	if( regionOfInterest.isEmpty() )
+	{
+		return;
+	}
+
+	histogramBinsPlug()->hash( h );
+	histogramRangePlug()->hash( h );
 	inPlug()->dataWindowPlug()->hash( h );
 
 	IECore::ConstStringVectorDataPtr channelNamesData = inPlug()->channelNamesPlug()->getValue();
 	std::vector<std::string> maskChannels = channelNamesData->readable();
 	channelsPlug()->maskChannels( maskChannels );
-	const int nChannels( maskChannels.size() );
-	
-	if ( nChannels > 0 )
+	for( std::vector<std::string>::const_iterator it = maskChannels.begin(), eIt = maskChannels.end(); it != eIt; ++it )
 	{
-		std::vector<std::string> uniqueChannels = maskChannels;
-		GafferImage::ChannelMaskPlug::removeDuplicateIndices( uniqueChannels );
-		std::string channel;
-		channelNameFromOutput( output, channel );
+		h.append( *it );
+	}
 
-		if ( !channel.empty() )
+	const Box2i window = boxIntersection( regionOfInterest, inPlug()->dataWindowPlug()->getValue() );
+	if( window.isEmpty() || maskChannels.empty() )
+	{
+		return;
+	}
+
+	const V2i minTileOrigin = ImagePlug::tileOrigin( window.min );
+	const V2i maxTileOrigin = ImagePlug::tileOrigin( window.max );
+	for( int y = minTileOrigin.y; y <= maxTileOrigin.y; y += ImagePlug::tileSize() )
+	{
+		for( int x = minTileOrigin.x; x <= maxTileOrigin.x; x += ImagePlug::tileSize() )
 		{
-			h.append( channel );	
-			Sampler s( inPlug(), channel, regionOfInterest );
-			s.hash( h );
-			return;
+			for( std::vector<std::string>::const_iterator it = maskChannels.begin(), eIt = maskChannels.end(); it != eIt; ++it )
+			{
+				h.append( inPlug()->channelDataHash( *it, V2i( x, y ) ) );
+			}
 		}
 	}
+}
 
-	// If our node is not enabled then we just append the default value that we will give the plug.
-	if(
-			output == maxPlug()->getChild(3) ||
-			output == minPlug()->getChild(3) ||
-			output == averagePlug()->getChild(3)
-	  )
+IECore::ConstCompoundObjectPtr ImageStats::computeStatistics( const Gaffer::Context *context ) const
+{
+	CompoundObjectPtr result = new CompoundObject;
+
+	const Box2i regionOfInterest( regionOfInterestPlug()->getValue() );
+	if( regionOfInterest.isEmpty() )
 	{
-		h.append( 0 );
+		return result;
 	}
-	else
+
+	IECore::ConstStringVectorDataPtr channelNamesData = inPlug()->channelNamesPlug()->getValue();
+	std::vector<std::string> maskChannels = channelNamesData->readable();
+	channelsPlug()->maskChannels( maskChannels );
+	if( maskChannels.empty() )
 	{
-		h.append( 1 );
+		return result;
+	}
+
+	const int bins = std::max( 1, histogramBinsPlug()->getValue() );
+	const V2f range = histogramRangePlug()->getValue();
+
+	// Gather the statistics for the part of the region of interest covered
+	// by the data window, visiting each tile just once for all channels.
+	const Box2i window = boxIntersection( regionOfInterest, inPlug()->dataWindowPlug()->getValue() );
+	std::vector<V2i> tileOrigins;
+	if( !window.isEmpty() )
+	{
+		const V2i minTileOrigin = ImagePlug::tileOrigin( window.min );
+		const V2i maxTileOrigin = ImagePlug::tileOrigin( window.max );
+		for( int y = minTileOrigin.y; y <= maxTileOrigin.y; y += ImagePlug::tileSize() )
+		{
+			for( int x = minTileOrigin.x; x <= maxTileOrigin.x; x += ImagePlug::tileSize() )
+			{
+				tileOrigins.push_back( V2i( x, y ) );
+			}
+		}
+	}
+
+	StatisticsReducer reducer( inPlug(), maskChannels, tileOrigins, window, bins, range, context );
+	tbb::parallel_reduce( tbb::blocked_range<size_t>( 0, tileOrigins.size() ), reducer );
+
+	// The remainder of the region of interest is black.
+	const double numPixels = double( regionOfInterest.size().x + 1 ) * double( regionOfInterest.size().y + 1 );
+	const double numWindowPixels = window.isEmpty() ? 0. : double( window.size().x + 1 ) * double( window.size().y + 1 );
+	if( numPixels > numWindowPixels )
+	{
+		reducer.accumulateConstant( 0.f, int( numPixels - numWindowPixels ) );
+	}
+
+	const std::vector<ChannelStatistics> &statistics = reducer.statistics();
+	for( size_t c = 0, e = maskChannels.size(); c < e; ++c )
+	{
+		CompoundObjectPtr channelStatistics = new CompoundObject;
+		channelStatistics->members()["min"] = new FloatData( statistics[c].min );
+		channelStatistics->members()["max"] = new FloatData( statistics[c].max );
+		channelStatistics->members()["average"] = new FloatData( statistics[c].sum / numPixels );
+		channelStatistics->members()["histogram"] = new IntVectorData( statistics[c].histogram );
+		result->members()[maskChannels[c]] = channelStatistics;
 	}
+
+	return result;
 }
 
 void ImageStats::channelNameFromOutput( const ValuePlug *output, std::string &channelName ) const
@@ -268,7 +613,8 @@ void ImageStats::channelNameFromOutput( const ValuePlug *output, std::string &ch
 	{
 		if ( output == minPlug()->getChild( channelIndex ) ||
 			 output == maxPlug()->getChild( channelIndex ) ||
-			 output == averagePlug()->getChild( channelIndex )
+			 output == averagePlug()->getChild( channelIndex ) ||
+			 output == percentileValuePlug()->getChild( channelIndex )
 		   )
 		{
 			for( std::vector<std::string>::iterator it( uniqueChannels.begin() ); it != uniqueChannels.end(); ++it )
@@ -286,11 +632,7 @@ void ImageStats::channelNameFromOutput( const ValuePlug *output, std::string &ch
 
 void ImageStats::setOutputToDefault( FloatPlug *output ) const
 {
-	if (
-			output == minPlug()->getChild(3) ||
-			output == maxPlug()->getChild(3) ||
-			output == averagePlug()->getChild(3)
-	   )
+	if( output == output->parent<Color4fPlug>()->getChild(3) )
 	{
 		output->setValue( 1. );
 	}
@@ -302,13 +644,37 @@ void ImageStats::setOutputToDefault( FloatPlug *output ) const
 
 void ImageStats::compute( ValuePlug *output, const Context *context ) const
 {
-	const Imath::Box2i &regionOfInterest( regionOfInterestPlug()->getValue() );
-	if( regionOfInterest.isEmpty() )
+	if( output == statisticsPlug() )
 	{
-		setOutputToDefault( static_cast<FloatPlug*>( output ) );
+		static_cast<CompoundObjectPlug *>( output )->setValue( computeStatistics( context ) );
 		return;
 	}
-	
+
+	if( output == histogramPlug() )
+	{
+		ConstCompoundObjectPtr statistics = statisticsPlug()->getValue();
+		CompoundObjectPtr result = new CompoundObject;
+		for( CompoundObject::ObjectMap::const_iterator it = statistics->members().begin(), eIt = statistics->members().end(); it != eIt; ++it )
+		{
+			const CompoundObject *channelStatistics = static_cast<const CompoundObject *>( it->second.get() );
+			result->members()[it->first] = channelStatistics->member<IntVectorData>( "histogram" )->copy();
+		}
+		static_cast<CompoundObjectPlug *>( output )->setValue( result );
+		return;
+	}
+
+	const Color4fPlug *colorOutput = output->parent<Color4fPlug>();
+	if(
+		colorOutput != minPlug() &&
+		colorOutput != maxPlug() &&
+		colorOutput != averagePlug() &&
+		colorOutput != percentileValuePlug()
+	)
+	{
+		ComputeNode::compute( output, context );
+		return;
+	}
+
 	std::string channelName;
 	channelNameFromOutput( output, channelName );
 	if ( channelName.empty() )
@@ -317,48 +683,39 @@ void ImageStats::compute( ValuePlug *output, const Context *context ) const
 		return;
 	}
 
-	int channelIndex = GafferImage::ChannelMaskPlug::channelIndex( channelName );
-
-	// Set up the execution context.
-	ContextPtr tmpContext = new Context( *context, Context::Borrowed );
-	tmpContext->set( ImagePlug::channelNameContextName, channelName );
-	Context::Scope scopedContext( tmpContext );
-
-	// Loop over the ROI and compute the min, max and average channel values and then set our outputs.
-	Sampler s( inPlug(), channelName, regionOfInterest );	
-
-	float min = std::numeric_limits<float>::max();
-	float max = std::numeric_limits<float>::min();
-	float average = 0.f;
-
-	double sum = 0.;
-	for( int y = regionOfInterest.min.y; y <= regionOfInterest.max.y; ++y )
+	ConstCompoundObjectPtr statistics = statisticsPlug()->getValue();
+	const CompoundObject *channelStatistics = statistics->member<CompoundObject>( channelName );
+	if( !channelStatistics )
 	{
-		for( int x = regionOfInterest.min.x; x <= regionOfInterest.max.x; ++x )
-		{
-			float v = s.sample( x, y );
-			min = std::min( v, min );
-			max = std::max( v, max );
-			sum += v;
-		}
+		// The region of interest is empty.
+		setOutputToDefault( static_cast<FloatPlug*>( output ) );
+		return;
 	}
-	average = sum / double( (regionOfInterest.size().x+1) * (regionOfInterest.size().y+1) );
 
-	if ( minPlug()->getChild( channelIndex ) == output )
+	float value = 0.f;
+	if( colorOutput == minPlug() )
 	{
-		static_cast<FloatPlug *>( output )->setValue( min );
+		value = channelStatistics->member<FloatData>( "min" )->readable();
 	}
-	else if ( maxPlug()->getChild( channelIndex ) == output )
+	else if( colorOutput == maxPlug() )
 	{
-		static_cast<FloatPlug *>( output )->setValue( max );
+		value = channelStatistics->member<FloatData>( "max" )->readable();
 	}
-	else if ( averagePlug()->getChild( channelIndex ) == output )
+	else if( colorOutput == averagePlug() )
 	{
-		static_cast<FloatPlug *>( output )->setValue( average );
+		value = channelStatistics->member<FloatData>( "average" )->readable();
 	}
 	else
 	{
-		static_cast<FloatPlug *>( output )->setValue( 0 );
+		value = percentileFromHistogram(
+			channelStatistics->member<IntVectorData>( "histogram" )->readable(),
+			histogramRangePlug()->getValue(),
+			percentilePlug()->getValue(),
+			channelStatistics->member<FloatData>( "min" )->readable(),
+			channelStatistics->member<FloatData>( "max" )->readable()
+		);
 	}
+
+	static_cast<FloatPlug *>( output )->setValue( value );
 }
 
@@ -34,17 +34,297 @@
 //  
 //////////////////////////////////////////////////////////////////////////
 
+#include <cmath>
+
+#include "tbb/parallel_invoke.h"
+
+#include "IECore/BoxOps.h"
+
 #include "Gaffer/TimeWarp.inl"
+
 #include "GafferImage/ImageTimeWarp.h"
+#include "GafferImage/SIMD.h"
 
+using namespace std;
+using namespace Imath;
+using namespace IECore;
+using namespace Gaffer;
 using namespace GafferImage;
 
+//////////////////////////////////////////////////////////////////////////
+// ImageTimeWarpBase
+//////////////////////////////////////////////////////////////////////////
+
 namespace Gaffer
 {
 
-IECORE_RUNTIMETYPED_DEFINETEMPLATESPECIALISATION( GafferImage::ImageTimeWarp, ImageTimeWarpTypeId )
+IECORE_RUNTIMETYPED_DEFINETEMPLATESPECIALISATION( GafferImage::ImageTimeWarpBase, ImageTimeWarpBaseTypeId )
 
 }
 
 // explicit instantiation
 template class Gaffer::TimeWarp<ImageMixinBase>;
+
+//////////////////////////////////////////////////////////////////////////
+// Utilities
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// Linearly interpolates between tiles a and b, Float::width pixels at a time.
+void blendTiles( const float *a, const float *b, float mix, float *result )
+{
+	const int n = ImagePlug::tileSize() * ImagePlug::tileSize();
+	const SIMD::Float vMix( mix );
+	int i = 0;
+	for( ; i + SIMD::Float::width <= n; i += SIMD::Float::width )
+	{
+		const SIMD::Float vA = SIMD::Float::load( a + i );
+		const SIMD::Float vB = SIMD::Float::load( b + i );
+		( vA + ( vB - vA ) * vMix ).store( result + i );
+	}
+	for( ; i < n; ++i )
+	{
+		result[i] = a[i] + ( b[i] - a[i] ) * mix;
+	}
+}
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+// ImageTimeWarp
+//////////////////////////////////////////////////////////////////////////
+
+IE_CORE_DEFINERUNTIMETYPED( ImageTimeWarp );
+
+size_t ImageTimeWarp::g_firstPlugIndex = 0;
+
+ImageTimeWarp::ImageTimeWarp( const std::string &name )
+	:	ImageTimeWarpBase( name )
+{
+	storeIndexOfNextChild( g_firstPlugIndex );
+	addChild( new BoolPlug( "frameBlending" ) );
+}
+
+ImageTimeWarp::~ImageTimeWarp()
+{
+}
+
+Gaffer::BoolPlug *ImageTimeWarp::frameBlendingPlug()
+{
+	return getChild<BoolPlug>( g_firstPlugIndex );
+}
+
+const Gaffer::BoolPlug *ImageTimeWarp::frameBlendingPlug() const
+{
+	return getChild<BoolPlug>( g_firstPlugIndex );
+}
+
+void ImageTimeWarp::affects( const Gaffer::Plug *input, AffectedPlugsContainer &outputs ) const
+{
+	ImageTimeWarpBase::affects( input, outputs );
+
+	if( input == frameBlendingPlug() )
+	{
+		appendAffectedPlugs( outputs );
+	}
+	else if( input == inPlug()->dataWindowPlug() )
+	{
+		// Blended tiles are masked by the data windows of both frames.
+		outputs.push_back( outPlug()->channelDataPlug() );
+	}
+}
+
+void ImageTimeWarp::hash( const Gaffer::ValuePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
+{
+	ContextPtr frameContexts[2];
+	float mix;
+	if( output->parent<ImagePlug>() != outPlug() || !frameBlending( context, frameContexts, mix ) )
+	{
+		ImageTimeWarpBase::hash( output, context, h );
+		return;
+	}
+
+	if( output == outPlug()->channelDataPlug() )
+	{
+		hashBlendedChannelData( context, frameContexts, mix, h );
+	}
+	else if( output == outPlug()->dataWindowPlug() )
+	{
+		ComputeNode::hash( output, context, h );
+		for( int i = 0; i < 2; ++i )
+		{
+			Context::Scope scopedContext( frameContexts[i].get() );
+			inPlug()->dataWindowPlug()->hash( h );
+		}
+	}
+	else
+	{
+		// The format and channel names are taken from the first frame.
+		Context::Scope scopedContext( frameContexts[0].get() );
+		h = inPlug()->getChild<ValuePlug>( output->getName() )->hash();
+	}
+}
+
+void ImageTimeWarp::compute( Gaffer::ValuePlug *output, const Gaffer::Context *context ) const
+{
+	ContextPtr frameContexts[2];
+	float mix;
+	if( output->parent<ImagePlug>() != outPlug() || !frameBlending( context, frameContexts, mix ) )
+	{
+		ImageTimeWarpBase::compute( output, context );
+		return;
+	}
+
+	if( output == outPlug()->channelDataPlug() )
+	{
+		static_cast<FloatVectorDataPlug *>( output )->setValue( computeBlendedChannelData( context, frameContexts, mix ) );
+	}
+	else if( output == outPlug()->dataWindowPlug() )
+	{
+		Box2i dataWindow;
+		for( int i = 0; i < 2; ++i )
+		{
+			Context::Scope scopedContext( frameContexts[i].get() );
+			const Box2i frameDataWindow = inPlug()->dataWindowPlug()->getValue();
+			if( !frameDataWindow.isEmpty() )
+			{
+				dataWindow.extendBy( frameDataWindow );
+			}
+		}
+		static_cast<AtomicBox2iPlug *>( output )->setValue( dataWindow );
+	}
+	else
+	{
+		Context::Scope scopedContext( frameContexts[0].get() );
+		output->setFrom( inPlug()->getChild<ValuePlug>( output->getName() ) );
+	}
+}
+
+bool ImageTimeWarp::frameBlending( const Gaffer::Context *context, Gaffer::ContextPtr frameContexts[2], float &mix ) const
+{
+	if( !enabledPlug()->getValue() || !frameBlendingPlug()->getValue() )
+	{
+		return false;
+	}
+
+	ContextPtr warpedContext = new Context( *context, Context::Borrowed );
+	processContext( warpedContext.get() );
+
+	const float frame = warpedContext->getFrame();
+	const float frame0 = floorf( frame );
+	mix = frame - frame0;
+	if( mix == 0.0f )
+	{
+		// We're on a whole frame, so there's nothing to blend.
+		return false;
+	}
+
+	frameContexts[0] = warpedContext;
+	frameContexts[0]->setFrame( frame0 );
+	frameContexts[1] = new Context( *context, Context::Borrowed );
+	frameContexts[1]->setFrame( frame0 + 1.0f );
+
+	return true;
+}
+
+namespace
+{
+
+// Fetches the tile for a single frame, masking it to the data window
+// so that pixels outside it are black.
+class NeighbourTileFetcher
+{
+
+	public :
+
+		NeighbourTileFetcher( const ImagePlug *plug, const Context *frameContext, ConstFloatVectorDataPtr &tile )
+			:	m_plug( plug ), m_frameContext( frameContext ), m_tile( tile )
+		{
+		}
+
+		void operator()() const
+		{
+			Context::Scope scopedContext( m_frameContext );
+
+			const V2i tileOrigin = m_frameContext->get<V2i>( ImagePlug::tileOriginContextName );
+			const Box2i tileBound( tileOrigin, tileOrigin + V2i( ImagePlug::tileSize() - 1 ) );
+			const Box2i dataWindow = m_plug->dataWindowPlug()->getValue();
+			if( !dataWindow.intersects( tileBound ) )
+			{
+				m_tile = ImagePlug::blackTile();
+				return;
+			}
+
+			m_tile = m_plug->channelDataPlug()->getValue();
+
+			if( !IECore::boxContains( dataWindow, tileBound ) )
+			{
+				const Box2i validBound = boxIntersection( dataWindow, tileBound );
+				FloatVectorDataPtr maskedTile = new FloatVectorData( vector<float>( ImagePlug::tileSize() * ImagePlug::tileSize(), 0.0f ) );
+				const float *in = &(m_tile->readable()[0]);
+				float *out = &(maskedTile->writable()[0]);
+				for( int y = validBound.min.y; y <= validBound.max.y; ++y )
+				{
+					const size_t offset = ( y - tileOrigin.y ) * ImagePlug::tileSize() + ( validBound.min.x - tileOrigin.x );
+					std::copy( in + offset, in + offset + validBound.size().x + 1, out + offset );
+				}
+				m_tile = maskedTile;
+			}
+		}
+
+	private :
+
+		const ImagePlug *m_plug;
+		const Context *m_frameContext;
+		ConstFloatVectorDataPtr &m_tile;
+
+};
+
+} // namespace
+
+void ImageTimeWarp::hashBlendedChannelData( const Gaffer::Context *context, const Gaffer::ContextPtr frameContexts[2], float mix, IECore::MurmurHash &h ) const
+{
+	ComputeNode::hash( outPlug()->channelDataPlug(), context, h );
+
+	const V2i tileOrigin = context->get<V2i>( ImagePlug::tileOriginContextName );
+	for( int i = 0; i < 2; ++i )
+	{
+		Context::Scope scopedContext( frameContexts[i].get() );
+		const Box2i dataWindow = inPlug()->dataWindowPlug()->getValue();
+		const TileCoverage coverage = tileCoverage( tileOrigin, dataWindow );
+		h.append( (int)coverage );
+		if( coverage != EmptyTile )
+		{
+			inPlug()->channelDataPlug()->hash( h );
+			if( coverage == PartialTile )
+			{
+				h.append( dataWindow );
+			}
+		}
+	}
+
+	h.append( mix );
+}
+
+IECore::ConstFloatVectorDataPtr ImageTimeWarp::computeBlendedChannelData( const Gaffer::Context *context, const Gaffer::ContextPtr frameContexts[2], float mix ) const
+{
+	// Compute the tiles for both frames in parallel.
+	ConstFloatVectorDataPtr tiles[2];
+	tbb::parallel_invoke(
+		NeighbourTileFetcher( inPlug(), frameContexts[0].get(), tiles[0] ),
+		NeighbourTileFetcher( inPlug(), frameContexts[1].get(), tiles[1] )
+	);
+
+	float value0, value1;
+	if( ImagePlug::isConstantTile( tiles[0].get(), value0 ) && ImagePlug::isConstantTile( tiles[1].get(), value1 ) )
+	{
+		return ImagePlug::constantTile( value0 + ( value1 - value0 ) * mix );
+	}
+
+	FloatVectorDataPtr result = new FloatVectorData;
+	result->writable().resize( ImagePlug::tileSize() * ImagePlug::tileSize() );
+	blendTiles( &(tiles[0]->readable()[0]), &(tiles[1]->readable()[0]), mix, &(result->writable()[0]) );
+	return result;
+}
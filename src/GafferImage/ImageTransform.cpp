@@ -99,6 +99,24 @@ class Implementation : public ImageProcessor
 		// A useful method that returns an axis-aligned box that contains box*m.		
 		Imath::Box2i transformBox( const Imath::M33f &m, const Imath::Box2i &box ) const;
 
+		// The kinds of transform for which we have specialised implementations.
+		enum Mode
+		{
+			// A translation by whole pixels, so output tiles are just
+			// copies of the input.
+			IntegerTranslate,
+			// A scale and translation with no rotation, so we can use
+			// Reformat's separable filtering.
+			AxisAligned,
+			// Anything else, for which we need to filter every output
+			// pixel individually.
+			General
+		};
+
+		// Returns the mode appropriate for the inverse matrix m, and the
+		// scale and offset which map output pixels into the input.
+		Mode mode( const Imath::M33f &m, const std::string &filter, Imath::V2d &scale, Imath::V2d &offset ) const;
+
 		// A method that uses the input and output format along with the transform plug to create
 		// the transform matrix that will compensate for the reformat node having resized the input.
 		Imath::M33f computeAdjustedMatrix() const;
@@ -210,6 +228,7 @@ void Implementation::hashDataWindow( const GafferImage::ImagePlug *output, const
 	ImageProcessor::hashDataWindow( output, context, h );
 	inPlug()->dataWindowPlug()->hash( h );
 	transformPlug()->hash( h );
+	h.append( ImagePlug::lod( context ) );
 }
 
 void Implementation::hashChannelNames( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
@@ -219,15 +238,33 @@ void Implementation::hashChannelNames( const GafferImage::ImagePlug *output, con
 
 void Implementation::hashChannelData( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
 {
-	ImageProcessor::hashChannelData( output, context, h );
-
-	// Hash all of the tiles that the sample requires for this tile.	
 	Imath::V2i tileOrigin( Context::current()->get<Imath::V2i>( ImagePlug::tileOriginContextName ) );
 	std::string channelName( Context::current()->get<std::string>( ImagePlug::channelNameContextName ) );
 	Imath::M33f sampleTransform( computeAdjustedMatrix().inverse() );
+
+	const std::string filterName = filterPlug()->getValue();
+	Imath::V2d scale, offset;
+	const Mode m = mode( sampleTransform, filterName, scale, offset );
+	if( m == IntegerTranslate )
+	{
+		// Translations by whole tiles pass input tiles straight through.
+		const Imath::V2i sourceOrigin = tileOrigin + Imath::V2i( int( offset.x ), int( offset.y ) );
+		if( sourceOrigin == ImagePlug::tileOrigin( sourceOrigin ) )
+		{
+			h = inPlug()->channelDataHash( channelName, sourceOrigin );
+			return;
+		}
+	}
+
+	ImageProcessor::hashChannelData( output, context, h );
+
+	// Hash all of the tiles that the sample requires for this tile.	
 	Imath::Box2i tile( transformBox( sampleTransform, Imath::Box2i( tileOrigin, tileOrigin + Imath::V2i( ImagePlug::tileSize() ) ) ) );
 	
-	GafferImage::FilterPtr filter = GafferImage::Filter::create( filterPlug()->getValue() );
+	// When downscaling, the separable path widens the filter, so we must
+	// account for that in the area we hash.
+	const float filterScale = m == AxisAligned ? 1.0 / std::min( scale.x, scale.y ) : 1.0f;
+	GafferImage::FilterPtr filter = GafferImage::Filter::create( filterName, filterScale );
 	Sampler sampler( inPlug(), channelName, tile, filter );
 	sampler.hash( h );
 	
@@ -238,8 +275,9 @@ void Implementation::hashChannelData( const GafferImage::ImagePlug *output, cons
 	// Hash the filter type that we are using.	
 	filterPlug()->hash( h );
 	
-	// Finally we hash the transformation.
+	// Finally we hash the transformation, which is applied at the current level of detail.
 	transformPlug()->hash( h );
+	h.append( ImagePlug::lod( context ) );
 }
 
 Imath::Box2i Implementation::computeDataWindow( const Gaffer::Context *context, const ImagePlug *parent ) const
@@ -265,9 +303,14 @@ Imath::M33f Implementation::computeAdjustedMatrix() const
 		float( inFormat.getDisplayWindow().size().y+1 ) / ( outFormat.getDisplayWindow().size().y+1 )
 	);
 
+	// The pivot and translation are specified in full resolution pixels, so must
+	// be reduced to match the level of detail being computed.
+	const float lodScale = 1.0f / float( 1 << ImagePlug::lod( Context::current() ) );
+	const Imath::V2f pivot = transformPlug()->pivotPlug()->getValue() * lodScale;
+
 	// To transform the image correctly we need to first move the image to the pivot point.
 	Imath::M33f pi;
-	Imath::V2f invPivotVec = -transformPlug()->pivotPlug()->getValue();
+	Imath::V2f invPivotVec = -pivot;
 	invPivotVec *= trueScale;
 	pi.translate( invPivotVec );
 
@@ -283,11 +326,11 @@ Imath::M33f Implementation::computeAdjustedMatrix() const
 	
 	// The translation component.
 	Imath::M33f t;
-	t.translate( transformPlug()->translatePlug()->getValue() );
+	t.translate( transformPlug()->translatePlug()->getValue() * lodScale );
 
 	// Here we invert the pivot vector and translate the image back.
 	Imath::M33f p;
-	p.translate( transformPlug()->pivotPlug()->getValue() );
+	p.translate( pivot );
 
 	// Concatenate the transforms.
 	Imath::M33f result = pi * s * r * t * p;
@@ -320,6 +363,43 @@ Imath::Box2i Implementation::transformBox( const Imath::M33f &m, const Imath::Bo
 	return Imath::Box2i( Imath::V2i( minX, minY ), Imath::V2i( maxX-1, maxY-1 ) );	
 }
 
+Implementation::Mode Implementation::mode( const Imath::M33f &m, const std::string &filter, Imath::V2d &scale, Imath::V2d &offset ) const
+{
+	// We allow a little tolerance, as the matrix is the result of concatenating
+	// several others, and then inverting.
+	const float tolerance = 1e-5;
+
+	if( fabs( m[0][1] ) > tolerance || fabs( m[1][0] ) > tolerance || m[0][0] <= 0 || m[1][1] <= 0 )
+	{
+		return General;
+	}
+
+	// Output pixel x maps to x * m[0][0] + m[2][0] in the input.
+	scale = Imath::V2d( 1.0 / m[0][0], 1.0 / m[1][1] );
+	offset = Imath::V2d( m[2][0], m[2][1] );
+
+	if( fabs( m[0][0] - 1 ) <= tolerance && fabs( m[1][1] - 1 ) <= tolerance )
+	{
+		const Imath::V2d rounded( floor( offset.x + 0.5 ), floor( offset.y + 0.5 ) );
+		if( fabs( offset.x - rounded.x ) <= tolerance && fabs( offset.y - rounded.y ) <= tolerance )
+		{
+			scale = Imath::V2d( 1 );
+			offset = rounded;
+			return IntegerTranslate;
+		}
+	}
+
+	// The Sampler treats the box filter as a point sample rather
+	// than a true box filter, so we can't match it with the separable
+	// path.
+	if( filter == "Box" )
+	{
+		return General;
+	}
+
+	return AxisAligned;
+}
+
 GafferImage::Format Implementation::computeFormat( const Gaffer::Context *context, const ImagePlug *parent ) const
 {
 	return outputFormatPlug()->getValue();
@@ -332,6 +412,41 @@ IECore::ConstStringVectorDataPtr Implementation::computeChannelNames( const Gaff
 
 IECore::ConstFloatVectorDataPtr Implementation::computeChannelData( const std::string &channelName, const Imath::V2i &tileOrigin, const Gaffer::Context *context, const ImagePlug *parent ) const
 {
+	Imath::M33f t = computeAdjustedMatrix().inverse();
+	const std::string filterName = filterPlug()->getValue();
+
+	// Dispatch to the specialised implementations where we can.
+	Imath::V2d scale, offset;
+	switch( mode( t, filterName, scale, offset ) )
+	{
+		case IntegerTranslate :
+		{
+			const Imath::V2i sourceOrigin = tileOrigin + Imath::V2i( int( offset.x ), int( offset.y ) );
+			if( sourceOrigin == ImagePlug::tileOrigin( sourceOrigin ) )
+			{
+				// Translation by whole tiles - we can reuse the input tile directly.
+				return inPlug()->channelData( channelName, sourceOrigin );
+			}
+
+			// Otherwise copy the rows from the input.
+			FloatVectorDataPtr outDataPtr = new FloatVectorData;
+			std::vector<float> &out = outDataPtr->writable();
+			out.resize( ImagePlug::tileSize() * ImagePlug::tileSize() );
+
+			const Imath::Box2i sourceBox( sourceOrigin, sourceOrigin + Imath::V2i( ImagePlug::tileSize() - 1 ) );
+			Sampler sampler( inPlug(), channelName, sourceBox );
+			for( int j = 0; j < ImagePlug::tileSize(); ++j )
+			{
+				sampler.row( sourceOrigin.x, sourceOrigin.y + j, ImagePlug::tileSize(), &(out[j * ImagePlug::tileSize()]) );
+			}
+			return outDataPtr;
+		}
+		case AxisAligned :
+			return Reformat::resample( inPlug(), channelName, tileOrigin, filterName, scale, offset, Sampler::Black );
+		default :
+			break;
+	}
+
 	// Allocate the new tile
 	FloatVectorDataPtr outDataPtr = new FloatVectorData;
 	std::vector<float> &out = outDataPtr->writable();
@@ -341,12 +456,9 @@ IECore::ConstFloatVectorDataPtr Implementation::computeChannelData( const std::s
 	Imath::Box2i tile( tileOrigin, Imath::V2i( tileOrigin.x + ImagePlug::tileSize() - 1, tileOrigin.y + ImagePlug::tileSize() - 1 ) );
 
 	// Work out the sample area that we require to compute this tile.
-
-	Imath::M33f t = computeAdjustedMatrix().inverse();
-	Imath::Box2i inWindow( inPlug()->dataWindowPlug()->getValue() );
 	Imath::Box2i sampleBox( transformBox( t, tile ) );
 	
-	GafferImage::FilterPtr filter = GafferImage::Filter::create( filterPlug()->getValue() );
+	GafferImage::FilterPtr filter = GafferImage::Filter::create( filterName );
 	Sampler sampler( inPlug(), channelName, sampleBox, filter );
 	for ( int j = 0; j < ImagePlug::tileSize(); ++j )
 	{
@@ -452,6 +564,12 @@ void ImageTransform::compute( ValuePlug *output, const Context *context ) const
 {
 	if( output == formatPlug() )
 	{
+		// The scaled format is always computed at full resolution, and the
+		// Reformat reduces it to the level of detail being computed.
+		ContextPtr tmpContext = new Context( *context, Context::Borrowed );
+		tmpContext->set( ImagePlug::lodContextName, 0 );
+		Context::Scope scopedContext( tmpContext );
+
 		Imath::V2f scale = transformPlug()->scalePlug()->getValue();
 		GafferImage::Format f = inPlug()->formatPlug()->getValue();
 
@@ -486,6 +604,10 @@ void ImageTransform::hash( const ValuePlug *output, const Context *context, IECo
 	const FormatPlug *fPlug = IECore::runTimeCast<const FormatPlug>(output);
 	if( fPlug == formatPlug() )
 	{
+		ContextPtr tmpContext = new Context( *context, Context::Borrowed );
+		tmpContext->set( ImagePlug::lodContextName, 0 );
+		Context::Scope scopedContext( tmpContext );
+
 		h = inPlug()->formatPlug()->hash();
 		transformPlug()->scalePlug()->hash( h );
 		return;
@@ -34,11 +34,20 @@
 //  
 //////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+
 #include "boost/bind.hpp"
 
+#include "tbb/parallel_for.h"
+#include "tbb/pipeline.h"
+
 #include "OpenImageIO/imageio.h"
 OIIO_NAMESPACE_USING
 
+#include "IECore/BoxOps.h"
+#include "IECore/BoxAlgo.h"
+#include "IECore/MessageHandler.h"
+
 #include "Gaffer/Context.h"
 
 #include "GafferImage/ImageWriter.h"
@@ -51,6 +60,318 @@ using namespace IECore;
 using namespace GafferImage;
 using namespace Gaffer;
 
+//////////////////////////////////////////////////////////////////////////
+// Implementation of a pipeline for streaming an image to disk. The image
+// is written in horizontal bands, each of which is filled by computing
+// the tiles which intersect it in parallel. The bands are passed through
+// a tbb::parallel_pipeline so that the computation of the following bands
+// overlaps the writing of the current one, and the number of bands in
+// flight is bounded so that memory usage doesn't grow with the height
+// of the image.
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// The maximum number of bands which may be live in the pipeline at once.
+const size_t g_maxBandsInFlight = 4;
+
+// A range of scanlines [yBegin, yEnd) in the Y-down space of the file,
+// holding the pixels of each channel interleaved, ready for writing.
+struct Band
+{
+	int yBegin;
+	int yEnd;
+	vector<float> data;
+};
+
+// First stage of the pipeline - hands out the bands in file order. Because
+// bands are written in order and the pipeline limits the number of live
+// tokens, the band storage can be recycled from a fixed size ring.
+class BandGenerator
+{
+
+	public :
+
+		BandGenerator( const vector<V2i> &bandRanges, vector<Band> &bands, size_t rowSize )
+			:	m_bandRanges( bandRanges ), m_bands( bands ), m_rowSize( rowSize ), m_nextBand( 0 )
+		{
+		}
+
+		Band *operator()( tbb::flow_control &flowControl ) const
+		{
+			if( m_nextBand >= m_bandRanges.size() )
+			{
+				flowControl.stop();
+				return NULL;
+			}
+
+			Band *band = &(m_bands[m_nextBand % m_bands.size()]);
+			band->yBegin = m_bandRanges[m_nextBand].x;
+			band->yEnd = m_bandRanges[m_nextBand].y;
+			band->data.resize( m_rowSize * ( band->yEnd - band->yBegin ) );
+			m_nextBand++;
+			return band;
+		}
+
+	private :
+
+		const vector<V2i> &m_bandRanges;
+		vector<Band> &m_bands;
+		const size_t m_rowSize;
+		mutable size_t m_nextBand;
+
+};
+
+// Copies a range of (tile, channel) pairs into a band. Work items are
+// indexed as ( tileIndexY * numTilesX + tileIndexX ) * numChannels + channelIndex
+// so that all the channels of every tile intersecting the band are computed
+// in parallel.
+class TileCopier
+{
+
+	public :
+
+		TileCopier( const ImagePlug *plug, const vector<string> &channelNames, const Context *context, const Format &format, const Box2i &dataWindow, const Box2i &bandWindow, Band *band )
+			:	m_plug( plug ), m_channelNames( channelNames ), m_context( context ), m_format( format ), m_dataWindow( dataWindow ), m_bandWindow( bandWindow ), m_band( band )
+		{
+			m_minTileOrigin = ImagePlug::tileOrigin( m_bandWindow.min );
+			m_numTilesX = ( ImagePlug::tileOrigin( m_bandWindow.max ).x - m_minTileOrigin.x ) / ImagePlug::tileSize() + 1;
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			Context::Scope scopedContext( m_context );
+
+			const size_t numChannels = m_channelNames.size();
+			const size_t stride = ( m_dataWindow.size().x + 1 ) * numChannels;
+
+			for( size_t i = r.begin(); i != r.end(); ++i )
+			{
+				const size_t channelIndex = i % numChannels;
+				const size_t tileIndex = i / numChannels;
+				const V2i tileOrigin(
+					m_minTileOrigin.x + ( tileIndex % m_numTilesX ) * ImagePlug::tileSize(),
+					m_minTileOrigin.y + ( tileIndex / m_numTilesX ) * ImagePlug::tileSize()
+				);
+
+				const Box2i b = boxIntersection( ImagePlug::tileBound( tileOrigin ), m_bandWindow );
+				ConstFloatVectorDataPtr tileData = m_plug->channelData( m_channelNames[channelIndex], tileOrigin );
+				const float *tile = &(tileData->readable()[0]);
+
+				for( int y = b.min.y; y <= b.max.y; ++y )
+				{
+					const int fileY = m_format.formatToYDownSpace( y );
+					const float *in = tile + ( y - tileOrigin.y ) * ImagePlug::tileSize() + ( b.min.x - tileOrigin.x );
+					float *out = &(m_band->data[0]) + ( fileY - m_band->yBegin ) * stride + ( b.min.x - m_dataWindow.min.x ) * numChannels + channelIndex;
+					for( int x = b.min.x; x <= b.max.x; ++x, out += numChannels )
+					{
+						*out = *in++;
+					}
+				}
+			}
+		}
+
+		size_t numWorkItems() const
+		{
+			const int numTilesY = ( ImagePlug::tileOrigin( m_bandWindow.max ).y - m_minTileOrigin.y ) / ImagePlug::tileSize() + 1;
+			return m_numTilesX * numTilesY * m_channelNames.size();
+		}
+
+	private :
+
+		const ImagePlug *m_plug;
+		const vector<string> &m_channelNames;
+		const Context *m_context;
+		const Format &m_format;
+		const Box2i &m_dataWindow;
+		const Box2i m_bandWindow;
+		Band *m_band;
+		V2i m_minTileOrigin;
+		int m_numTilesX;
+
+};
+
+// Second stage of the pipeline - computes the contents of a band. This
+// stage runs in parallel, so several bands may be computed at once.
+class BandComputer
+{
+
+	public :
+
+		BandComputer( const ImagePlug *plug, const vector<string> &channelNames, const Context *context, const Format &format, const Box2i &dataWindow, bool imageIsBlack )
+			:	m_plug( plug ), m_channelNames( channelNames ), m_context( context ), m_format( format ), m_dataWindow( dataWindow ), m_imageIsBlack( imageIsBlack )
+		{
+		}
+
+		Band *operator()( Band *band ) const
+		{
+			if( m_imageIsBlack )
+			{
+				std::fill( band->data.begin(), band->data.end(), 0.0f );
+				return band;
+			}
+
+			// Convert the band back into Gaffer's Y-up space so we know which tiles we need.
+			const Box2i bandWindow(
+				V2i( m_dataWindow.min.x, m_format.formatToYDownSpace( band->yEnd - 1 ) ),
+				V2i( m_dataWindow.max.x, m_format.formatToYDownSpace( band->yBegin ) )
+			);
+
+			TileCopier tileCopier( m_plug, m_channelNames, m_context, m_format, m_dataWindow, bandWindow, band );
+			tbb::parallel_for( tbb::blocked_range<size_t>( 0, tileCopier.numWorkItems() ), tileCopier );
+
+			return band;
+		}
+
+	private :
+
+		const ImagePlug *m_plug;
+		const vector<string> &m_channelNames;
+		const Context *m_context;
+		const Format &m_format;
+		const Box2i &m_dataWindow;
+		const bool m_imageIsBlack;
+
+};
+
+// Final stage of the pipeline - writes each band to the file, in order.
+class BandWriter
+{
+
+	public :
+
+		BandWriter( ImageOutput *out, const ImageSpec &spec, bool tiled, const std::string &fileName )
+			:	m_out( out ), m_spec( spec ), m_tiled( tiled ), m_fileName( fileName )
+		{
+		}
+
+		void operator()( Band *band ) const
+		{
+			if( m_tiled )
+			{
+				if( !m_out->write_tiles( m_spec.x, m_spec.x + m_spec.width, band->yBegin, band->yEnd, 0, 1, TypeDesc::FLOAT, &(band->data[0]) ) )
+				{
+					throw IECore::Exception( boost::str( boost::format( "Could not write tile to \"%s\", error = %s" ) % m_fileName % m_out->geterror() ) );
+				}
+			}
+			else
+			{
+				if( !m_out->write_scanlines( band->yBegin, band->yEnd, 0, TypeDesc::FLOAT, &(band->data[0]) ) )
+				{
+					throw IECore::Exception( boost::str( boost::format( "Could not write scanline to \"%s\", error = %s" ) % m_fileName % m_out->geterror() ) );
+				}
+			}
+		}
+
+	private :
+
+		ImageOutput *m_out;
+		const ImageSpec &m_spec;
+		const bool m_tiled;
+		const std::string &m_fileName;
+
+};
+
+// Returns the ranges of file scanlines to be written as bands. For scanline output
+// the bands follow the rows of Gaffer tiles so that each tile is computed only once.
+// For tiled output they must follow the rows of tiles in the file, which are aligned
+// to the top of the data window.
+void bandRanges( const Format &format, const Box2i &dataWindow, bool tiled, vector<V2i> &ranges )
+{
+	const Box2i fileDataWindow = format.formatToYDownSpace( dataWindow );
+	if( tiled )
+	{
+		for( int y = fileDataWindow.min.y; y <= fileDataWindow.max.y; y += ImagePlug::tileSize() )
+		{
+			ranges.push_back( V2i( y, std::min( y + ImagePlug::tileSize(), fileDataWindow.max.y + 1 ) ) );
+		}
+	}
+	else
+	{
+		const int minTileOriginY = ImagePlug::tileOrigin( dataWindow.min ).y;
+		for( int tileOriginY = ImagePlug::tileOrigin( dataWindow.max ).y; tileOriginY >= minTileOriginY; tileOriginY -= ImagePlug::tileSize() )
+		{
+			const int yUpMin = std::max( tileOriginY, dataWindow.min.y );
+			const int yUpMax = std::min( tileOriginY + ImagePlug::tileSize() - 1, dataWindow.max.y );
+			ranges.push_back( V2i( format.formatToYDownSpace( yUpMax ), format.formatToYDownSpace( yUpMin ) + 1 ) );
+		}
+	}
+}
+
+// Returns the layer a channel belongs to - the prefix preceding the
+// last "." in its name.
+std::string layerName( const std::string &channelName )
+{
+	const size_t i = channelName.find_last_of( '.' );
+	return i == std::string::npos ? std::string( "" ) : channelName.substr( 0, i );
+}
+
+// A part (subimage) of the output file, and the channels it holds.
+struct Part
+{
+	std::string name;
+	vector<string> channels;
+};
+
+// Distributes the channels between parts, grouping them by layer if
+// multiPart is true, and otherwise putting them all in a single part.
+void partition( const vector<string> &channels, bool multiPart, vector<Part> &parts )
+{
+	for( vector<string>::const_iterator it = channels.begin(), eIt = channels.end(); it != eIt; ++it )
+	{
+		std::string name = multiPart ? layerName( *it ) : "";
+		if( name == "" )
+		{
+			name = "rgba";
+		}
+
+		vector<Part>::iterator pIt = parts.begin();
+		while( pIt != parts.end() && pIt->name != name )
+		{
+			++pIt;
+		}
+
+		if( pIt == parts.end() )
+		{
+			parts.push_back( Part() );
+			parts.back().name = name;
+			pIt = parts.end() - 1;
+		}
+
+		pIt->channels.push_back( *it );
+	}
+}
+
+// Streams the channels of a single part to the file, which must already
+// have been opened with the appropriate spec. The image is written band by
+// band, computing the tiles for the following bands in parallel while the
+// current band is written.
+void writePart( ImageOutput *out, const ImageSpec &spec, const ImagePlug *plug, const vector<string> &channels, const Context *context, const Format &format, const Box2i &dataWindow, bool imageIsBlack, bool tiled, const std::string &fileName )
+{
+	vector<V2i> ranges;
+	bandRanges( format, dataWindow, tiled, ranges );
+	vector<Band> bands( g_maxBandsInFlight );
+
+	tbb::parallel_pipeline(
+		g_maxBandsInFlight,
+		tbb::make_filter<void, Band *>(
+			tbb::filter::serial_in_order,
+			BandGenerator( ranges, bands, spec.width * channels.size() )
+		) &
+		tbb::make_filter<Band *, Band *>(
+			tbb::filter::parallel,
+			BandComputer( plug, channels, context, format, dataWindow, imageIsBlack )
+		) &
+		tbb::make_filter<Band *, void>(
+			tbb::filter::serial_in_order,
+			BandWriter( out, spec, tiled, fileName )
+		)
+	);
+}
+
+} // namespace
+
 //////////////////////////////////////////////////////////////////////////
 // ImageWriter implementation
 //////////////////////////////////////////////////////////////////////////
@@ -74,6 +395,20 @@ ImageWriter::ImageWriter( const std::string &name )
 			Gaffer::Plug::Default & ~(Gaffer::Plug::Dynamic | Gaffer::Plug::ReadOnly)
 		)
 	);
+	addChild( new IntPlug( "dataType", Plug::In, Float, Float, Half ) );
+
+	StringVectorDataPtr floatChannelsData = new StringVectorData();
+	floatChannelsData->writable().push_back( "Z" );
+	addChild(
+		new ChannelMaskPlug(
+			"floatChannels",
+			Gaffer::Plug::In,
+			floatChannelsData,
+			Gaffer::Plug::Default & ~(Gaffer::Plug::Dynamic | Gaffer::Plug::ReadOnly)
+		)
+	);
+	addChild( new StringPlug( "compression" ) );
+	addChild( new BoolPlug( "multiPart" ) );
 	
 	Node::plugSetSignal().connect( boost::bind( &GafferImage::ImageWriter::plugSet, this, ::_1 ) );
 }
@@ -153,16 +488,65 @@ const GafferImage::ChannelMaskPlug *ImageWriter::channelsPlug() const
 	return getChild<ChannelMaskPlug>( g_firstPlugIndex+3 );
 }
 
+Gaffer::IntPlug *ImageWriter::dataTypePlug()
+{
+	return getChild<IntPlug>( g_firstPlugIndex+4 );
+}
+
+const Gaffer::IntPlug *ImageWriter::dataTypePlug() const
+{
+	return getChild<IntPlug>( g_firstPlugIndex+4 );
+}
+
+GafferImage::ChannelMaskPlug *ImageWriter::floatChannelsPlug()
+{
+	return getChild<ChannelMaskPlug>( g_firstPlugIndex+5 );
+}
+
+const GafferImage::ChannelMaskPlug *ImageWriter::floatChannelsPlug() const
+{
+	return getChild<ChannelMaskPlug>( g_firstPlugIndex+5 );
+}
+
+Gaffer::StringPlug *ImageWriter::compressionPlug()
+{
+	return getChild<StringPlug>( g_firstPlugIndex+6 );
+}
+
+const Gaffer::StringPlug *ImageWriter::compressionPlug() const
+{
+	return getChild<StringPlug>( g_firstPlugIndex+6 );
+}
+
+Gaffer::BoolPlug *ImageWriter::multiPartPlug()
+{
+	return getChild<BoolPlug>( g_firstPlugIndex+7 );
+}
+
+const Gaffer::BoolPlug *ImageWriter::multiPartPlug() const
+{
+	return getChild<BoolPlug>( g_firstPlugIndex+7 );
+}
+
 IECore::MurmurHash ImageWriter::executionHash( const Context *context ) const
 {
+	// Images are always written at full resolution, whatever
+	// level of detail the context may be requesting.
+	ContextPtr fullResolutionContext = new Context( *context, Context::Borrowed );
+	fullResolutionContext->set( ImagePlug::lodContextName, 0 );
+	Context::Scope scopedContext( fullResolutionContext );
+
 	IECore::MurmurHash h = fileNamePlug()->hash();
 	h.append( inPlug()->imageHash() );
+	channelsPlug()->hash( h );
+	writeModePlug()->hash( h );
+	dataTypePlug()->hash( h );
+	floatChannelsPlug()->hash( h );
+	compressionPlug()->hash( h );
+	multiPartPlug()->hash( h );
 	return h;
 }
 
-///\todo: We are currently computing all of the channels regardless of whether or not we are outputting them.
-/// Change the execute() method to only compute the channels that are masked by the channelsPlug().
-
 ///\todo: It seems that if a JPG is written with RGBA channels the output is wrong but it should be supported. Find out why and fix it.
 /// There is a test case in ImageWriterTest which checks the output of the jpg writer against an incorrect image and it will fail if it is equal to the writer output.
 void ImageWriter::execute( const Contexts &contexts ) const
@@ -175,10 +559,14 @@ void ImageWriter::execute( const Contexts &contexts ) const
 	// Loop over the execution contexts...
 	for( Contexts::const_iterator it = contexts.begin(), eIt = contexts.end(); it != eIt; it++ )
 	{
-		Context::Scope scopedContext( it->get() );
+		// Images are always written at full resolution, whatever
+		// level of detail the context may be requesting.
+		ContextPtr fullResolutionContext = new Context( *(it->get()), Context::Borrowed );
+		fullResolutionContext->set( ImagePlug::lodContextName, 0 );
+		Context::Scope scopedContext( fullResolutionContext );
 		
 		std::string fileName = fileNamePlug()->getValue();
-		fileName = (*it)->substitute( fileName );
+		fileName = fullResolutionContext->substitute( fileName );
 		
 		boost::shared_ptr< ImageOutput > out( ImageOutput::create( fileName.c_str() ) );
 		if ( !out )
@@ -190,164 +578,117 @@ void ImageWriter::execute( const Contexts &contexts ) const
 		IECore::ConstStringVectorDataPtr channelNamesData = inPlug()->channelNamesPlug()->getValue();
 		std::vector<std::string> maskChannels = channelNamesData->readable();
 		channelsPlug()->maskChannels( maskChannels );
-		const int nChannels = maskChannels.size();
 		
-		// Get the image channel data.
-		IECore::ImagePrimitivePtr imagePtr( inPlug()->image() );
+		const Format format = inPlug()->formatPlug()->getValue();
+		const Imath::Box2i displayWindow( format.getDisplayWindow() );
 		
-		// Get the image's display window.
-		const Imath::Box2i displayWindow( imagePtr->getDisplayWindow() );
-		const int displayWindowWidth = displayWindow.size().x+1;
-		const int displayWindowHeight = displayWindow.size().y+1;
-
-		// Get the image's data window and if it then set a flag.
+		// Get the image's data window and if it is empty then set a flag.
 		bool imageIsBlack = false;
-		Imath::Box2i dataWindow( imagePtr->getDataWindow() );
-		if ( inPlug()->dataWindowPlug()->getValue().isEmpty() )
+		Imath::Box2i dataWindow( inPlug()->dataWindowPlug()->getValue() );
+		if ( dataWindow.isEmpty() )
 		{
 			dataWindow = displayWindow;
 			imageIsBlack = true;
 		}
 
-		int dataWindowWidth = dataWindow.size().x+1;
-		int dataWindowHeight = dataWindow.size().y+1;
-	
-		// Create the image header. 
-		ImageSpec spec( dataWindowWidth, dataWindowHeight, nChannels, TypeDesc::FLOAT );
+		// The data window in the Y-down space of the file.
+		const Imath::Box2i fileDataWindow( format.formatToYDownSpace( dataWindow ) );
 
-		// Add the channel names to the header whilst getting pointers to the channel data. 
-		std::vector<const float*> channelPtrs;
-		spec.channelnames.clear();
-		for ( std::vector<std::string>::iterator channelIt( maskChannels.begin() ); channelIt != maskChannels.end(); channelIt++ )
-		{
-			spec.channelnames.push_back( *channelIt );
-			IECore::FloatVectorDataPtr dataPtr = imagePtr->getChannel<float>( *channelIt );
-			channelPtrs.push_back( &(dataPtr->readable()[0]) );
+		// Only allow tiled output if our file format supports it.
+		const bool tiled = writeModePlug()->getValue() == Tile && out->supports( "tiles" );
 
-			// OIIO has a special attribute for the Alpha and Z channels. If we find some, we should tag them...
-			if ( *channelIt == "A" )
-			{
-				spec.alpha_channel = channelIt-maskChannels.begin();
-			} else if ( *channelIt == "Z" )
-			{
-				spec.z_channel = channelIt-maskChannels.begin();
-			}
-		}
-		
-		// Specify the display window.
-		spec.full_x = displayWindow.min.x;
-		spec.full_y = displayWindow.min.y;
-		spec.full_width = displayWindowWidth;
-		spec.full_height = displayWindowHeight;
-		spec.x = dataWindow.min.x;
-		spec.y = dataWindow.min.y;
-	
-		if ( !out->open( fileName, spec ) )
+		// Split the channels into parts. Formats which can't store multiple
+		// subimages just get everything in a single part.
+		bool multiPart = multiPartPlug()->getValue();
+		if( multiPart && !out->supports( "multiimage" ) )
 		{
-			throw IECore::Exception( boost::str( boost::format( "Could not open \"%s\", error = %s" ) % fileName % out->geterror() ) );
+			IECore::msg( IECore::Msg::Warning, "ImageWriter::execute", boost::format( "Format of \"%s\" does not support multiple parts - writing a single part instead." ) % fileName );
+			multiPart = false;
 		}
 
-		// Only allow tiled output if our file format supports it.	
-		int writeMode = writeModePlug()->getValue() & out->supports( "tile" );
-	
-		if ( writeMode == Scanline )
+		vector<Part> parts;
+		partition( maskChannels, multiPart, parts );
+
+		const TypeDesc defaultType = dataTypePlug()->getValue() == Half ? TypeDesc::HALF : TypeDesc::FLOAT;
+		const std::string compression = compressionPlug()->getValue();
+
+		vector<ImageSpec> specs;
+		for( vector<Part>::const_iterator pIt = parts.begin(), peIt = parts.end(); pIt != peIt; ++pIt )
 		{
-			// Create a buffer for the scanline.
-			float scanline[ nChannels*dataWindowWidth ];
-			
-			if ( imageIsBlack )
+			// Create the image header.
+			ImageSpec spec( dataWindow.size().x + 1, dataWindow.size().y + 1, pIt->channels.size(), defaultType );
+
+			// Add the channel names to the header, along with their data types.
+			// We only need per-channel formats if some channels differ from the default.
+			vector<string> floatChannels( pIt->channels );
+			floatChannelsPlug()->maskChannels( floatChannels );
+			const bool mixedTypes = defaultType != TypeDesc::FLOAT && floatChannels.size() && out->supports( "channelformats" );
+
+			spec.channelnames.clear();
+			spec.channelformats.clear();
+			for ( std::vector<std::string>::const_iterator channelIt( pIt->channels.begin() ); channelIt != pIt->channels.end(); channelIt++ )
 			{
-				memset( scanline, 0, sizeof(float) * nChannels*dataWindowWidth );
+				spec.channelnames.push_back( *channelIt );
+				if( mixedTypes )
+				{
+					const bool isFloat = std::find( floatChannels.begin(), floatChannels.end(), *channelIt ) != floatChannels.end();
+					spec.channelformats.push_back( isFloat ? TypeDesc::FLOAT : defaultType );
+				}
 
-				for ( int y = spec.y; y < spec.y + dataWindowHeight; ++y )
+				// OIIO has a special attribute for the Alpha and Z channels. If we find some, we should tag them...
+				if ( *channelIt == "A" )
 				{
-					if ( !out->write_scanline( y, 0, TypeDesc::FLOAT, &scanline[0] ) )
-					{
-						throw IECore::Exception( boost::str( boost::format( "Could not write scanline to \"%s\", error = %s" ) % fileName % out->geterror() ) );
-					}
+					spec.alpha_channel = channelIt-pIt->channels.begin();
+				} else if ( *channelIt == "Z" )
+				{
+					spec.z_channel = channelIt-pIt->channels.begin();
 				}
 			}
-			else
+			
+			// Specify the display window.
+			spec.full_x = displayWindow.min.x;
+			spec.full_y = displayWindow.min.y;
+			spec.full_width = displayWindow.size().x + 1;
+			spec.full_height = displayWindow.size().y + 1;
+			spec.x = fileDataWindow.min.x;
+			spec.y = fileDataWindow.min.y;
+
+			if( tiled )
 			{
-				// Interleave the channel data and write it by scanline to the file.	
-				for ( int y = spec.y; y < spec.y + dataWindowHeight; ++y )
-				{
-					for ( std::vector<const float *>::iterator channelDataIt( channelPtrs.begin() ); channelDataIt != channelPtrs.end(); channelDataIt++ )
-					{
-						float *outPtr = &scanline[0] + (channelDataIt - channelPtrs.begin()); // The pointer that we are writing to.
-						// The row that we are reading from is flipped (in the Y) as we use a different image space internally to OpenEXR and OpenImageIO.
-						const float *inRowPtr = (*channelDataIt) + ( y - spec.y ) * dataWindowWidth;
-						const int inc = channelPtrs.size();
-						for ( int x = 0; x < dataWindowWidth; ++x, outPtr += inc )
-						{
-							*outPtr = *inRowPtr++;
-						}
-					}
+				spec.tile_width = spec.tile_height = ImagePlug::tileSize();
+			}
 
-					if ( !out->write_scanline( y, 0, TypeDesc::FLOAT, &scanline[0] ) )
-					{
-						throw IECore::Exception( boost::str( boost::format( "Could not write scanline to \"%s\", error = %s" ) % fileName % out->geterror() ) );
-					}
-				}
+			if( compression != "" )
+			{
+				spec.attribute( "compression", compression );
 			}
-		}
-		// Tiled output
-		else
-		{
-			// Create a buffer for the tile.
-			const int tileSize = ImagePlug::tileSize();
-			float tile[ nChannels*tileSize*tileSize ];
 
-			if ( imageIsBlack )
+			if( multiPart )
 			{
-				memset( tile, 0,  sizeof(float) * nChannels*tileSize*tileSize );
-				for ( int tileY = 0; tileY < dataWindowHeight; tileY += tileSize )
-				{
-					for ( int tileX = 0; tileX < dataWindowWidth; tileX += tileSize )
-					{
-						if ( !out->write_tile( tileX+dataWindow.min.x, tileY+spec.y, 0, TypeDesc::FLOAT, &tile[0] ) )
-						{
-							throw IECore::Exception( boost::str( boost::format( "Could not write tile to \"%s\", error = %s" ) % fileName % out->geterror() ) );
-						}
-					}
-				}
+				spec.attribute( "oiio:subimagename", pIt->name );
 			}
-			else
+
+			specs.push_back( spec );
+		}
+
+		// Open the file, declaring all the parts up front, as is required
+		// for multi-part files.
+		const bool opened = specs.size() == 1 ? out->open( fileName, specs[0] ) : out->open( fileName, specs.size(), &(specs[0]) );
+		if ( !opened )
+		{
+			throw IECore::Exception( boost::str( boost::format( "Could not open \"%s\", error = %s" ) % fileName % out->geterror() ) );
+		}
+
+		for( size_t i = 0; i < parts.size(); ++i )
+		{
+			if( i > 0 && !out->open( fileName, specs[i], ImageOutput::AppendSubimage ) )
 			{
-				// Interleave the channel data and write it to the file tile-by-tile.
-				for ( int tileY = 0; tileY < dataWindowHeight; tileY += tileSize )
-				{
-					for ( int tileX = 0; tileX < dataWindowWidth; tileX += tileSize )
-					{
-						float *outPtr = &tile[0];	
-
-						const int r = std::min( tileSize+tileX, dataWindowWidth );
-						const int t = std::min( tileSize+tileY, dataWindowHeight );
-
-						for ( int y = 0; y < t; ++y )
-						{
-							for ( std::vector<const float *>::iterator channelDataIt( channelPtrs.begin() ); channelDataIt != channelPtrs.end(); channelDataIt++ )
-							{
-								const int inc = channelPtrs.size();
-								const float *inRowPtr = (*channelDataIt) + ( tileY + t - y - 1 ) * dataWindowWidth;
-								for ( int x = 0; x < r; ++x, outPtr += inc )
-								{
-									*outPtr = *inRowPtr+(tileX+x);
-								}
-							}
-						}
-
-						if ( !out->write_tile( tileX+dataWindow.min.x, tileY+spec.y, 0, TypeDesc::FLOAT, &tile[0] ) )
-						{
-							throw IECore::Exception( boost::str( boost::format( "Could not write tile to \"%s\", error = %s" ) % fileName % out->geterror() ) );
-						}
-					}
-				}
+				throw IECore::Exception( boost::str( boost::format( "Could not append part \"%s\" to \"%s\", error = %s" ) % parts[i].name % fileName % out->geterror() ) );
 			}
 
+			writePart( out.get(), specs[i], inPlug(), parts[i].channels, fullResolutionContext.get(), format, dataWindow, imageIsBlack, tiled, fileName );
 		}
 
 		out->close();
 	}
 }
-
@@ -40,19 +40,81 @@
 using namespace IECore;
 using namespace Gaffer;
 
-// Create a set of functions to perform the different operations.
-typedef float (*Op)( float A, float B, float a, float b );
-float opAdd( float A, float B, float a, float b){ return A + B; }
-float opAtop( float A, float B, float a, float b){ return A*b + B*(1.-a); }
-float opDivide( float A, float B, float a, float b){ return A / B; }
-float opIn( float A, float B, float a, float b){ return A*b; }
-float opOut( float A, float B, float a, float b){ return A*(1.-b); }
-float opMask( float A, float B, float a, float b){ return B*a; }
-float opMatte( float A, float B, float a, float b){ return A*a + B*(1.-a); }
-float opMultiply( float A, float B, float a, float b){ return A * B; }
-float opOver( float A, float B, float a, float b){ return A + B*(1.-a); }
-float opSubtract( float A, float B, float a, float b){ return A - B; }
-float opUnder( float A, float B, float a, float b){ return A*(1.-b) + B; }
+// Functors to perform the different operations. They are templated so that
+// they can operate both on individual floats and on SIMD::Float vectors. Each
+// also declares whether merging a black, transparent B leaves A unchanged, and
+// whether an opaque A hides B completely, so that such tiles can be skipped.
+
+namespace
+{
+
+struct OpAdd
+{
+	enum { blackBIsIdentity = true, opaqueAHidesB = false };
+	template<typename T> T operator()( const T &A, const T &B, const T &a, const T &b ) const { return A + B; }
+};
+
+struct OpAtop
+{
+	enum { blackBIsIdentity = false, opaqueAHidesB = false };
+	template<typename T> T operator()( const T &A, const T &B, const T &a, const T &b ) const { return A*b + B*( T( 1.0f ) - a ); }
+};
+
+struct OpDivide
+{
+	enum { blackBIsIdentity = false, opaqueAHidesB = false };
+	template<typename T> T operator()( const T &A, const T &B, const T &a, const T &b ) const { return A / B; }
+};
+
+struct OpIn
+{
+	enum { blackBIsIdentity = false, opaqueAHidesB = false };
+	template<typename T> T operator()( const T &A, const T &B, const T &a, const T &b ) const { return A*b; }
+};
+
+struct OpOut
+{
+	enum { blackBIsIdentity = true, opaqueAHidesB = false };
+	template<typename T> T operator()( const T &A, const T &B, const T &a, const T &b ) const { return A*( T( 1.0f ) - b ); }
+};
+
+struct OpMask
+{
+	enum { blackBIsIdentity = false, opaqueAHidesB = false };
+	template<typename T> T operator()( const T &A, const T &B, const T &a, const T &b ) const { return B*a; }
+};
+
+struct OpMatte
+{
+	enum { blackBIsIdentity = false, opaqueAHidesB = true };
+	template<typename T> T operator()( const T &A, const T &B, const T &a, const T &b ) const { return A*a + B*( T( 1.0f ) - a ); }
+};
+
+struct OpMultiply
+{
+	enum { blackBIsIdentity = false, opaqueAHidesB = false };
+	template<typename T> T operator()( const T &A, const T &B, const T &a, const T &b ) const { return A * B; }
+};
+
+struct OpOver
+{
+	enum { blackBIsIdentity = true, opaqueAHidesB = true };
+	template<typename T> T operator()( const T &A, const T &B, const T &a, const T &b ) const { return A + B*( T( 1.0f ) - a ); }
+};
+
+struct OpSubtract
+{
+	enum { blackBIsIdentity = true, opaqueAHidesB = false };
+	template<typename T> T operator()( const T &A, const T &B, const T &a, const T &b ) const { return A - B; }
+};
+
+struct OpUnder
+{
+	enum { blackBIsIdentity = true, opaqueAHidesB = false };
+	template<typename T> T operator()( const T &A, const T &B, const T &a, const T &b ) const { return A*( T( 1.0f ) - b ) + B; }
+};
+
+} // namespace
 
 namespace GafferImage
 {
@@ -88,7 +150,18 @@ void Merge::affects( const Gaffer::Plug *input, AffectedPlugsContainer &outputs
 	{
 		outputs.push_back( outPlug()->channelDataPlug() );	
 	}
-	else FilterProcessor::affects( input, outputs );
+	else
+	{
+		FilterProcessor::affects( input, outputs );
+
+		// We only merge the inputs which overlap each tile, so the
+		// output channel data also depends on their data windows.
+		const ImagePlug *inputImage = input->parent<ImagePlug>();
+		if( inputImage && inputImage->direction() == Plug::In && input == inputImage->dataWindowPlug() )
+		{
+			outputs.push_back( outPlug()->channelDataPlug() );
+		}
+	}
 }
 
 bool Merge::enabled() const
@@ -104,45 +177,131 @@ bool Merge::enabled() const
 
 void Merge::hashChannelData( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
 {
-	FilterProcessor::hashChannelData( output, context, h );
-	operationPlug()->hash( h );
+	const Imath::V2i tileOrigin = context->get<Imath::V2i>( ImagePlug::tileOriginContextName );
+	const int operation = operationPlug()->getValue();
+
+	std::vector<const ImagePlug *> inputs;
+	connectedInputs( inputs );
+
+	// Find out which of the inputs actually overlap the tile, so that
+	// we needn't hash the others at all.
+	std::vector<bool> inputIsEmpty;
+	size_t numEmpty = 0;
+	for( std::vector<const ImagePlug *>::const_iterator it = inputs.begin(), eIt = inputs.end(); it != eIt; ++it )
+	{
+		inputIsEmpty.push_back( tileCoverage( tileOrigin, (*it)->dataWindowPlug()->getValue() ) == EmptyTile );
+		numEmpty += inputIsEmpty.back();
+	}
+
+	if( numEmpty == inputs.size() )
+	{
+		// computeChannelData() will output black.
+		h = blackTileHash();
+		return;
+	}
+
+	if( numEmpty == inputs.size() - 1 && !inputIsEmpty.back() && blackInputIsIdentity( operation ) )
+	{
+		// Only the last input contributes, and doMergeOperation() will
+		// return its tile unchanged, so we can pass through its hash.
+		h = inputs.back()->channelDataPlug()->hash();
+		return;
+	}
+
+	// We deliberately bypass FilterProcessor::hashChannelData(), because
+	// it hashes every input, whether or not it overlaps the tile.
+	ImageProcessor::hashChannelData( output, context, h );
+
+	for( size_t i = 0; i < inputs.size(); ++i )
+	{
+		h.append( (int)inputIsEmpty[i] );
+		if( !inputIsEmpty[i] )
+		{
+			inputs[i]->channelDataPlug()->hash( h );
+			h.append( inputs[i]->channelDataHash( "A", tileOrigin ) );
+		}
+	}
+
+	h.append( operation );
 }
 
 IECore::ConstFloatVectorDataPtr Merge::computeChannelData( const std::string &channelName, const Imath::V2i &tileOrigin, const Gaffer::Context *context, const ImagePlug *parent ) const
 {
-	std::vector< ConstFloatVectorDataPtr > inData;
-	std::vector< ConstFloatVectorDataPtr > inAlpha;
-	
+	std::vector<const ImagePlug *> inputs;
+	connectedInputs( inputs );
+
+	bool allEmpty = true;
+	for( std::vector<const ImagePlug *>::const_iterator it = inputs.begin(), eIt = inputs.end(); it != eIt && allEmpty; ++it )
+	{
+		allEmpty = tileCoverage( tileOrigin, (*it)->dataWindowPlug()->getValue() ) == EmptyTile;
+	}
+
+	if( allEmpty )
+	{
+		return ImagePlug::blackTile();
+	}
+
+	// Get a pointer to the operation that we wish to perform.
+	int operation = operationPlug()->getValue();
+	switch( operation )
+	{
+		default:
+		case( kAdd ): return doMergeOperation( OpAdd(), inputs, channelName, tileOrigin ); break;
+		case( kAtop ): return doMergeOperation( OpAtop(), inputs, channelName, tileOrigin ); break;
+		case( kDivide ): return doMergeOperation( OpDivide(), inputs, channelName, tileOrigin ); break;
+		case( kIn ): return doMergeOperation( OpIn(), inputs, channelName, tileOrigin ); break;
+		case( kOut ): return doMergeOperation( OpOut(), inputs, channelName, tileOrigin ); break;
+		case( kMask ): return doMergeOperation( OpMask(), inputs, channelName, tileOrigin ); break;
+		case( kMatte ): return doMergeOperation( OpMatte(), inputs, channelName, tileOrigin ); break;
+		case( kMultiply ): return doMergeOperation( OpMultiply(), inputs, channelName, tileOrigin ); break;
+		case( kOver ): return doMergeOperation( OpOver(), inputs, channelName, tileOrigin ); break;
+		case( kSubtract ): return doMergeOperation( OpSubtract(), inputs, channelName, tileOrigin ); break;
+		case( kUnder ): return doMergeOperation( OpUnder(), inputs, channelName, tileOrigin ); break;
+	}
+
+	// We should never get here...
+	return doMergeOperation( OpAdd(), inputs, channelName, tileOrigin );
+}
+
+void Merge::connectedInputs( std::vector<const ImagePlug *> &inputs ) const
+{
 	const ImagePlugList::const_iterator end( m_inputs.endIterator() );
 	for( ImagePlugList::const_iterator it( m_inputs.inputs().begin() ); it != end; it++ )
 	{
 		if ( (*it)->getInput<ValuePlug>() )
 		{
-			inData.push_back( (*it)->channelData( channelName, tileOrigin ) );
-			inAlpha.push_back( (*it)->channelData( "A", tileOrigin ) );
+			inputs.push_back( it->get() );
 		}
 	}
+}
 
-	// Get a pointer to the operation that we wish to perform.
-	int operation = operationPlug()->getValue();
+bool Merge::blackInputIsIdentity( int operation )
+{
 	switch( operation )
 	{
 		default:
-		case( kAdd ): return doMergeOperation( opAdd, inData, inAlpha, tileOrigin ); break;
-		case( kAtop ): return doMergeOperation( opAtop, inData, inAlpha, tileOrigin ); break;
-		case( kDivide ): return doMergeOperation( opDivide, inData, inAlpha, tileOrigin ); break;
-		case( kIn ): return doMergeOperation( opIn, inData, inAlpha, tileOrigin ); break;
-		case( kOut ): return doMergeOperation( opOut, inData, inAlpha, tileOrigin ); break;
-		case( kMask ): return doMergeOperation( opMask, inData, inAlpha, tileOrigin ); break;
-		case( kMatte ): return doMergeOperation( opMatte, inData, inAlpha, tileOrigin ); break;
-		case( kMultiply ): return doMergeOperation( opMultiply, inData, inAlpha, tileOrigin ); break;
-		case( kOver ): return doMergeOperation( opOver, inData, inAlpha, tileOrigin ); break;
-		case( kSubtract ): return doMergeOperation( opSubtract, inData, inAlpha, tileOrigin ); break;
-		case( kUnder ): return doMergeOperation( opUnder, inData, inAlpha, tileOrigin ); break;
+		case( kAdd ): return OpAdd::blackBIsIdentity;
+		case( kAtop ): return OpAtop::blackBIsIdentity;
+		case( kDivide ): return OpDivide::blackBIsIdentity;
+		case( kIn ): return OpIn::blackBIsIdentity;
+		case( kOut ): return OpOut::blackBIsIdentity;
+		case( kMask ): return OpMask::blackBIsIdentity;
+		case( kMatte ): return OpMatte::blackBIsIdentity;
+		case( kMultiply ): return OpMultiply::blackBIsIdentity;
+		case( kOver ): return OpOver::blackBIsIdentity;
+		case( kSubtract ): return OpSubtract::blackBIsIdentity;
+		case( kUnder ): return OpUnder::blackBIsIdentity;
 	}
+}
 
-	// We should never get here...
-	return doMergeOperation( opAdd, inData, inAlpha, tileOrigin );
+IECore::ConstFloatVectorDataPtr Merge::inputChannelData( const ImagePlug *input, const std::string &channelName, const Imath::V2i &tileOrigin ) const
+{
+	// Tiles outside the data window are black, so we can avoid computing them.
+	if( tileCoverage( tileOrigin, input->dataWindowPlug()->getValue() ) == EmptyTile )
+	{
+		return ImagePlug::blackTile();
+	}
+	return input->channelData( channelName, tileOrigin );
 }
 
 bool Merge::hasAlpha( ConstStringVectorDataPtr channelNamesData ) const
@@ -35,11 +35,15 @@
 //  
 //////////////////////////////////////////////////////////////////////////
 
+#include <cmath>
+
 #include "tbb/mutex.h"
 #include "tbb/null_mutex.h"
 
 #include "OpenColorIO/OpenColorIO.h"
 
+#include "IECore/LRUCache.h"
+
 #include "Gaffer/Context.h"
 
 #include "GafferImage/OpenColorIO.h"
@@ -71,6 +75,198 @@ typedef tbb::null_mutex OCIOMutex;
 
 static OCIOMutex g_ocioMutex;
 
+// Identifies a processor, or a LUT baked from it, by the
+// config and colour spaces it was created from.
+struct ProcessorCacheKey
+{
+
+	ProcessorCacheKey()
+	{
+	}
+
+	ProcessorCacheKey( const std::string &inputSpace, const std::string &outputSpace, int lutSize = 0 )
+		:	inputSpace( inputSpace ), outputSpace( outputSpace ), lutSize( lutSize )
+	{
+		{
+			OCIOMutex::scoped_lock lock( g_ocioMutex );
+			hash.append( ::OpenColorIO::GetCurrentConfig()->getCacheID() );
+		}
+		hash.append( inputSpace );
+		hash.append( outputSpace );
+		hash.append( lutSize );
+	}
+
+	bool operator == ( const ProcessorCacheKey &other ) const
+	{
+		return hash == other.hash;
+	}
+
+	std::string inputSpace;
+	std::string outputSpace;
+	int lutSize;
+	MurmurHash hash;
+
+};
+
+inline size_t tbb_hasher( const ProcessorCacheKey &cacheKey )
+{
+	return tbb_hasher( cacheKey.hash );
+}
+
+::OpenColorIO::ConstProcessorRcPtr processorGetter( const ProcessorCacheKey &key, size_t &cost )
+{
+	cost = 1;
+	OCIOMutex::scoped_lock lock( g_ocioMutex );
+	::OpenColorIO::ConstConfigRcPtr config = ::OpenColorIO::GetCurrentConfig();
+	return config->getProcessor( key.inputSpace.c_str(), key.outputSpace.c_str() );
+}
+
+typedef LRUCache<ProcessorCacheKey, ::OpenColorIO::ConstProcessorRcPtr> ProcessorCache;
+static ProcessorCache g_processorCache( processorGetter, 200 );
+
+// The LUT is indexed through a logarithmic shaper, so that its samples are spaced
+// evenly in stops rather than linearly. Display transforms are steepest in the
+// shadows, and a linear spacing would put only a single sample between 0 and
+// 1/32 for the default LUT size. The offset keeps the shaper finite at 0 and
+// sets the precision there, and the maximum lets the LUT cover values above 1.
+static const float g_shaperOffset = 1.0f / 256.0f;
+static const float g_shaperMax = 16.0f;
+static const float g_shaperLogMin = logf( g_shaperOffset );
+static const float g_shaperLogRange = logf( g_shaperMax + g_shaperOffset ) - g_shaperLogMin;
+
+// Maps inputs in the range 0 to g_shaperMax into the range 0-1.
+inline float shaper( float x )
+{
+	return ( logf( x + g_shaperOffset ) - g_shaperLogMin ) / g_shaperLogRange;
+}
+
+inline float inverseShaper( float s )
+{
+	return std::max( 0.0f, expf( g_shaperLogMin + s * g_shaperLogRange ) - g_shaperOffset );
+}
+
+// A 3D LUT baked from a processor, covering inputs in the range 0 to g_shaperMax,
+// indexed via shaper(). Values are stored as interleaved RGB triples, with red
+// varying fastest.
+struct LUT : public IECore::RefCounted
+{
+
+	int size;
+	std::vector<float> data;
+
+	// Returns true if the colour is within the domain of the LUT, in which case
+	// it is replaced with its tetrahedrally interpolated value from the LUT.
+	inline bool apply( float &r, float &g, float &b ) const
+	{
+		// Written so that NaNs fail the test too.
+		if( !( r >= 0.0f && r <= g_shaperMax && g >= 0.0f && g <= g_shaperMax && b >= 0.0f && b <= g_shaperMax ) )
+		{
+			return false;
+		}
+
+		const int maxIndex = size - 2;
+		const float fr = std::min( shaper( r ), 1.0f ) * ( size - 1 );
+		const float fg = std::min( shaper( g ), 1.0f ) * ( size - 1 );
+		const float fb = std::min( shaper( b ), 1.0f ) * ( size - 1 );
+		const int ir = std::min( (int)fr, maxIndex );
+		const int ig = std::min( (int)fg, maxIndex );
+		const int ib = std::min( (int)fb, maxIndex );
+		const float dr = fr - ir;
+		const float dg = fg - ig;
+		const float db = fb - ib;
+
+		const int strideG = size * 3;
+		const int strideB = size * size * 3;
+		const float *c000 = &(data[ib * strideB + ig * strideG + ir * 3]);
+		const float *c111 = c000 + strideB + strideG + 3;
+
+		// Find the tetrahedron containing the point, and the two corners
+		// other than c000 and c111 which define it, along with the
+		// weights for each edge of the path from c000 to c111.
+		const float *c1, *c2;
+		float w0, w1, w2;
+		if( dr > dg )
+		{
+			if( dg > db )
+			{
+				c1 = c000 + 3; c2 = c000 + strideG + 3; w0 = dr; w1 = dg; w2 = db;
+			}
+			else if( dr > db )
+			{
+				c1 = c000 + 3; c2 = c000 + strideB + 3; w0 = dr; w1 = db; w2 = dg;
+			}
+			else
+			{
+				c1 = c000 + strideB; c2 = c000 + strideB + 3; w0 = db; w1 = dr; w2 = dg;
+			}
+		}
+		else
+		{
+			if( db > dg )
+			{
+				c1 = c000 + strideB; c2 = c000 + strideB + strideG; w0 = db; w1 = dg; w2 = dr;
+			}
+			else if( db > dr )
+			{
+				c1 = c000 + strideG; c2 = c000 + strideB + strideG; w0 = dg; w1 = db; w2 = dr;
+			}
+			else
+			{
+				c1 = c000 + strideG; c2 = c000 + strideG + 3; w0 = dg; w1 = dr; w2 = db;
+			}
+		}
+
+		const float a0 = 1.0f - w0, a1 = w0 - w1, a2 = w1 - w2;
+		r = a0 * c000[0] + a1 * c1[0] + a2 * c2[0] + w2 * c111[0];
+		g = a0 * c000[1] + a1 * c1[1] + a2 * c2[1] + w2 * c111[1];
+		b = a0 * c000[2] + a1 * c1[2] + a2 * c2[2] + w2 * c111[2];
+		return true;
+	}
+
+};
+
+IE_CORE_DECLAREPTR( LUT );
+
+ConstLUTPtr lutGetter( const ProcessorCacheKey &key, size_t &cost )
+{
+	::OpenColorIO::ConstProcessorRcPtr processor = g_processorCache.get( ProcessorCacheKey( key.inputSpace, key.outputSpace ) );
+
+	LUTPtr result = new LUT;
+	result->size = key.lutSize;
+	result->data.resize( key.lutSize * key.lutSize * key.lutSize * 3 );
+
+	// The shaper is baked into the LUT by sampling the processor at the
+	// inputs which map to each grid point.
+	std::vector<float> inputs( key.lutSize );
+	for( int i = 0; i < key.lutSize; ++i )
+	{
+		inputs[i] = inverseShaper( (float)i / ( key.lutSize - 1 ) );
+	}
+
+	float *d = &(result->data[0]);
+	for( int b = 0; b < key.lutSize; ++b )
+	{
+		for( int g = 0; g < key.lutSize; ++g )
+		{
+			for( int r = 0; r < key.lutSize; ++r )
+			{
+				*d++ = inputs[r];
+				*d++ = inputs[g];
+				*d++ = inputs[b];
+			}
+		}
+	}
+
+	::OpenColorIO::PackedImageDesc image( &(result->data[0]), key.lutSize * key.lutSize * key.lutSize, 1, 3 );
+	processor->apply( image );
+
+	cost = result->data.size() * sizeof( float );
+	return result;
+}
+
+typedef LRUCache<ProcessorCacheKey, ConstLUTPtr> LUTCache;
+static LUTCache g_lutCache( lutGetter, 1024 * 1024 * 64 );
+
 } // namespace Detail
 
 IE_CORE_DEFINERUNTIMETYPED( OpenColorIO );
@@ -83,6 +279,8 @@ OpenColorIO::OpenColorIO( const std::string &name )
 	storeIndexOfNextChild( g_firstPlugIndex );
 	addChild( new StringPlug( "inputSpace" ) );
 	addChild( new StringPlug( "outputSpace" ) );
+	addChild( new BoolPlug( "bakeLUT" ) );
+	addChild( new IntPlug( "lutSize", Plug::In, 33, 2, 129 ) );
 }
 
 OpenColorIO::~OpenColorIO()
@@ -109,6 +307,26 @@ const Gaffer::StringPlug *OpenColorIO::outputSpacePlug() const
 	return getChild<StringPlug>( g_firstPlugIndex + 1 );
 }
 
+Gaffer::BoolPlug *OpenColorIO::bakeLUTPlug()
+{
+	return getChild<BoolPlug>( g_firstPlugIndex + 2 );
+}
+
+const Gaffer::BoolPlug *OpenColorIO::bakeLUTPlug() const
+{
+	return getChild<BoolPlug>( g_firstPlugIndex + 2 );
+}
+
+Gaffer::IntPlug *OpenColorIO::lutSizePlug()
+{
+	return getChild<IntPlug>( g_firstPlugIndex + 3 );
+}
+
+const Gaffer::IntPlug *OpenColorIO::lutSizePlug() const
+{
+	return getChild<IntPlug>( g_firstPlugIndex + 3 );
+}
+
 bool OpenColorIO::enabled() const
 {
 	if( !ColorProcessor::enabled() )
@@ -130,7 +348,12 @@ bool OpenColorIO::affectsColorData( const Gaffer::Plug *input ) const
 	{
 		return true;
 	}
-	return input == inputSpacePlug() || input == outputSpacePlug();
+	return
+		input == inputSpacePlug() ||
+		input == outputSpacePlug() ||
+		input == bakeLUTPlug() ||
+		input == lutSizePlug()
+	;
 }
 
 void OpenColorIO::hashColorData( const Gaffer::Context *context, IECore::MurmurHash &h ) const
@@ -139,20 +362,29 @@ void OpenColorIO::hashColorData( const Gaffer::Context *context, IECore::MurmurH
 	
 	inputSpacePlug()->hash( h );
 	outputSpacePlug()->hash( h );
+	if( bakeLUTPlug()->getValue() )
+	{
+		lutSizePlug()->hash( h );
+	}
+	else
+	{
+		h.append( false );
+	}
 }
 
 void OpenColorIO::processColorData( const Gaffer::Context *context, IECore::FloatVectorData *r, IECore::FloatVectorData *g, IECore::FloatVectorData *b ) const
 {
 	string inputSpace( inputSpacePlug()->getValue() );
 	string outputSpace( outputSpacePlug()->getValue() );
-	
-	::OpenColorIO::ConstProcessorRcPtr processor;
+
+	if( bakeLUTPlug()->getValue() )
 	{
-		Detail::OCIOMutex::scoped_lock lock( Detail::g_ocioMutex );
-		::OpenColorIO::ConstConfigRcPtr config = ::OpenColorIO::GetCurrentConfig();
-		processor = config->getProcessor( inputSpace.c_str(), outputSpace.c_str() );
+		processColorDataWithLUT( inputSpace, outputSpace, lutSizePlug()->getValue(), r, g, b );
+		return;
 	}
-			
+
+	::OpenColorIO::ConstProcessorRcPtr processor = Detail::g_processorCache.get( Detail::ProcessorCacheKey( inputSpace, outputSpace ) );
+
 	::OpenColorIO::PlanarImageDesc image(
 		r->baseWritable(),
 		g->baseWritable(),
@@ -165,4 +397,49 @@ void OpenColorIO::processColorData( const Gaffer::Context *context, IECore::Floa
 	processor->apply( image );
 }
 
+void OpenColorIO::processColorDataWithLUT( const std::string &inputSpace, const std::string &outputSpace, int lutSize, IECore::FloatVectorData *r, IECore::FloatVectorData *g, IECore::FloatVectorData *b ) const
+{
+	Detail::ConstLUTPtr lut = Detail::g_lutCache.get( Detail::ProcessorCacheKey( inputSpace, outputSpace, lutSize ) );
+
+	float *rp = r->baseWritable();
+	float *gp = g->baseWritable();
+	float *bp = b->baseWritable();
+	const int numPixels = r->readable().size();
+
+	// Apply the LUT to everything within its domain, and keep a note of
+	// anything outside it, to be processed accurately afterwards.
+	std::vector<int> unbaked;
+	for( int i = 0; i < numPixels; ++i )
+	{
+		if( !lut->apply( rp[i], gp[i], bp[i] ) )
+		{
+			unbaked.push_back( i );
+		}
+	}
+
+	if( unbaked.empty() )
+	{
+		return;
+	}
+
+	std::vector<float> packed( unbaked.size() * 3 );
+	for( size_t i = 0; i < unbaked.size(); ++i )
+	{
+		packed[i*3] = rp[unbaked[i]];
+		packed[i*3+1] = gp[unbaked[i]];
+		packed[i*3+2] = bp[unbaked[i]];
+	}
+
+	::OpenColorIO::ConstProcessorRcPtr processor = Detail::g_processorCache.get( Detail::ProcessorCacheKey( inputSpace, outputSpace ) );
+	::OpenColorIO::PackedImageDesc image( &(packed[0]), unbaked.size(), 1, 3 );
+	processor->apply( image );
+
+	for( size_t i = 0; i < unbaked.size(); ++i )
+	{
+		rp[unbaked[i]] = packed[i*3];
+		gp[unbaked[i]] = packed[i*3+1];
+		bp[unbaked[i]] = packed[i*3+2];
+	}
+}
+
 } // namespace GafferImage
@@ -35,8 +35,15 @@
 //  
 //////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+
+#include "IECore/LRUCache.h"
+
+#include "Gaffer/Context.h"
+
 #include "GafferImage/Reformat.h"
 #include "GafferImage/Sampler.h"
+#include "GafferImage/SIMD.h"
 
 using namespace Gaffer;
 using namespace IECore;
@@ -106,7 +113,7 @@ bool Reformat::enabled() const
 	}
 
 	Format inFormat( inPlug()->formatPlug()->getValue() );
-	Format outFormat( formatPlug()->getValue() );
+	Format outFormat( outputFormat() );
 		
 	return inFormat != outFormat;
 }
@@ -115,13 +122,14 @@ void Reformat::hashFormat( const GafferImage::ImagePlug *output, const Gaffer::C
 {
 	ImageProcessor::hashFormat( output, context, h );
 	formatPlug()->hash( h );
+	h.append( ImagePlug::lod( context ) );
 }
 
 void Reformat::hashDataWindow( const GafferImage::ImagePlug *output, const Gaffer::Context *context, IECore::MurmurHash &h ) const
 {
 	ImageProcessor::hashDataWindow( output, context, h );
 
-	Format format = formatPlug()->getValue();
+	Format format = outputFormat();
 	h.append( format.getDisplayWindow() );
 	h.append( format.getPixelAspect() );
 	
@@ -146,7 +154,7 @@ void Reformat::hashChannelData( const GafferImage::ImagePlug *output, const Gaff
 	
 	h.append( inPlug()->dataWindowPlug()->getValue() );
 	
-	Format format = formatPlug()->getValue();
+	Format format = outputFormat();
 	h.append( format.getDisplayWindow() );
 	h.append( format.getPixelAspect() );
 	
@@ -162,7 +170,7 @@ Imath::Box2i Reformat::computeDataWindow( const Gaffer::Context *context, const
 	Imath::Box2i inDataWindow( inPlug()->dataWindowPlug()->getValue() );
 
 	Imath::V2d inFormatOffset( inPlug()->formatPlug()->getValue().getDisplayWindow().min );
-	Imath::V2d outFormatOffset( formatPlug()->getValue().getDisplayWindow().min );
+	Imath::V2d outFormatOffset( outputFormat().getDisplayWindow().min );
 	
 	Imath::Box2i outDataWindow(
 		Imath::V2i(
@@ -180,7 +188,7 @@ Imath::Box2i Reformat::computeDataWindow( const Gaffer::Context *context, const
 
 GafferImage::Format Reformat::computeFormat( const Gaffer::Context *context, const ImagePlug *parent ) const
 {
-	return formatPlug()->getValue();
+	return outputFormat();
 }
 
 IECore::ConstStringVectorDataPtr Reformat::computeChannelNames( const Gaffer::Context *context, const ImagePlug *parent ) const
@@ -188,33 +196,171 @@ IECore::ConstStringVectorDataPtr Reformat::computeChannelNames( const Gaffer::Co
 	return inPlug()->channelNamesPlug()->getValue();
 }
 
+GafferImage::Format Reformat::outputFormat() const
+{
+	return ImagePlug::lodFormat( formatPlug()->getValue(), ImagePlug::lod( Context::current() ) );
+}
+
 Imath::V2d Reformat::scale() const
 {
 	Format inFormat( inPlug()->formatPlug()->getValue() );
-	Format outFormat( formatPlug()->getValue() );
+	Format outFormat( outputFormat() );
 	Imath::V2d inWH = Imath::V2d( inFormat.getDisplayWindow().size() ) + Imath::V2d(1.);
 	Imath::V2d outWH = Imath::V2d( outFormat.getDisplayWindow().size() ) + Imath::V2d(1.);
 	Imath::V2d scale( double( outWH.x ) / ( inWH.x ), double( outWH.y ) / inWH.y );
 	return scale;
 }
 
-struct Contribution
+//////////////////////////////////////////////////////////////////////////
+// LRUCache of filter weights
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// The filter weights for one axis of a tile. For each of the tileSize()
+// output pixels, this holds the first input pixel that contributes to it,
+// the number of input pixels that contribute, and their normalised weights.
+struct FilterWeights : public IECore::RefCounted
 {
-	int pixel;
-	float weight;
+
+	int width;
+	std::vector<int> taps;
+	std::vector<int> counts;
+	std::vector<float> weights;
+
+	int minTap() const
+	{
+		return *std::min_element( taps.begin(), taps.end() );
+	}
+
+	int maxTap() const
+	{
+		int result = taps[0] + counts[0] - 1;
+		for( size_t i = 1; i < taps.size(); ++i )
+		{
+			result = std::max( result, taps[i] + counts[i] - 1 );
+		}
+		return result;
+	}
+
 };
 
-IECore::ConstFloatVectorDataPtr Reformat::computeChannelData( const std::string &channelName, const Imath::V2i &tileOrigin, const Gaffer::Context *context, const ImagePlug *parent ) const
+IE_CORE_DECLAREPTR( FilterWeights );
+
+// Identifies the weights for one axis of a tile. The weights depend only
+// on the filter, the mapping from output to input pixels and the position
+// of the tile, so they can be shared by every channel and by every tile in
+// the same row or column.
+struct FilterWeightsCacheKey
 {
-	// Allocate the new tile
-	FloatVectorDataPtr outDataPtr = new FloatVectorData;
-	std::vector<float> &out = outDataPtr->writable();
-	out.resize( ImagePlug::tileSize() * ImagePlug::tileSize() );
 
+	FilterWeightsCacheKey()
+	{
+	}
+
+	FilterWeightsCacheKey( const std::string &filter, double scale, double offset, int tileOrigin )
+		:	filter( filter ), scale( scale ), offset( offset ), tileOrigin( tileOrigin )
+	{
+		hash.append( filter );
+		hash.append( scale );
+		hash.append( offset );
+		hash.append( tileOrigin );
+	}
+
+	bool operator == ( const FilterWeightsCacheKey &other ) const
+	{
+		return hash == other.hash;
+	}
+
+	std::string filter;
+	double scale;
+	double offset;
+	int tileOrigin;
+	MurmurHash hash;
+
+};
+
+inline size_t tbb_hasher( const FilterWeightsCacheKey &cacheKey )
+{
+	return tbb_hasher( cacheKey.hash );
+}
+
+ConstFilterWeightsPtr filterWeightsGetter( const FilterWeightsCacheKey &key, size_t &cost )
+{
+	ConstFilterPtr f = Filter::create( key.filter, 1.f / key.scale );
+
+	FilterWeightsPtr result = new FilterWeights;
+	result->width = f->width();
+	result->taps.resize( ImagePlug::tileSize() );
+	result->counts.resize( ImagePlug::tileSize() );
+	result->weights.resize( ImagePlug::tileSize() * result->width, 0.0f );
+
+	// Filter::tap() requires a positive center, so we compute taps
+	// relative to an origin to the left of all the centers.
+	const double firstCenter = ( key.tileOrigin + 0.5 ) / key.scale + key.offset;
+	const int tapOrigin = IECore::fastFloatFloor( firstCenter ) - 2 * result->width;
+
+	for( int i = 0; i < ImagePlug::tileSize(); ++i )
+	{
+		const float center = ( key.tileOrigin + i + 0.5 ) / key.scale + key.offset;
+		const int tap = f->tap( center - tapOrigin ) + tapOrigin;
+
+		// Find the weights, trimming any zero weights from either end.
+		float *weights = &(result->weights[i * result->width]);
+		int first = -1, last = -1;
+		float weightedSum = 0.0f;
+		for( int j = 0; j < result->width; ++j )
+		{
+			const float weight = f->weight( center, tap + j );
+			if( weight == 0.0f )
+			{
+				continue;
+			}
+			if( first == -1 )
+			{
+				first = j;
+			}
+			last = j;
+			weights[j] = weight;
+			weightedSum += weight;
+		}
+
+		if( first == -1 )
+		{
+			result->taps[i] = tap;
+			result->counts[i] = 0;
+			continue;
+		}
+
+		result->taps[i] = tap + first;
+		result->counts[i] = last - first + 1;
+		for( int j = first; j <= last; ++j )
+		{
+			weights[j-first] = weights[j] / weightedSum;
+		}
+		std::fill( weights + result->counts[i], weights + result->width, 0.0f );
+	}
+
+	cost = result->weights.size() * sizeof( float ) + result->taps.size() * 2 * sizeof( int );
+	return result;
+}
+
+typedef LRUCache<FilterWeightsCacheKey, ConstFilterWeightsPtr> FilterWeightsCache;
+FilterWeightsCache g_filterWeightsCache( filterWeightsGetter, 1024 * 1024 * 64 );
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+// Reformat implementation
+//////////////////////////////////////////////////////////////////////////
+
+IECore::ConstFloatVectorDataPtr Reformat::computeChannelData( const std::string &channelName, const Imath::V2i &tileOrigin, const Gaffer::Context *context, const ImagePlug *parent ) const
+{
 	// Create some useful variables...
 	Imath::V2f scaleFactor( scale() );
 	Imath::V2d inFormatOffset( inPlug()->formatPlug()->getValue().getDisplayWindow().min );
-	Imath::V2d outFormatOffset( formatPlug()->getValue().getDisplayWindow().min );
+	Imath::V2d outFormatOffset( outputFormat().getDisplayWindow().min );
 
 	Imath::Box2i outTile( tileOrigin, Imath::V2i( tileOrigin.x + ImagePlug::tileSize() - 1, tileOrigin.y + ImagePlug::tileSize() - 1 ) );
 
@@ -230,12 +376,18 @@ IECore::ConstFloatVectorDataPtr Reformat::computeChannelData( const std::string
 	);
 
 	// Create our filter.
-	FilterPtr f = Filter::create( filterPlug()->getValue(), 1.f / scaleFactor.y );
+	const std::string filterName = filterPlug()->getValue();
+	FilterPtr f = Filter::create( filterName, 1.f / scaleFactor.y );
 	
 	// If we are filtering with a box filter then just don't bother filtering
 	// at all and just integer sample instead...
 	if ( static_cast<GafferImage::TypeId>( f->typeId() ) == GafferImage::BoxFilterTypeId )
 	{
+		// Allocate the new tile
+		FloatVectorDataPtr outDataPtr = new FloatVectorData;
+		std::vector<float> &out = outDataPtr->writable();
+		out.resize( ImagePlug::tileSize() * ImagePlug::tileSize() );
+
 		Imath::V2d scaleFactorD( scale() );
 		Imath::Box2i sampleBox(
 			Imath::V2i( IECore::fastFloatFloor( inTile.min.x ), IECore::fastFloatCeil( inTile.min.y ) ),
@@ -254,146 +406,113 @@ IECore::ConstFloatVectorDataPtr Reformat::computeChannelData( const std::string
 		return outDataPtr;
 	}
 
-	// Get the dimensions of our filter and create a box that we can use to define the bounds of our input.
-	int fHeight = f->width();
-	
-	int sampleMinY = f->tap( inTile.min.y );
-	int sampleMaxY = f->tap( inTile.max.y );
-		
-	f->setScale( 1.f / scaleFactor.x );
-	int sampleMinX = f->tap( inTile.min.x );
-	int sampleMaxX = f->tap( inTile.max.x );
-	
-	int fWidth = f->width();
-
-	Imath::Box2i sampleBox(
-		Imath::V2i( sampleMinX, sampleMinY ),
-		Imath::V2i( sampleMaxX + fWidth, sampleMaxY + fHeight )
+	// Otherwise do a separable resample. The center of output pixel x maps to
+	// ( x + 0.5 - outFormatOffset ) / scale + inFormatOffset in the input.
+	const Imath::V2d scaleFactorD( scale() );
+	return resample(
+		inPlug(), channelName, tileOrigin, filterName, scaleFactorD,
+		inFormatOffset - outFormatOffset / scaleFactorD,
+		Sampler::Clamp
 	);
+}
 
-	int sampleBoxWidth = sampleBox.size().x + 1;
-	int sampleBoxHeight = sampleBox.size().y + 1;
+IECore::FloatVectorDataPtr Reformat::resample( const ImagePlug *image, const std::string &channelName, const Imath::V2i &tileOrigin, const std::string &filter, const Imath::V2d &scale, const Imath::V2d &offset, Sampler::BoundingMode boundingMode )
+{
+	FloatVectorDataPtr outDataPtr = new FloatVectorData;
+	std::vector<float> &out = outDataPtr->writable();
+	out.resize( ImagePlug::tileSize() * ImagePlug::tileSize() );
 
-	// Create a temporary buffer that we can write the result of the first pass to.
-	// We extend the buffer vertically as we will need additional information in the
-	// vertical squash (the second pass) to properly convolve the filter.
-	float buffer[ ImagePlug::tileSize() * sampleBoxHeight ];
-	
-	// Create several buffers for each pixel in the output row (or column depending on the pass)
-	// into which we can place the indices for the pixels that are contribute to it's result and
-	// their weight.
-	
-	// A buffer that holds a list of pixel contributions and their weights for every pixel in the output buffer.
-	// As it gets reused for both passes we make it large enough to hold both so that we don't have to resize it later.
-	std::vector<Contribution> contribution( ImagePlug::tileSize() * ( sampleBoxHeight > sampleBoxWidth ? sampleBoxHeight : sampleBoxWidth ) ); 
-	
-	// The total number of pixels that contribute towards each pixel in th resulting image.
-	std::vector<int> coverageTotal( ImagePlug::tileSize() );
+	// Get the weights for each axis. These are shared between all the channels,
+	// and all the tiles in the same row or column, so we cache them rather than
+	// recompute them for every tile.
+	ConstFilterWeightsPtr xWeights = g_filterWeightsCache.get(
+		FilterWeightsCacheKey( filter, scale.x, offset.x, tileOrigin.x )
+	);
+	ConstFilterWeightsPtr yWeights = g_filterWeightsCache.get(
+		FilterWeightsCacheKey( filter, scale.y, offset.y, tileOrigin.y )
+	);
 
-	// The total weighted sum of contribution that each pixel in the output gets.
-	// This value is used to normalize the result.
-	std::vector<float> weightedSum( ImagePlug::tileSize() );
+	// Gather all the input pixels which contribute to the tile into a buffer.
+	Imath::Box2i sampleBox(
+		Imath::V2i( xWeights->minTap(), yWeights->minTap() ),
+		Imath::V2i( xWeights->maxTap(), yWeights->maxTap() )
+	);
+
+	const int sampleBoxWidth = sampleBox.size().x + 1;
+	const int sampleBoxHeight = sampleBox.size().y + 1;
 
-	// Horizontal Pass
-	// Here we build a row buffer of contributing pixels and their weights for every pixel in the row.
-	int contributionIdx = 0;
-	for ( int i = 0; i < ImagePlug::tileSize(); ++i, contributionIdx += fWidth )
+	std::vector<float> input( sampleBoxWidth * sampleBoxHeight );
+	Sampler sampler( image, channelName, sampleBox, boundingMode );
+	sampler.prefetch();
+	for( int y = sampleBox.min.y, i = 0; y <= sampleBox.max.y; ++y, i += sampleBoxWidth )
 	{
-		float center = ( outTile.min.x + i + 0.5 - outFormatOffset.x ) / scaleFactor.x + inFormatOffset.x;
-		int tap = f->tap( center );
-		
-		int n = 0;	
-		weightedSum[i] = 0.;
-		for ( int j = tap; j < tap+fWidth; ++j )
-		{
-			float weight = f->weight( center, j );
-			if ( weight == 0 )
-			{
-				continue;
-			}
-			
-			contribution[contributionIdx+n].pixel = j; 
-			weightedSum[i] += contribution[contributionIdx+n].weight = weight; 
-			n++;
-		}
-		coverageTotal[i] = n;
+		sampler.row( sampleBox.min.x, y, sampleBoxWidth, &(input[i]) );
 	}
-	
-	// Now that we know the contribution of each pixel from the others on the row, compute the
-	// horizontally scaled buffer which we will use as input in the vertical scale pass.
-	Sampler sampler( inPlug(), channelName, sampleBox, f, Sampler::Clamp );
-	for ( int k = 0; k < sampleBoxHeight; ++k )
+
+	// Vertical pass. Each row of the intermediate buffer is a weighted sum of
+	// whole rows of the input, so we can process the rows SIMD::Float::width
+	// pixels at a time.
+	std::vector<float> buffer( sampleBoxWidth * ImagePlug::tileSize() );
+	for( int k = 0; k < ImagePlug::tileSize(); ++k )
 	{
-		for ( int i = 0, contributionIdx = 0; i < ImagePlug::tileSize(); ++i, contributionIdx += fWidth )
-		{
-			float intensity = 0;
+		float *bufferRow = &(buffer[k * sampleBoxWidth]);
+		const int tap = yWeights->taps[k] - sampleBox.min.y;
+		const float *weights = &(yWeights->weights[k * yWeights->width]);
 
-			for ( int j = 0; j < coverageTotal[i]; ++j )
+		for( int j = 0; j < yWeights->counts[k]; ++j )
+		{
+			const float *inputRow = &(input[(tap + j) * sampleBoxWidth]);
+			const SIMD::Float weight( weights[j] );
+			int i = 0;
+			if( j == 0 )
 			{
-				Contribution &contributor( contribution[ contributionIdx+j ] );
-
-				if ( contributor.weight == 0. )
+				for( ; i + SIMD::Float::width <= sampleBoxWidth; i += SIMD::Float::width )
 				{
-					continue;
+					( SIMD::Float::load( inputRow + i ) * weight ).store( bufferRow + i );
+				}
+				for( ; i < sampleBoxWidth; ++i )
+				{
+					bufferRow[i] = inputRow[i] * weights[j];
 				}
-
-				float value = sampler.sample( contributor.pixel, k + sampleBox.min.y );
-				intensity += value * contributor.weight;
 			}
-
-			buffer[i + ImagePlug::tileSize() * k] = intensity / weightedSum[i];
-		}
-	}
-	
-	// Vertical Pass
-	// Build the column buffer of contributing pixels and their weights for each pixel in the column.
-	f->setScale( 1.f / scaleFactor.y );
-	for ( int i = 0, contributionIdx = 0; i < ImagePlug::tileSize(); ++i, contributionIdx += fHeight )
-	{
-		float center = ( outTile.min.y - outFormatOffset.y + i + 0.5 ) / scaleFactor.y - sampleBox.min.y + inFormatOffset.y;
-		int tap = f->tap( center );
-		
-		int n = 0;	
-		weightedSum[i] = 0.;
-		for ( int j = tap; j < tap+fHeight; ++j )
-		{
-			float weight = f->weight( center, j );
-			if ( weight == 0 )
+			else
 			{
-				continue;
+				for( ; i + SIMD::Float::width <= sampleBoxWidth; i += SIMD::Float::width )
+				{
+					( SIMD::Float::load( bufferRow + i ) + SIMD::Float::load( inputRow + i ) * weight ).store( bufferRow + i );
+				}
+				for( ; i < sampleBoxWidth; ++i )
+				{
+					bufferRow[i] += inputRow[i] * weights[j];
+				}
 			}
-			
-			contribution[contributionIdx+n].pixel = j; 
-			weightedSum[i] += contribution[contributionIdx+n].weight = weight;
-			n++;
 		}
-		coverageTotal[i] = n;
 	}
-	
-	// Use the column buffer of pixel contributions to scale the temporary buffer vertically.
-	// Write the result into the output buffer.
-	for ( int k = 0; k < ImagePlug::tileSize(); ++k )
+
+	// Horizontal pass. Each output pixel is a weighted sum of a contiguous
+	// run of pixels in the corresponding row of the intermediate buffer.
+	for( int k = 0; k < ImagePlug::tileSize(); ++k )
 	{
-		for ( int i = 0, contributionIdx = 0; i < ImagePlug::tileSize(); ++i, contributionIdx += fHeight )
+		if( !yWeights->counts[k] )
 		{
-			float intensity = 0;
+			continue;
+		}
 
-			for ( int j = 0; j < coverageTotal[i]; ++j )
+		const float *bufferRow = &(buffer[k * sampleBoxWidth]);
+		float *outRow = &(out[k * ImagePlug::tileSize()]);
+		for( int i = 0; i < ImagePlug::tileSize(); ++i )
+		{
+			const float *in = bufferRow + xWeights->taps[i] - sampleBox.min.x;
+			const float *weights = &(xWeights->weights[i * xWeights->width]);
+			float intensity = 0.0f;
+			for( int j = 0, n = xWeights->counts[i]; j < n; ++j )
 			{
-				Contribution &contributor( contribution[ contributionIdx+j ] );
-
-				if ( contributor.weight == 0. )
-				{
-					continue;
-				}
-
-				intensity += buffer[ k + ImagePlug::tileSize() * contributor.pixel ] * contributor.weight;
+				intensity += in[j] * weights[j];
 			}
-
-			out[k + ImagePlug::tileSize() * i] = intensity / weightedSum[i];
+			outRow[i] = intensity;
 		}
 	}
-   
+
 	return outDataPtr;
 }
 
@@ -34,6 +34,10 @@
 //  
 //////////////////////////////////////////////////////////////////////////
 
+#include <algorithm>
+
+#include "tbb/parallel_for.h"
+
 #include "Gaffer/Context.h"
 #include "GafferImage/Sampler.h"
 
@@ -86,6 +90,104 @@ void Sampler::setSampleWindow( const Imath::Box2i &window )
 	m_dataCache.resize( m_cacheWidth * cacheHeight, NULL );
 }
 
+void Sampler::row( int x, int y, int width, float *buffer )
+{
+	float *end = buffer + width;
+
+	if( m_sampleWindow.isEmpty() || ( m_boundingMode == Black && ( y < m_sampleWindow.min.y || y > m_sampleWindow.max.y ) ) )
+	{
+		std::fill( buffer, end, 0.0f );
+		return;
+	}
+
+	y = std::max( std::min( y, m_sampleWindow.max.y ), m_sampleWindow.min.y );
+
+	// Pixels to the left of the sample window.
+	const int leftWidth = std::min( std::max( m_sampleWindow.min.x - x, 0 ), width );
+	if( leftWidth )
+	{
+		const float value = m_boundingMode == Black ? 0.0f : sample( m_sampleWindow.min.x, y );
+		std::fill( buffer, buffer + leftWidth, value );
+		buffer += leftWidth;
+		x += leftWidth;
+	}
+
+	// Pixels within the sample window, copied a tile at a time.
+	while( buffer != end && x <= m_sampleWindow.max.x )
+	{
+		int length;
+		const float *s = span( x, y, length );
+		length = std::min( length, int( end - buffer ) );
+		std::copy( s, s + length, buffer );
+		buffer += length;
+		x += length;
+	}
+
+	// Pixels to the right of the sample window.
+	if( buffer != end )
+	{
+		const float value = m_boundingMode == Black ? 0.0f : sample( m_sampleWindow.max.x, y );
+		std::fill( buffer, end, value );
+	}
+}
+
+namespace
+{
+
+// Computes a range of the tiles in the cache, in the context
+// the Sampler was being used in.
+class Prefetcher
+{
+
+	public :
+
+		Prefetcher( const ImagePlug *plug, const std::string &channelName, const Imath::Box2i &cacheWindow, int cacheWidth, std::vector<ConstFloatVectorDataPtr> &dataCache, const Context *context )
+			:	m_plug( plug ), m_channelName( channelName ), m_cacheWindow( cacheWindow ), m_cacheWidth( cacheWidth ), m_dataCache( dataCache ), m_context( context )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			Context::Scope scope( m_context );
+			for( size_t i = r.begin(); i != r.end(); ++i )
+			{
+				if( !m_dataCache[i] )
+				{
+					const Imath::V2i tileOrigin(
+						m_cacheWindow.min.x + ( i % m_cacheWidth ) * ImagePlug::tileSize(),
+						m_cacheWindow.min.y + ( i / m_cacheWidth ) * ImagePlug::tileSize()
+					);
+					m_dataCache[i] = m_plug->channelData( m_channelName, tileOrigin );
+				}
+			}
+		}
+
+	private :
+
+		const ImagePlug *m_plug;
+		const std::string &m_channelName;
+		const Imath::Box2i &m_cacheWindow;
+		const int m_cacheWidth;
+		std::vector<ConstFloatVectorDataPtr> &m_dataCache;
+		const Context *m_context;
+
+};
+
+} // namespace
+
+void Sampler::prefetch()
+{
+	if( m_sampleWindow.isEmpty() )
+	{
+		return;
+	}
+
+	tbb::parallel_for(
+		tbb::blocked_range<size_t>( 0, m_dataCache.size() ),
+		Prefetcher( m_plug, m_channelName, m_cacheWindow, m_cacheWidth, m_dataCache, Context::current() )
+	);
+}
+
 void Sampler::hash( IECore::MurmurHash &h ) const
 {
 	for ( int x = m_cacheWindow.min.x; x <= m_cacheWindow.max.x; x += GafferImage::ImagePlug::tileSize() )
@@ -36,7 +36,9 @@
 #include <boost/python/suite/indexing/container_utils.hpp>
 #include "boost/python.hpp"
 #include "boost/format.hpp"
+#include "IECore/VectorTypedData.h"
 #include "IECorePython/RunTimeTypedBinding.h"
+#include "IECorePython/RefCountedBinding.h"
 #include "GafferBindings/Serialisation.h"
 #include "GafferImage/Filter.h"
 #include "GafferImageBindings/FilterBinding.h"
@@ -87,6 +89,14 @@ GafferImage::FilterPtr create1( std::string name ){ return GafferImage::Filter::
 GafferImage::FilterPtr create2( std::string name, float scale ){ return GafferImage::Filter::create( name ); };
 float weight( Filter& filter, float center, int pos ){ return filter.weight( center, pos  ); };
 
+static boost::python::tuple kernel( const Filter::KernelBank &kernelBank, float center )
+{
+	int tap;
+	const float *k = kernelBank.kernel( center, tap );
+	FloatVectorDataPtr kernelData = new FloatVectorData( std::vector<float>( k, k + kernelBank.width() ) );
+	return boost::python::make_tuple( tap, kernelData );
+}
+
 void bindFilters()
 {
 	RunTimeTypedClass<Filter> bind( "Filter" );
@@ -96,6 +106,7 @@ void bindFilters()
 	bind.def( "setScale", &Filter::setScale );
 	bind.def( "tap", &Filter::tap );
 	bind.def( "weight", &weight );
+	bind.def( "kernelBank", &Filter::kernelBank, ( boost::python::arg_( "phases" ) = 64 ) );
 	
 	// Convenience methods for creating Filter classes.
 	bind.def( "filters", &filterList ).staticmethod("filters");
@@ -103,6 +114,16 @@ void bindFilters()
 	bind.def( "create", &create2 ).staticmethod( "create" );
 	bind.def( "defaultFilter", &defaultFilter ).staticmethod( "defaultFilter" );
 	
+	{
+		scope s = bind;
+		RefCountedClass<Filter::KernelBank, IECore::RefCounted>( "KernelBank" )
+			.def( "width", &Filter::KernelBank::width )
+			.def( "stride", &Filter::KernelBank::stride )
+			.def( "phases", &Filter::KernelBank::phases )
+			.def( "kernel", &kernel )
+		;
+	}
+
 	RunTimeTypedClass<SplineFilter>();
 	RunTimeTypedClass<BoxFilter>();
 	RunTimeTypedClass<BilinearFilter>();
@@ -64,6 +64,18 @@ void GafferImageBindings::bindImageReader()
 	GafferBindings::DependencyNodeClass<ImageReader>()
 		.def( "supportedExtensions", &supportedExtensions )
 		.staticmethod( "supportedExtensions" )
+		.def( "getCacheMemoryLimit", &ImageReader::getCacheMemoryLimit )
+		.staticmethod( "getCacheMemoryLimit" )
+		.def( "setCacheMemoryLimit", &ImageReader::setCacheMemoryLimit )
+		.staticmethod( "setCacheMemoryLimit" )
+		.def( "getCacheMaxOpenFiles", &ImageReader::getCacheMaxOpenFiles )
+		.staticmethod( "getCacheMaxOpenFiles" )
+		.def( "setCacheMaxOpenFiles", &ImageReader::setCacheMaxOpenFiles )
+		.staticmethod( "setCacheMaxOpenFiles" )
+		.def( "cacheMemoryUsage", &ImageReader::cacheMemoryUsage )
+		.staticmethod( "cacheMemoryUsage" )
+		.def( "cacheStatistics", &ImageReader::cacheStatistics )
+		.staticmethod( "cacheStatistics" )
 	;
 		
 }
@@ -52,6 +52,7 @@ void GafferImageBindings::bindMixin()
 	
 	GafferBindings::DependencyNodeClass<ImageMixinBase>();
 	GafferBindings::DependencyNodeClass<ImageContextProcessor>();
+	GafferBindings::DependencyNodeClass<ImageTimeWarpBase>();
 	GafferBindings::DependencyNodeClass<ImageTimeWarp>();
 	GafferBindings::DependencyNodeClass<ImageContextVariables>();
 	GafferBindings::DependencyNodeClass<ImageSwitch>();
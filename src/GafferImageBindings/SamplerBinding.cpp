@@ -36,6 +36,8 @@
 #include "boost/python.hpp"
 #include "boost/format.hpp"
 
+#include "IECorePython/ScopedGILRelease.h"
+
 #include "GafferImage/Filter.h"
 #include "GafferBindings/SignalBinding.h"
 #include "GafferBindings/Serialisation.h"
@@ -49,6 +51,24 @@ using namespace GafferImage;
 namespace GafferImageBindings
 {
 
+static FloatVectorDataPtr row( Sampler &sampler, int x, int y, int width )
+{
+	FloatVectorDataPtr result = new FloatVectorData;
+	result->writable().resize( width );
+	if( width )
+	{
+		IECorePython::ScopedGILRelease gilRelease;
+		sampler.row( x, y, width, &(result->writable()[0]) );
+	}
+	return result;
+}
+
+static void prefetch( Sampler &sampler )
+{
+	IECorePython::ScopedGILRelease gilRelease;
+	sampler.prefetch();
+}
+
 void bindSampler()
 {
 	enum_<Sampler::BoundingMode>( "BoundingMode" )
@@ -75,6 +95,8 @@ void bindSampler()
 		.def( "setSampleWindow", &Sampler::setSampleWindow )
 		.def( "getSampleWindow", &Sampler::getSampleWindow )
 		.def( "hash", &Sampler::hash )
+		.def( "row", &row )
+		.def( "prefetch", &prefetch )
 		.def( "sample", (float (Sampler::*)( int, int ) )&Sampler::sample )
 		.def( "sample", (float (Sampler::*)( float, float ) )&Sampler::sample )
 	;
@@ -59,6 +59,7 @@
 #include "GafferImage/ImageTransform.h"
 #include "GafferImage/ImageStats.h"
 #include "GafferImage/ImageSampler.h"
+#include "GafferImage/Blur.h"
 
 #include "GafferImageBindings/FormatBinding.h"
 #include "GafferImageBindings/FormatPlugBinding.h"
@@ -80,12 +81,46 @@ static IECore::FloatVectorDataPtr channelData( const ImagePlug &plug,  const std
 	return d ? d->copy() : 0;
 }
 
+static IECore::FloatVectorDataPtr constantTile( float value )
+{
+	return ImagePlug::constantTile( value )->copy();
+}
+
+static bool isConstantTile( const IECore::FloatVectorData *tile )
+{
+	float value;
+	return ImagePlug::isConstantTile( tile, value );
+}
+
 static IECore::ImagePrimitivePtr image( const ImagePlug &plug )
 {
 	IECorePython::ScopedGILRelease gilRelease;
 	return plug.image();
 }
 
+static IECore::MurmurHash imageHash( const ImagePlug &plug )
+{
+	IECorePython::ScopedGILRelease gilRelease;
+	return plug.imageHash();
+}
+
+static boost::python::list tiles( const ImagePlug &plug, IECore::ConstStringVectorDataPtr channelNames )
+{
+	std::vector<IECore::ConstFloatVectorDataPtr> tiles;
+	{
+		IECorePython::ScopedGILRelease gilRelease;
+		plug.tiles( channelNames->readable(), tiles );
+	}
+
+	boost::python::list result;
+	for( std::vector<IECore::ConstFloatVectorDataPtr>::const_iterator it = tiles.begin(), eIt = tiles.end(); it != eIt; ++it )
+	{
+		// Tiles are shared with the cache, so we must return copies.
+		result.append( (*it)->copy() );
+	}
+	return result;
+}
+
 BOOST_PYTHON_MODULE( _GafferImage )
 {
 	
@@ -103,10 +138,16 @@ BOOST_PYTHON_MODULE( _GafferImage )
 		.def( "channelData", &channelData )
 		.def( "channelDataHash", &ImagePlug::channelDataHash )
 		.def( "image", &image )
-		.def( "imageHash", &ImagePlug::imageHash )
+		.def( "imageHash", &imageHash )
+		.def( "tiles", &tiles )
 		.def( "tileSize", &ImagePlug::tileSize ).staticmethod( "tileSize" )
 		.def( "tileBound", &ImagePlug::tileBound ).staticmethod( "tileBound" )
 		.def( "tileOrigin", &ImagePlug::tileOrigin ).staticmethod( "tileOrigin" )
+		.def( "constantTile", &constantTile ).staticmethod( "constantTile" )
+		.def( "isConstantTile", &isConstantTile ).staticmethod( "isConstantTile" )
+		.def( "lod", &ImagePlug::lod ).staticmethod( "lod" )
+		.def( "lodWindow", &ImagePlug::lodWindow ).staticmethod( "lodWindow" )
+		.def( "lodFormat", &ImagePlug::lodFormat ).staticmethod( "lodFormat" )
 	;
 
 	GafferBindings::DependencyNodeClass<ImageNode>();
@@ -114,6 +155,8 @@ BOOST_PYTHON_MODULE( _GafferImage )
 	GafferBindings::DependencyNodeClass<Display>()
 		.def( "dataReceivedSignal", &Display::dataReceivedSignal, return_value_policy<reference_existing_object>() ).staticmethod( "dataReceivedSignal" )
 		.def( "imageReceivedSignal", &Display::imageReceivedSignal, return_value_policy<reference_existing_object>() ).staticmethod( "imageReceivedSignal" )
+		.def( "setUpdateInterval", &Display::setUpdateInterval ).staticmethod( "setUpdateInterval" )
+		.def( "getUpdateInterval", &Display::getUpdateInterval ).staticmethod( "getUpdateInterval" )
 	;
 	GafferBindings::DependencyNodeClass<ImageProcessor>();
 	GafferBindings::DependencyNodeClass<FilterProcessor>();
@@ -142,6 +185,22 @@ BOOST_PYTHON_MODULE( _GafferImage )
 	GafferImageBindings::bindFormatData();
 	GafferImageBindings::bindImageReader();
 	
-	GafferBindings::ExecutableNodeClass<ImageWriter>();
+	{
+		scope s = GafferBindings::ExecutableNodeClass<ImageWriter>();
+
+		enum_<ImageWriter::DataType>( "DataType" )
+			.value( "Float", ImageWriter::Float )
+			.value( "Half", ImageWriter::Half )
+		;
+	}
+
+	{
+		scope s = GafferBindings::DependencyNodeClass<Blur>();
+
+		enum_<Blur::Type>( "Type" )
+			.value( "Box", Blur::Box )
+			.value( "Gaussian", Blur::Gaussian )
+		;
+	}
 }
 
@@ -0,0 +1,172 @@
+//////////////////////////////////////////////////////////////////////////
+//  
+//  Copyright (c) 2014, Image Engine Design Inc. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//  
+//      * Redistributions of source code must retain the above
+//        copyright notice, this list of conditions and the following
+//        disclaimer.
+//  
+//      * Redistributions in binary form must reproduce the above
+//        copyright notice, this list of conditions and the following
+//        disclaimer in the documentation and/or other materials provided with
+//        the distribution.
+//  
+//      * Neither the name of John Haddon nor the names of
+//        any other contributors to this software may be used to endorse or
+//        promote products derived from this software without specific prior
+//        written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//////////////////////////////////////////////////////////////////////////
+
+#include <vector>
+#include <iostream>
+
+#include "boost/format.hpp"
+
+#include "IECore/Exception.h"
+#include "IECore/Timer.h"
+
+#include "GafferImage/Filter.h"
+
+#include "GafferImageTest/FilterTest.h"
+
+using namespace IECore;
+using namespace GafferImage;
+
+namespace
+{
+
+// Convolves pixels with the filter at each of centers, calling Filter::weight()
+// for every tap, as Sampler::sample( float, float ) does.
+void convolveWithWeights( const Filter *filter, const std::vector<float> &pixels, const std::vector<float> &centers, std::vector<float> &result )
+{
+	const int width = filter->width();
+	for( size_t i = 0; i < centers.size(); ++i )
+	{
+		const float center = centers[i];
+		const int tap = filter->tap( center );
+		float weightedSum = 0.0f;
+		float value = 0.0f;
+		for( int j = 0; j < width; ++j )
+		{
+			const float weight = filter->weight( center, tap + j );
+			weightedSum += weight;
+			value += pixels[tap+j] * weight;
+		}
+		result[i] = weightedSum == 0.0f ? 0.0f : value / weightedSum;
+	}
+}
+
+// As above, but using the kernels from a KernelBank.
+void convolveWithKernelBank( const Filter::KernelBank *kernelBank, const std::vector<float> &pixels, const std::vector<float> &centers, std::vector<float> &result )
+{
+	for( size_t i = 0; i < centers.size(); ++i )
+	{
+		int tap;
+		const float *kernel = kernelBank->kernel( centers[i], tap );
+		const float *p = &(pixels[tap]);
+		SIMD::Float sum( 0.0f );
+		for( int j = 0; j < kernelBank->stride(); j += SIMD::Float::width )
+		{
+			sum = sum + SIMD::Float::load( p + j ) * SIMD::Float::load( kernel + j );
+		}
+		float s[SIMD::Float::width];
+		sum.store( s );
+		float value = 0.0f;
+		for( int j = 0; j < SIMD::Float::width; ++j )
+		{
+			value += s[j];
+		}
+		result[i] = value;
+	}
+}
+
+} // namespace
+
+// Checks that the kernels in a KernelBank match the weights computed by
+// Filter::weight(), and compares the performance of the two for every
+// registered filter.
+void GafferImageTest::testFilterKernelBanks()
+{
+	const int numPixels = 4096;
+	const int numCenters = 1000000;
+	const int phases = 64;
+
+	std::vector<float> pixels( numPixels );
+	for( int i = 0; i < numPixels; ++i )
+	{
+		pixels[i] = float( ( i * 7919 ) % 1000 ) / 1000.0f;
+	}
+
+	const std::vector<std::string> &filters = Filter::filters();
+	for( std::vector<std::string>::const_iterator it = filters.begin(), eIt = filters.end(); it != eIt; ++it )
+	{
+		const float scales[] = { 1.0f, 2.5f };
+		for( int s = 0; s < 2; ++s )
+		{
+			ConstFilterPtr filter = Filter::create( *it, scales[s] );
+			Filter::ConstKernelBankPtr kernelBank = filter->kernelBank( phases );
+
+			// Centers which fall exactly on a phase should give the same
+			// results either way. We keep them well inside the pixels so
+			// that the kernels never read off the end, even once padded.
+			const int margin = filter->width() + SIMD::Float::width;
+			std::vector<float> centers;
+			for( int i = margin; i < numPixels - margin; i += 37 )
+			{
+				centers.push_back( i + float( i % phases ) / phases );
+			}
+
+			std::vector<float> expected( centers.size() ), result( centers.size() );
+			convolveWithWeights( filter.get(), pixels, centers, expected );
+			convolveWithKernelBank( kernelBank.get(), pixels, centers, result );
+			for( size_t i = 0; i < centers.size(); ++i )
+			{
+				if( fabs( expected[i] - result[i] ) > 1e-4 )
+				{
+					throw IECore::Exception( boost::str(
+						boost::format( "KernelBank for filter \"%s\" at scale %f gave %f rather than %f at center %f." ) %
+							*it % scales[s] % result[i] % expected[i] % centers[i]
+					) );
+				}
+			}
+
+			// Now time the two with arbitrary centers.
+			centers.resize( numCenters );
+			for( int i = 0; i < numCenters; ++i )
+			{
+				centers[i] = margin + float( ( i * 104729 ) % ( ( numPixels - 2 * margin ) * 1000 ) ) / 1000.0f;
+			}
+			result.resize( numCenters );
+
+			Timer t;
+			convolveWithWeights( filter.get(), pixels, centers, result );
+			const double weightsTime = t.stop();
+
+			t.start();
+			convolveWithKernelBank( kernelBank.get(), pixels, centers, result );
+			const double kernelBankTime = t.stop();
+
+			// uncomment to get timing information
+			//std::cerr << *it << " (scale " << scales[s] << ") : weight() " << weightsTime << " KernelBank " << kernelBankTime << std::endl;
+			(void)weightsTime;
+			(void)kernelBankTime;
+		}
+	}
+}
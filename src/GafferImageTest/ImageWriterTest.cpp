@@ -0,0 +1,96 @@
+//////////////////////////////////////////////////////////////////////////
+//  
+//  Copyright (c) 2014, Image Engine Design Inc. All rights reserved.
+//  
+//  Redistribution and use in source and binary forms, with or without
+//  modification, are permitted provided that the following conditions are
+//  met:
+//  
+//      * Redistributions of source code must retain the above
+//        copyright notice, this list of conditions and the following
+//        disclaimer.
+//  
+//      * Redistributions in binary form must reproduce the above
+//        copyright notice, this list of conditions and the following
+//        disclaimer in the documentation and/or other materials provided with
+//        the distribution.
+//  
+//      * Neither the name of John Haddon nor the names of
+//        any other contributors to this software may be used to endorse or
+//        promote products derived from this software without specific prior
+//        written permission.
+//  
+//  THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS
+//  IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO,
+//  THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR
+//  PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR
+//  CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+//  EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+//  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+//  PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+//  LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+//  NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+//  SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+//  
+//////////////////////////////////////////////////////////////////////////
+
+#include "boost/format.hpp"
+
+#include "OpenImageIO/imageio.h"
+OIIO_NAMESPACE_USING
+
+#include "IECore/Exception.h"
+#include "IECore/ImagePrimitive.h"
+
+#include "GafferImageTest/ImageWriterTest.h"
+
+using namespace std;
+using namespace Imath;
+using namespace IECore;
+
+IECore::CompoundObjectPtr GafferImageTest::readImageParts( const std::string &fileName )
+{
+	ImageInput *in = ImageInput::open( fileName );
+	if( !in )
+	{
+		throw IECore::Exception( boost::str( boost::format( "Could not open \"%s\", error = %s" ) % fileName % geterror() ) );
+	}
+
+	CompoundObjectPtr result = new CompoundObject;
+
+	ImageSpec spec;
+	for( int subimage = 0; in->seek_subimage( subimage, 0, spec ); ++subimage )
+	{
+		std::vector<float> interleavedData( spec.width * spec.height * spec.nchannels );
+		if( !in->read_image( TypeDesc::FLOAT, &(interleavedData[0]) ) )
+		{
+			const std::string error = in->geterror();
+			delete in;
+			throw IECore::Exception( boost::str( boost::format( "Could not read part %d of \"%s\", error = %s" ) % subimage % fileName % error ) );
+		}
+
+		// Windows are in the Y-down space of the file, matching the
+		// images returned by ImagePlug::image() and the Cortex readers.
+		const Box2i dataWindow( V2i( spec.x, spec.y ), V2i( spec.x + spec.width - 1, spec.y + spec.height - 1 ) );
+		const Box2i displayWindow( V2i( spec.full_x, spec.full_y ), V2i( spec.full_x + spec.full_width - 1, spec.full_y + spec.full_height - 1 ) );
+		ImagePrimitivePtr image = new ImagePrimitive( dataWindow, displayWindow );
+
+		for( int c = 0; c < spec.nchannels; ++c )
+		{
+			FloatVectorDataPtr channelData = image->createChannel<float>( spec.channelnames[c] );
+			std::vector<float> &channel = channelData->writable();
+			for( size_t i = 0, e = channel.size(); i < e; ++i )
+			{
+				channel[i] = interleavedData[i * spec.nchannels + c];
+			}
+		}
+
+		const std::string name = spec.get_string_attribute( "oiio:subimagename", boost::str( boost::format( "subimage%d" ) % subimage ) );
+		result->members()[name] = image;
+	}
+
+	in->close();
+	delete in;
+
+	return result;
+}
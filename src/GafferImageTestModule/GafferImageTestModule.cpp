@@ -37,6 +37,8 @@
 #include "boost/python.hpp"
 
 #include "GafferImageTest/ImageReaderTest.h"
+#include "GafferImageTest/FilterTest.h"
+#include "GafferImageTest/ImageWriterTest.h"
 
 using namespace boost::python;
 using namespace GafferImageTest;
@@ -45,4 +47,6 @@ BOOST_PYTHON_MODULE( _GafferImageTest )
 {
 	def( "testOIIOJpgRead", &testOIIOJpgRead );
 	def( "testOIIOExrRead", &testOIIOExrRead );
+	def( "testFilterKernelBanks", &testFilterKernelBanks );
+	def( "readImageParts", &readImageParts );
 }
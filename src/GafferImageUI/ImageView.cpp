@@ -114,7 +114,7 @@ class ImageViewGadget : public GafferUI::Gadget
 				m_displayBound( image->bound() ),
 				m_displayWindow( image->getDisplayWindow() ),
 				m_dataWindow( image->getDataWindow() ),
-				m_image( image->copy() ),
+				m_image( image ),
 				m_texture( 0 ),
 				m_mousePos( mousePos ),
 				m_sampleColor( 0.f ),
@@ -35,6 +35,7 @@
 //////////////////////////////////////////////////////////////////////////
 
 #include "IECore/CompoundData.h"
+#include "IECore/LRUCache.h"
 
 #include "Gaffer/Context.h"
 #include "Gaffer/Box.h"
@@ -52,6 +53,101 @@ using namespace Gaffer;
 using namespace GafferImage;
 using namespace GafferOSL;
 
+//////////////////////////////////////////////////////////////////////////
+// Utilities
+//////////////////////////////////////////////////////////////////////////
+
+namespace
+{
+
+// The P, u and v shading globals for a tile. These depend only on the
+// format and the tile origin, so are cached for reuse whenever the same
+// tile is shaded again.
+struct GlobalsCacheKey
+{
+
+	GlobalsCacheKey()
+	{
+	}
+
+	GlobalsCacheKey( const Format &format, const V2i &tileOrigin )
+		:	width( format.width() ), height( format.height() ), tileOrigin( tileOrigin )
+	{
+		hash.append( width );
+		hash.append( height );
+		hash.append( tileOrigin );
+	}
+
+	bool operator == ( const GlobalsCacheKey &other ) const
+	{
+		return hash == other.hash;
+	}
+
+	int width;
+	int height;
+	V2i tileOrigin;
+	MurmurHash hash;
+
+};
+
+inline size_t tbb_hasher( const GlobalsCacheKey &cacheKey )
+{
+	return tbb_hasher( cacheKey.hash );
+}
+
+ConstCompoundDataPtr globalsGetter( const GlobalsCacheKey &key, size_t &cost )
+{
+	const int tileSize = ImagePlug::tileSize();
+	const size_t numPoints = tileSize * tileSize;
+
+	V3fVectorDataPtr pData = new V3fVectorData;
+	FloatVectorDataPtr uData = new FloatVectorData;
+	FloatVectorDataPtr vData = new FloatVectorData;
+
+	pData->writable().resize( numPoints );
+	uData->writable().resize( numPoints );
+	vData->writable().resize( numPoints );
+
+	V3f *p = &(pData->writable()[0]);
+	float *u = &(uData->writable()[0]);
+	float *v = &(vData->writable()[0]);
+
+	/// \todo Non-zero display window origins - do we have those?
+	const float uStep = 1.0f / key.width;
+	const float uMin = 0.5f * uStep;
+	
+	const float vStep = 1.0f / key.height;
+	const float vMin = 0.5f * vStep;
+
+	for( int y = key.tileOrigin.y, yEnd = key.tileOrigin.y + tileSize; y < yEnd; ++y )
+	{
+		const float vValue = vMin + y * vStep;
+		for( int x = key.tileOrigin.x, xEnd = key.tileOrigin.x + tileSize; x < xEnd; ++x )
+		{
+			*p++ = V3f( x, y, 0.0f );
+			*u++ = uMin + x * uStep;
+			*v++ = vValue;
+		}
+	}
+
+	CompoundDataPtr result = new CompoundData;
+	result->writable()["P"] = pData;
+	result->writable()["u"] = uData;
+	result->writable()["v"] = vData;
+
+	cost = numPoints * ( sizeof( V3f ) + 2 * sizeof( float ) );
+	return result;
+}
+
+typedef LRUCache<GlobalsCacheKey, ConstCompoundDataPtr> GlobalsCache;
+GlobalsCache g_globalsCache( globalsGetter, 1024 * 1024 * 32 );
+
+} // namespace
+
+//////////////////////////////////////////////////////////////////////////
+// OSLImage
+//////////////////////////////////////////////////////////////////////////
+
 IE_CORE_DEFINERUNTIMETYPED( OSLImage );
 
 size_t OSLImage::g_firstPlugIndex = 0;
@@ -294,44 +390,10 @@ IECore::ConstCompoundDataPtr OSLImage::computeShading( const Gaffer::Context *co
 	const V2i tileOrigin = context->get<V2i>( ImagePlug::tileOriginContextName );
 	const Format format = inPlug()->formatPlug()->getValue();
 	
-	CompoundDataPtr shadingPoints = new CompoundData();
+	// Start with the cached shading globals, which we share rather than copy.
 
-	V3fVectorDataPtr pData = new V3fVectorData;
-	FloatVectorDataPtr uData = new FloatVectorData;
-	FloatVectorDataPtr vData = new FloatVectorData;
-	
-	vector<V3f> &pWritable = pData->writable();
-	vector<float> &uWritable = uData->writable();
-	vector<float> &vWritable = vData->writable();
-	
-	const size_t tileSize = ImagePlug::tileSize();
-	pWritable.reserve( tileSize * tileSize );
-	uWritable.reserve( tileSize * tileSize );
-	vWritable.reserve( tileSize * tileSize );
-
-	/// \todo Non-zero display window origins - do we have those?
-	const float uStep = 1.0f / format.width();
-	const float uMin = 0.5f * uStep;
-	
-	const float vStep = 1.0f / format.height();
-	const float vMin = 0.5f * vStep;
-	
-	const size_t xMax = tileOrigin.x + tileSize;
-	const size_t yMax = tileOrigin.y + tileSize;
-	for( size_t y = tileOrigin.y; y < yMax; ++y )
-	{
-		const float v = vMin + y * vStep;
-		for( size_t x = tileOrigin.x; x < xMax; ++x )
-		{
-			uWritable.push_back( uMin + x * uStep );
-			vWritable.push_back( v );
-			pWritable.push_back( V3f( x, y, 0.0f ) );
-		}
-	}
-	
-	shadingPoints->writable()["P"] = pData;
-	shadingPoints->writable()["u"] = uData;
-	shadingPoints->writable()["v"] = vData;
+	ConstCompoundDataPtr globals = g_globalsCache.get( GlobalsCacheKey( format, tileOrigin ) );
+	CompoundDataPtr shadingPoints = new CompoundData( globals->readable() );
 	
 	ConstStringVectorDataPtr channelNamesData = inPlug()->channelNamesPlug()->getValue();
 	const vector<string> &channelNames = channelNamesData->readable();
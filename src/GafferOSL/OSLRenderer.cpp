@@ -38,6 +38,10 @@
 #include "boost/algorithm/string/predicate.hpp"
 #include "boost/algorithm/string/classification.hpp"
 
+#include "tbb/blocked_range.h"
+#include "tbb/parallel_for.h"
+#include "tbb/spin_mutex.h"
+
 #include "OSL/oslclosure.h"
 #include "OSL/genclosure.h"
 #include "OSL/oslversion.h"
@@ -256,6 +260,11 @@ class OSLRenderer::RenderState
 			m_pointIndex++;
 		}
 
+		void setPointIndex( size_t pointIndex )
+		{
+			m_pointIndex = pointIndex;
+		}
+
 	private :
 			
 		size_t m_pointIndex;
@@ -773,19 +782,18 @@ class OSLRenderer::ShadingResults
 			m_results->writable()["Ci"] = ciData;
 		}
 		
-		void addResult( size_t pointIndex, const ClosureColor *result )
-		{
-			addResult( pointIndex, result, Color3f( 1.0f ) );
-		}
-		
 		CompoundDataPtr results()
 		{
 			return m_results;
 		}
 
+		class Writer;
+
 	private :
 
-		const ClosureComponent::Attr *attr( const ClosureComponent *closure, ustring key )
+		friend class Writer;
+
+		static const ClosureComponent::Attr *attr( const ClosureComponent *closure, ustring key )
 		{
 			const ClosureComponent::Attr *a = closure->attrs();
 			for( int i = 0; i < closure->nattrs; ++i, ++a )
@@ -798,6 +806,97 @@ class OSLRenderer::ShadingResults
 			return NULL;
 		}
 
+		/// \todo This is a lot like the UserData struct above - maybe we should
+		/// just have one type we can use for both?
+		struct DebugResult
+		{
+			DebugResult()
+				:	basePointer( NULL )
+			{
+			}
+		
+			ustring name;
+			TypeDesc type;
+			void *basePointer;
+			
+			bool operator < ( const DebugResult &rhs ) const
+			{
+				return name.c_str() < rhs.name.c_str();
+			}
+			
+			bool operator < ( const ustring &rhs ) const
+			{
+				return name.c_str() < rhs.c_str();
+			}
+		};
+
+		// Returns the DebugResult for the named debug closure, creating it if necessary.
+		// This is only called by a Writer the first time it sees each debug closure,
+		// so a simple lock suffices. The result data is allocated for all points up
+		// front, so Writers can then write to it without locking.
+		DebugResult debugResult( const ustring &name, const ClosureComponent *closure )
+		{
+			DebugResultsMutex::scoped_lock lock( m_debugResultsMutex );
+			vector<DebugResult>::iterator it = lower_bound(
+				m_debugResults.begin(),
+				m_debugResults.end(),
+				name
+			);
+			
+			if( it != m_debugResults.end() && it->name == name )
+			{
+				return *it;
+			}
+
+			DebugResult result;
+			result.name = name;
+			result.type = TypeDesc::TypeColor;
+			if( const ClosureComponent::Attr *typeAttr = attr( closure, DebugParameters::typeAttrKey ) )
+			{
+				result.type = TypeDesc( typeAttr->str().c_str() );
+			}
+			result.type.arraylen = m_ci->size();					
+			DataPtr data = dataFromTypeDesc( result.type, result.basePointer );
+			if( !data )
+			{
+				throw IECore::Exception( "Unsupported type specified in debug() closure." );
+			}
+			result.type.unarray(); // so we can use convert_value
+			m_results->writable()[result.name.c_str()] = data;
+			m_debugResults.insert( it, result );
+
+			return result;
+		}
+
+		typedef tbb::spin_mutex DebugResultsMutex;
+
+		CompoundDataPtr m_results;
+		vector<Color3f> *m_ci;
+		vector<DebugResult> m_debugResults; // sorted on name for quick lookups
+		DebugResultsMutex m_debugResultsMutex;
+		
+};
+
+// Writes the results for a single chunk of points into a ShadingResults. Each
+// chunk has its own Writer, which keeps its own table of debug results, so
+// writing a result never needs a lock.
+class OSLRenderer::ShadingResults::Writer
+{
+
+	public :
+
+		Writer( ShadingResults &results )
+			:	m_results( results )
+		{
+		}
+
+		void addResult( size_t pointIndex, const ClosureColor *result )
+		{
+			addResult( pointIndex, result, Color3f( 1.0f ) );
+		}
+
+	private :
+
 		void addResult( size_t pointIndex, const ClosureColor *closure, const Color3f &weight )
 		{
 			if( closure )
@@ -839,82 +938,125 @@ class OSLRenderer::ShadingResults
 		
 		void addEmission( size_t pointIndex, const ClosureComponent *closure, const Color3f &weight )
 		{
-			(*m_ci)[pointIndex] += weight;
+			(*m_results.m_ci)[pointIndex] += weight;
 		}
 		
 		void addDebug( size_t pointIndex, const ClosureComponent *closure, const Color3f &weight )
 		{
 			const DebugParameters *parameters = static_cast<const DebugParameters *>( closure->data() );
-			vector<DebugResult>::iterator it = lower_bound(
-				m_debugResults.begin(),
-				m_debugResults.end(),
-				parameters->name
-			);
-			
-			if( it == m_debugResults.end() || it->name != parameters->name )
-			{
-				DebugResult result;
-				result.name = parameters->name;
-				result.type = TypeDesc::TypeColor;
-				if( const ClosureComponent::Attr *typeAttr = attr( closure, DebugParameters::typeAttrKey ) )
-				{
-					result.type = TypeDesc( typeAttr->str().c_str() );
-				}
-				result.type.arraylen = m_ci->size();					
-				DataPtr data = dataFromTypeDesc( result.type, result.basePointer );
-				if( !data )
-				{
-					throw IECore::Exception( "Unsupported type specified in debug() closure." );
-				}
-				result.type.unarray(); // so we can use convert_value
-				m_results->writable()[result.name.c_str()] = data;
-				it = m_debugResults.insert( it, result );
-			}
-			
+			const DebugResult &result = debugResult( parameters->name, closure );
+
 			Color3f value = weight;
-			if( const ClosureComponent::Attr *valueAttr = attr( closure, DebugParameters::valueAttrKey ) )
+			if( const ClosureComponent::Attr *valueAttr = ShadingResults::attr( closure, DebugParameters::valueAttrKey ) )
 			{
 				value *= valueAttr->color();
 			}
 			
-			char *dst = static_cast<char *>( it->basePointer );
-			dst += pointIndex * it->type.elementsize();
+			char *dst = static_cast<char *>( result.basePointer );
+			dst += pointIndex * result.type.elementsize();
 			ShadingSystem::convert_value(
 				dst,
-				it->type,
+				result.type,
 				&value,
-				it->type.aggregate == TypeDesc::SCALAR ? TypeDesc::TypeFloat : TypeDesc::TypeColor
+				result.type.aggregate == TypeDesc::SCALAR ? TypeDesc::TypeFloat : TypeDesc::TypeColor
 			);
 		}
 
-		/// \todo This is a lot like the UserData struct above - maybe we should
-		/// just have one type we can use for both?
-		struct DebugResult
+		const DebugResult &debugResult( const ustring &name, const ClosureComponent *closure )
 		{
-			DebugResult()
-				:	basePointer( NULL )
-			{
-			}
-		
-			ustring name;
-			TypeDesc type;
-			void *basePointer;
+			vector<DebugResult>::iterator it = lower_bound(
+				m_debugResults.begin(),
+				m_debugResults.end(),
+				name
+			);
 			
-			bool operator < ( const DebugResult &rhs ) const
+			if( it == m_debugResults.end() || it->name != name )
 			{
-				return name.c_str() < rhs.name.c_str();
+				it = m_debugResults.insert( it, m_results.debugResult( name, closure ) );
 			}
-			
-			bool operator < ( const ustring &rhs ) const
+
+			return *it;
+		}
+
+		ShadingResults &m_results;
+		vector<DebugResult> m_debugResults; // sorted on name for quick lookups
+
+};
+
+//////////////////////////////////////////////////////////////////////////
+// OSLRenderer::ShadingBody
+//////////////////////////////////////////////////////////////////////////
+
+// Shades a range of points, for use with tbb::parallel_for().
+class OSLRenderer::ShadingBody
+{
+
+	public :
+
+		ShadingBody(
+			ShadingSystem *shadingSystem, OSL::ShadingAttribStateRef shadingState,
+			const ShaderGlobals &shaderGlobals, const RenderState &renderState,
+			const V3f *p, const float *u, const float *v, const V3f *n,
+			ShadingResults &results
+		)
+			:	m_shadingSystem( shadingSystem ), m_shadingState( shadingState ),
+				m_shaderGlobals( shaderGlobals ), m_renderState( renderState ),
+				m_p( p ), m_u( u ), m_v( v ), m_n( n ),
+				m_results( results )
+		{
+		}
+
+		void operator()( const tbb::blocked_range<size_t> &r ) const
+		{
+			ShaderGlobals shaderGlobals = m_shaderGlobals;
+			RenderState renderState = m_renderState;
+			renderState.setPointIndex( r.begin() );
+			shaderGlobals.renderstate = &renderState;
+
+			ShadingResults::Writer writer( m_results );
+
+			ShadingContext *shadingContext = m_shadingSystem->get_context();
+			for( size_t i = r.begin(); i != r.end(); ++i )
 			{
-				return name.c_str() < rhs.c_str();
+				shaderGlobals.P = m_p[i];
+				if( m_u )
+				{
+					shaderGlobals.u = m_u[i];
+				}
+				if( m_v )
+				{
+					shaderGlobals.v = m_v[i];
+				}
+				if( m_n )
+				{
+					shaderGlobals.N = m_n[i];
+				}
+				
+				shaderGlobals.Ci = NULL;
+				
+				m_shadingSystem->execute( *shadingContext, *m_shadingState, shaderGlobals );
+				if( shaderGlobals.Ci )
+				{
+					writer.addResult( i, shaderGlobals.Ci );
+				}
+				renderState.incrementPointIndex();
 			}
-		};
-		
-		CompoundDataPtr m_results;
-		vector<Color3f> *m_ci;
-		vector<DebugResult> m_debugResults; // sorted on name for quick lookups
-		
+			
+			m_shadingSystem->release_context( shadingContext );
+		}
+
+	private :
+
+		ShadingSystem *m_shadingSystem;
+		OSL::ShadingAttribStateRef m_shadingState;
+		const ShaderGlobals &m_shaderGlobals;
+		const RenderState &m_renderState;
+		const V3f *m_p;
+		const float *m_u;
+		const float *m_v;
+		const V3f *m_n;
+		ShadingResults &m_results;
+
 };
 
 //////////////////////////////////////////////////////////////////////////
@@ -962,11 +1104,11 @@ IECore::CompoundDataPtr OSLRenderer::ShadingEngine::shade( const IECore::Compoun
 	
 	size_t numPoints = 0;
 
-	const OSL::Vec3 *p = 0;
+	const V3f *p = 0;
 	if( const V3fVectorData *pData = points->member<V3fVectorData>( "P" ) )
 	{
 		numPoints = pData->readable().size();
-		p = reinterpret_cast<const OSL::Vec3 *>( &(pData->readable()[0]) );
+		p = &(pData->readable()[0]);
 	}
 	else
 	{
@@ -1001,11 +1143,10 @@ IECore::CompoundDataPtr OSLRenderer::ShadingEngine::shade( const IECore::Compoun
 	shaderGlobals.dPdu = uniformValue<V3f>( points, "dPdu" );
 	shaderGlobals.dPdv = uniformValue<V3f>( points, "dPdv" );
 	
-	// add a RenderState to the ShaderGlobals. this will
-	// get passed to our RendererServices queries.
+	// make a RenderState which will be copied for each chunk of
+	// points and passed to our RendererServices queries.
 	
 	RenderState renderState( points );
-	shaderGlobals.renderstate = &renderState;
 	
 	// get pointers to varying data, we'll use these to
 	// update the shaderGlobals as we iterate over our points.
@@ -1020,33 +1161,11 @@ IECore::CompoundDataPtr OSLRenderer::ShadingEngine::shade( const IECore::Compoun
 	
 	ShadingResults results( numPoints );
 	
-	// iterate over the input points, doing the shading as we go
+	// shade the points in parallel, in chunks which are each
+	// given their own ShadingContext, ShaderGlobals and RenderState.
 
-	ShadingContext *shadingContext = m_renderer->m_shadingSystem->get_context();
-	for( size_t i = 0; i < numPoints; ++i )
-	{
-		shaderGlobals.P = *p++;
-		if( u )
-		{
-			shaderGlobals.u = *u++;
-		}
-		if( v )
-		{
-			shaderGlobals.v = *v++;
-		}
-		if( n )
-		{
-			shaderGlobals.N = *n++;
-		}
-		
-		shaderGlobals.Ci = NULL;
-		
-		m_renderer->m_shadingSystem->execute( *shadingContext, *m_shadingState, shaderGlobals );
-		results.addResult( i, shaderGlobals.Ci );
-		renderState.incrementPointIndex();
-	}
-	
-	m_renderer->m_shadingSystem->release_context( shadingContext );
+	ShadingBody body( m_renderer->m_shadingSystem.get(), m_shadingState, shaderGlobals, renderState, p, u, v, n, results );
+	tbb::parallel_for( tbb::blocked_range<size_t>( 0, numPoints, 1000 ), body );
 	
 	return results.results();
 }
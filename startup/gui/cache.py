@@ -36,6 +36,7 @@
 ##########################################################################
 
 import Gaffer
+import GafferImage
 
 # add plugs to the preferences node
 
@@ -43,6 +44,8 @@ preferences = application.root()["preferences"]
 preferences["cache"] = Gaffer.CompoundPlug()
 preferences["cache"]["enabled"] = Gaffer.BoolPlug( defaultValue = True )
 preferences["cache"]["memoryLimit"] = Gaffer.IntPlug( defaultValue = Gaffer.ValuePlug.getCacheMemoryLimit() / ( 1024 * 1024 ) )
+preferences["cache"]["imageReaderMemoryLimit"] = Gaffer.IntPlug( defaultValue = GafferImage.ImageReader.getCacheMemoryLimit() / ( 1024 * 1024 ) )
+preferences["cache"]["imageReaderMaxOpenFiles"] = Gaffer.IntPlug( defaultValue = GafferImage.ImageReader.getCacheMaxOpenFiles(), minValue = 1 )
 
 # update cache settings when they change
 
@@ -57,4 +60,7 @@ def __plugSet( plug ) :
 	
 	Gaffer.ValuePlug.setCacheMemoryLimit( memoryLimit )
 	
+	GafferImage.ImageReader.setCacheMemoryLimit( plug["imageReaderMemoryLimit"].getValue() * 1024 * 1024 )
+	GafferImage.ImageReader.setCacheMaxOpenFiles( plug["imageReaderMaxOpenFiles"].getValue() )
+	
 application.__cachePlugSetConnection = preferences.plugSetSignal().connect( __plugSet )
@@ -100,6 +100,7 @@ def __displayTransformCreator( name ) :
 	result = GafferImage.OpenColorIO()
 	result["inputSpace"].setValue( "linear" )
 	result["outputSpace"].setValue( config.getDisplayColorSpaceName( defaultDisplay, name ) )
+	result["bakeLUT"].setValue( True )
 	
 	return result
 
@@ -122,6 +123,7 @@ def __defaultDisplayTransformCreator() :
 
 	result = GafferImage.OpenColorIO()
 	result["inputSpace"].setValue( "linear" )
+	result["bakeLUT"].setValue( True )
 	
 	__defaultDisplayTransforms.append( result )
 	__updateDefaultDisplayTransforms()